@@ -6,7 +6,10 @@
  * 
  * Compilation:
  * 
- * gcc -o gol game_of_life.c -I/opt/homebrew/include -L/opt/homebrew/lib -lSDL2
+ * gcc -o gol game_of_life.c -I/opt/homebrew/include -L/opt/homebrew/lib -lSDL2 -pthread
+ * 
+ * Add -DGOL_OPENCL=1 -lOpenCL (-framework OpenCL on macOS) for the gpu engine.
+ * Build with mpicc and -DGOL_MPI=1 to split boards between the ranks of an MPI run.
  * 
  */
 
@@ -16,13 +19,70 @@
 #include <stdbool.h>
 #include <time.h>
 #include <string.h>
+#include <strings.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
 #include <errno.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <glob.h>
+
+/* Explicit SIMD step kernels, selected at runtime */
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GOL_HAVE_X86_KERNELS 1
+#endif
+#if defined(__aarch64__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GOL_HAVE_NEON_KERNELS 1
+#endif
+
+/* OpenCL GPU engine; build with -DGOL_OPENCL=1 and -lOpenCL (-framework OpenCL on macOS) */
+#ifndef GOL_OPENCL
+#define GOL_OPENCL 0
+#endif
+#if GOL_OPENCL
+#define CL_TARGET_OPENCL_VERSION 120
+#ifdef __APPLE__
+#include <OpenCL/opencl.h>
+#else
+#include <CL/cl.h>
+#endif
+#endif
+
+/* Distributed runs over MPI; build with mpicc -DGOL_MPI=1 and start with mpirun */
+#ifndef GOL_MPI
+#define GOL_MPI 0
+#endif
+#if GOL_MPI
+#include <mpi.h>
+#endif
 
 /* Configuration Constants */
-#define CELL_SIZE 8
+#define CELL_ZOOM 3            /* log2 of window pixels per cell side at start */
+#define CELL_SIZE (1 << CELL_ZOOM)
+#define VIEW_MAX_WIDTH 1280    /* Largest window, in pixels */
+#define VIEW_MAX_HEIGHT 800
+#define VIEW_MAX_ZOOM 5        /* Closest zoom: 32 pixels per cell side */
+#define MAX_LOD_LEVEL 32       /* Farthest zoom: 2^32 cells per pixel side */
+#define VIEW_BACKGROUND 0x40   /* Gray level outside the board */
 #define BUFFER_SIZE 2048
 #define MAX_CONFIG_LENGTH 200
 #define FRAME_DELAY_MS 25
+#define ALIVE_COLOR 0xFF00FF00u  /* ARGB8888 green */
+#define DEAD_COLOR 0xFF000000u   /* ARGB8888 black */
+#define DEFAULT_GENS_PER_FRAME 1
+#define MAX_GENS_PER_FRAME 1048576
+#define DEFAULT_RULE "B3/S23"
+#define RULE_NAME_LENGTH 32
+/* Conway's B3/S23, which the hand-written SIMD kernels are specialized for */
 #define NEIGHBORS_TO_BIRTH 3
 #define MIN_NEIGHBORS_TO_SURVIVE 2
 #define MAX_NEIGHBORS_TO_SURVIVE 3
@@ -30,15 +90,156 @@
 /* Configuration Keys */
 #define CONFIG_RANDOM "random"
 #define CONFIG_MANUAL "manual"
+#define CONFIG_SNAPSHOT "snapshot"
+#define CONFIG_PATTERN "pattern"
+
+/* Render Modes */
+#define RENDER_SDL "sdl"
+#define RENDER_NONE "none"
+
+/* Boundary Modes */
+#define BOUNDARY_DEAD_NAME "dead"
+#define BOUNDARY_TORUS_NAME "torus"
+#define BOUNDARY_KLEIN_NAME "klein"
+#define BOUNDARY_MIRROR_NAME "mirror"
+
+/* Command Line Options */
+#define OPTION_HEADLESS "--headless"
+#define OPTION_STATS "--stats"
+#define OPTION_BENCH "--bench"
+#define OPTION_JSON "--json"
+#define OPTION_PROFILE "--profile"
+#define OPTION_SWEEP "--sweep"
+
+/* Engine Names */
+#define ENGINE_DENSE "dense"
+#define ENGINE_PACKED "packed"
+#define ENGINE_HASHLIFE "hashlife"
+#define ENGINE_SPARSE "sparse"
+#define ENGINE_GPU "gpu"
+#define DEFAULT_ENGINE ENGINE_PACKED
+
+/* Step Kernel Names */
+#define KERNEL_AUTO "auto"
+#define KERNEL_SCALAR "scalar"
+#define KERNEL_AVX2 "avx2"
+#define KERNEL_AVX512 "avx512"
+#define KERNEL_NEON "neon"
+
+/* Bit-packed grid layout: one bit per cell, 64 cells per word */
+#define CELLS_PER_WORD 64
+
+/* Grid arena: rows start on cache lines, large arenas on huge pages */
+#define ARENA_ALIGNMENT 64
+#define ARENA_HUGE_PAGE ((size_t)2 * 1024 * 1024)
+#define ARENA_ALIGN(size) (((size) + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1))
+
+/* Temporal blocking: generations per step, and per-thread scratch kept in cache */
+#define DEFAULT_TEMPORAL_BLOCK 1
+#define MAX_TEMPORAL_BLOCK 64
+#define TEMPORAL_BLOCK_CACHE ((size_t)512 * 1024)
+
+/* Cycle detection */
+#define MAX_CYCLE_PERIOD 4096
+
+/* Frame export */
+#define DEFAULT_FRAME_BUFFERS 8      /* Frames queued ahead of the encoder thread */
+#define MAX_FRAME_BUFFERS 1024
+#define MAX_FRAME_SCALE 64
+#define MAX_FRAME_SIZE 16384        /* Pixels per side of an exported frame */
+#define PNG_STORED_BLOCK 65535      /* Longest stored deflate block */
+
+/* Simulation thread of windowed runs */
+#define SIM_COMMANDS 256            /* Input commands queued ahead of the simulation thread */
+#define PUBLISH_FRESH 4u            /* Set in a triple buffer's shared index until it is read */
+
+/* GPU engine: work-group size of the step kernel, and platforms searched for a device */
+#define GPU_GROUP_SIZE 64
+#define GPU_MAX_PLATFORMS 8
+
+/* Distributed runs: longest side of the downsampled view shown by rank 0, in pixels */
+#define DIST_VIEW_SIZE 1024
+
+/* Every rank continues with the worst result of all ranks, so they fail together */
+#if GOL_MPI
+#define DIST_AGREE(ctx, result) dist_agree(ctx, result)
+#else
+#define DIST_AGREE(ctx, result) (result)
+#endif
+
+/* Sparse engine tiles: SPARSE_TILE_SIZE x SPARSE_TILE_SIZE cells, one word per row */
+#define SPARSE_TILE_SIZE CELLS_PER_WORD
+#define SPARSE_INITIAL_SLOTS 64
+
+/* HashLife: log2 of generations per step, and node memory budget */
+#define DEFAULT_HASHLIFE_STEP 0
+#define DEFAULT_HASHLIFE_MEM_MB 512
+#define HASHLIFE_MAX_LEVEL 62
+#define HASHLIFE_MIN_LEVEL 3
+#define HASHLIFE_BLOCK_NODES 16384
+#define HASHLIFE_INITIAL_BUCKETS 65536
+
+/* Binary snapshot format */
+#define SNAPSHOT_MAGIC "GOLSNAP1"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+/* Frame phase timers; build with -DGOL_PROFILE=0 to compile them out */
+#ifndef GOL_PROFILE
+#define GOL_PROFILE 1
+#endif
+#define PROFILE_WINDOW 256       /* Frames kept for the rolling percentiles */
+#define PROFILE_REPORT_MS 1000   /* Interval of the --profile line on stderr */
+#define OVERLAY_SCALE 2          /* Screen pixels per overlay font pixel */
+
+#if GOL_PROFILE
+#define PROFILE_START(name) uint64_t name = profile_now_ns()
+#define PROFILE_STOP(ctx, phase, name) profile_record(&(ctx)->profile, phase, name)
+#define PROFILE_END_FRAME(ctx) profile_end_frame(&(ctx)->profile)
+#else
+#define PROFILE_START(name) ((void)0)
+#define PROFILE_STOP(ctx, phase, name) ((void)0)
+#define PROFILE_END_FRAME(ctx) ((void)0)
+#endif
+
+/* Benchmarks */
+#define BENCH_CONFIG_GLOB "config/*.txt"
+#define BENCH_CONFIG_GENERATIONS 1000
+#define BENCH_SEED 1
+#define BENCH_DENSE_MAX_CELLS ((size_t)8192 * 8192)
+#define BENCH_UNBOUNDED_MAX_CELLS ((size_t)1024 * 1024)
+
+/* Parameter sweeps */
+#define SWEEP_MAX_BOARDS ((size_t)1 << 24)
+
+/* Random initialization */
+#define DEFAULT_DENSITY 0.5
+#define RANDOM_DENSITY_BITS 16
+
+/* Pattern files */
+#define MAX_PATTERNS 16
+#define MACROCELL_HEADER "[M2]"
+#define RLE_LINE_LENGTH 70
+
+/* Dirty tracking tiles of the packed grid: TILE_ROWS rows by one word */
+#define TILE_ROWS 64
+
+/* Board size: each side at most 2^24 cells */
+#define MAX_GRID_SIDE ((size_t)1 << 24)
+
+/* Worker threads: 0 selects one per online CPU */
+#define DEFAULT_THREADS 1
+#define MAX_THREADS 1024
 
 /* Cell States */
 typedef enum {
     CELL_DEAD = 0,
-    CELL_ALIVE = 1,
-    CELL_DYING = -1,
-    CELL_BIRTH = -2
+    CELL_ALIVE = 1
 } cell_state_t;
 
+/* Dense cell storage: one byte holding CELL_DEAD or CELL_ALIVE */
+typedef uint8_t cell_t;
+
 
 /* Return Codes */
 typedef enum {
@@ -47,221 +248,1420 @@ typedef enum {
     GOL_ERROR_FILE = 2,
     GOL_ERROR_CONFIG = 3,
     GOL_ERROR_SDL = 4,
-    GOL_ERROR_MEMORY = 5
+    GOL_ERROR_MEMORY = 5,
+    GOL_ERROR_THREAD = 6
 } gol_result_t;
 
 
+/* Pattern file placed on the board by @pattern */
+typedef struct {
+    char path[MAX_CONFIG_LENGTH];
+    int64_t x;   /* Board column of an RLE top-left corner or a Macrocell root centre */
+    int64_t y;   /* Board row, likewise */
+} gol_pattern_t;
+
+/*
+ * Outer-totalistic rule. Bit n of a mask stands for n live neighbors, so
+ * B36/S23 has birth = (1 << 3) | (1 << 6) and survive = (1 << 2) | (1 << 3).
+ */
+typedef struct gol_rule gol_rule_t;
+
+/* Next state of a packed row under a rule; see packed_step_row() for the layout */
+typedef void (*packed_rule_row_fn)(const uint64_t *restrict above, const uint64_t *restrict middle,
+                                   const uint64_t *restrict below, uint64_t *restrict out,
+                                   size_t words, const gol_rule_t *rule);
+
+struct gol_rule {
+    char name[RULE_NAME_LENGTH];   /* Canonical B/S form, e.g. "B36/S23" */
+    uint16_t birth;                /* Bit n: a dead cell with n neighbors is born */
+    uint16_t survive;              /* Bit n: a live cell with n neighbors survives */
+    bool conway;                   /* B3/S23, stepped by the kernels' own row functions */
+    uint8_t next[2][16];           /* Next state by [alive][neighbors], 16 wide for byte shuffles */
+    packed_rule_row_fn packed_row; /* Circuit generated for the rule, or the generic one */
+};
+
+/* What lies beyond the edges of a bounded board */
+typedef enum {
+    BOUNDARY_DEAD,    /* Dead cells */
+    BOUNDARY_TORUS,   /* Opposite edges are joined */
+    BOUNDARY_KLEIN,   /* Left and right are joined; top and bottom are joined flipped */
+    BOUNDARY_MIRROR,  /* Each edge reflects the cells next to it */
+    BOUNDARY_COUNT
+} gol_boundary_t;
+
 /* Configuration Structure */
 typedef struct {
     size_t rows;
     size_t cols;
-    unsigned int steps;
+    uint64_t steps;
     unsigned int seed;
+    double density;            /* Share of live cells for @config random */
+    unsigned int threads;
+    unsigned int gens_per_frame;
+    unsigned int hashlife_step;
+    unsigned int hashlife_mem_mb;
+    unsigned int temporal_block;   /* Generations per cache-blocked step, 1 for off */
+    unsigned int cycle_period;     /* Longest period @detect_cycles looks for, 0 for off */
+    uint64_t checkpoint_every;
+    uint64_t frame_every;          /* Generations between exported frames */
+    unsigned int frame_scale;      /* Pixels per cell side of exported frames */
+    unsigned int frame_buffers;    /* Frames queued ahead of the encoder */
+    unsigned int sim_thread;       /* Windowed: 1 to simulate on a thread of its own */
     char config_type[MAX_CONFIG_LENGTH];
+    char render_mode[MAX_CONFIG_LENGTH];
+    char engine_name[MAX_CONFIG_LENGTH];
+    char kernel_name[MAX_CONFIG_LENGTH];
+    char rule_name[MAX_CONFIG_LENGTH];
+    gol_rule_t rule;                         /* Parsed from rule_name */
+    char boundary_name[MAX_CONFIG_LENGTH];
+    gol_boundary_t boundary;                 /* Parsed from boundary_name */
+    char snapshot_path[MAX_CONFIG_LENGTH];   /* Snapshot loaded by @config snapshot */
+    char checkpoint_path[MAX_CONFIG_LENGTH]; /* Snapshot saved by checkpoints, "" for none */
+    char export_path[MAX_CONFIG_LENGTH];     /* Pattern written on exit, "" for none */
+    char trace_path[MAX_CONFIG_LENGTH];      /* Chrome trace of the frame phases, "" for none */
+    char frames_path[MAX_CONFIG_LENGTH];     /* Frame files or |command, "" for none */
+    gol_pattern_t patterns[MAX_PATTERNS];
+    size_t pattern_count;
 } gol_config_t;
 
+/*
+ * Snapshot file header, followed by rows * words_per_row uint64_t words.
+ * Its size is a multiple of 8, so the payload stays aligned in a mapping.
+ */
+typedef struct {
+    char magic[8];          /* SNAPSHOT_MAGIC, without terminator */
+    uint32_t version;       /* SNAPSHOT_VERSION */
+    uint32_t byte_order;    /* SNAPSHOT_BYTE_ORDER in the writer's byte order */
+    uint64_t rows;
+    uint64_t cols;
+    uint64_t generation;
+    uint64_t words_per_row;
+    char rule[32];          /* Rule the cells evolve under, e.g. "B3/S23" */
+    char engine[32];        /* Engine that saved the snapshot, informational */
+} gol_snapshot_header_t;
+
+/* Read-only mapping of a snapshot file */
+typedef struct {
+    void *map;
+    size_t size;
+    const gol_snapshot_header_t *header;
+    const uint64_t *rows;   /* Payload, right after the header */
+} gol_snapshot_t;
+
+/* Random fill job, split into row bands */
+typedef struct {
+    uint64_t *rows;         /* Output, bit-packed like snapshot rows */
+    size_t words;           /* Words per row */
+    size_t row_count;
+    size_t first_row;       /* Board row of output row 0 */
+    size_t first_word;      /* Board word of output word 0 */
+    size_t board_words;     /* Words per row of the whole board */
+    uint64_t key;           /* Stream key derived from the seed */
+    uint32_t threshold;     /* Density in units of 2^-RANDOM_DENSITY_BITS */
+} gol_random_fill_t;
+
+/* Read-only mapping of a configuration file, parsed in one pass */
+typedef struct {
+    void *map;              /* NULL for an empty file */
+    size_t size;
+    size_t grid;            /* Offset of the line after @grid, SIZE_MAX if there is none */
+} gol_config_text_t;
+
+/*
+ * Grid arena: a single zeroed mapping holding every buffer of the dense
+ * or packed engine, handed out by bumping an offset. Blocks are aligned
+ * to ARENA_ALIGNMENT and live until the arena is destroyed.
+ */
+typedef struct {
+    uint8_t *base;       /* Start of the mapping, NULL if there is none */
+    size_t size;         /* Bytes mapped */
+    size_t used;         /* Bytes handed out */
+} gol_arena_t;
+
+/*
+ * Dense grid: one byte per cell, rows `stride` bytes apart in two flat
+ * buffers. Cell 0 of every row starts a cache line; the left halo cell
+ * is the last byte of the previous row's line block.
+ */
+typedef struct {
+    cell_t *front;       /* Current generation, points at row 0 cell 0 */
+    cell_t *back;        /* Next generation, same layout as front */
+    size_t stride;       /* Bytes per row, at least cols + 2 */
+} gol_dense_grid_t;
+
+/*
+ * Bit-packed grid. Each row holds `words` 64-bit words of cells (bit b of
+ * word w is column w * 64 + b) surrounded by one halo word on each side,
+ * and the grid is surrounded by one halo row above and below. Halo words
+ * are always zero, which implements the dead boundary without any bounds
+ * checks in the step kernel. Rows are `stride` words apart, so word 0 of
+ * every row starts a cache line and the left halo word ends the previous
+ * row's line block.
+ * 
+ * The grid is also divided into tiles of TILE_ROWS rows by one word, with
+ * per-tile flags (plus a halo ring of always-clear flags). A tile whose
+ * 3x3 tile neighborhood did not change in the last generation cannot
+ * change in the next one, so the step skips it; its back buffer already
+ * holds the same cells as the front buffer. Editing a cell marks its tile.
+ * 
+ * Level l of the LOD levels has bit c of row r set when any cell of the
+ * 2^l by 2^l block (c, r) is alive. Each level is one bit per block in
+ * plain rows of ceil(blocks / 64) words, and is reduced from the one
+ * below it 2x2 blocks at a time, only where tiles changed.
+ */
+typedef struct {
+    uint64_t *storage;   /* Arena block holding both buffers */
+    uint64_t *front;     /* Current generation, points at row 0 word 0 */
+    uint64_t *back;      /* Next generation, same layout as front */
+    size_t words;        /* Words per row holding cells */
+    size_t stride;       /* Words between rows, at least words + 2 */
+    uint64_t last_mask;  /* Valid cells in the last word of each row */
+    uint8_t *tile_storage; /* Arena block holding the tile flags */
+    uint8_t *changed;      /* Tile changed in the last generation */
+    uint8_t *next_changed; /* Tile changes of the generation being computed */
+    uint8_t *redraw;       /* Tile changed since the last flush_dirty() */
+    uint8_t *lod_dirty;    /* Tile changed since the last update of the LOD levels */
+    size_t tiles_x;        /* Tile columns, equal to words */
+    size_t tiles_y;        /* Tile rows */
+    size_t tile_stride;    /* Flags per tile row including the halo */
+    /* OR-reduced levels for zoomed-out drawing, allocated when first drawn */
+    uint64_t *lod[MAX_LOD_LEVEL + 1];
+    unsigned int lod_levels;
+} gol_packed_grid_t;
+
+/*
+ * Sparse grid tile: SPARSE_TILE_SIZE rows of one word, bit b of row r is
+ * cell (x * 64 + b, y * 64 + r) of the unbounded universe.
+ */
+typedef struct {
+    int64_t x;           /* Tile column */
+    int64_t y;           /* Tile row */
+    uint64_t population; /* Live cells in the tile */
+    uint64_t rows[SPARSE_TILE_SIZE];
+} gol_sparse_tile_t;
+
+/* Hash map from tile coordinates to tiles, open addressing with linear probing */
+typedef struct {
+    gol_sparse_tile_t *tiles; /* Dense array of tiles, in insertion order */
+    size_t count;
+    size_t capacity;
+    size_t *slots;            /* Tile index + 1, or 0 for an empty slot */
+    size_t slot_count;        /* Power of two, at least twice count */
+} gol_sparse_map_t;
+
+/*
+ * Sparse grid. Only tiles holding live cells, or next to tiles that do,
+ * are stored, so memory and step time follow the population rather than
+ * the board area. The next generation is built in the second map.
+ */
+typedef struct {
+    gol_sparse_map_t maps[2];
+    unsigned int current;     /* Index of the map holding the current generation */
+} gol_sparse_grid_t;
+
+/*
+ * Population statistics, kept up to date by the engines while they step
+ * and edit cells, so reading them never rescans the grid.
+ */
+typedef struct {
+    uint64_t population; /* Live cells in the universe, the board for bounded engines */
+    uint64_t births;     /* Cells born in the last step, summed over all its generations */
+    uint64_t deaths;     /* Cells that died in the last step, summed the same way */
+} gol_stats_t;
+
+/* Rectangular region of cells */
+typedef struct {
+    size_t row;
+    size_t col;
+    size_t rows;
+    size_t cols;
+} gol_region_t;
+
+struct gol_engine;
+
+/*
+ * Reusable barrier built on a mutex and condition variable, since
+ * pthread_barrier_t is not available on every platform (e.g. macOS).
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    size_t count;        /* Threads taking part */
+    size_t waiting;      /* Threads arrived in the current phase */
+    unsigned long phase; /* Incremented each time the barrier opens */
+} gol_barrier_t;
+
+/* Work run by every pool thread: index identifies the band in [0, count) */
+typedef void (*gol_task_fn)(void *arg, size_t index, size_t count);
+
+/*
+ * Persistent worker pool. The calling thread takes part as band 0 and the
+ * workers as bands 1..count-1; two barrier waits bracket every task.
+ */
+typedef struct {
+    pthread_t *threads;  /* count - 1 worker threads */
+    size_t count;        /* Total threads, including the caller */
+    gol_barrier_t start;
+    gol_barrier_t done;
+    gol_task_fn task;
+    void *arg;
+    bool shutdown;
+} gol_thread_pool_t;
+
+/* Start-up argument of a pool worker thread */
+typedef struct {
+    gol_thread_pool_t *pool;
+    size_t index;
+} gol_worker_arg_t;
+
+/*
+ * Row kernels used by the dense and packed engines. Each kernel set
+ * computes one output row from the rows above, at and below it; the
+ * halo supplies the neighbors of the first and last cell. The plain row
+ * functions hard-code B3/S23; other rules take the rule-driven ones.
+ */
+typedef void (*dense_row_fn)(const cell_t *restrict above, const cell_t *restrict middle,
+                             const cell_t *restrict below, cell_t *restrict out, size_t cols);
+typedef void (*packed_row_fn)(const uint64_t *restrict above, const uint64_t *restrict middle,
+                              const uint64_t *restrict below, uint64_t *restrict out,
+                              size_t words);
+/* Dense row under any rule, looked up in rule->next */
+typedef void (*dense_rule_row_fn)(const cell_t *restrict above, const cell_t *restrict middle,
+                                  const cell_t *restrict below, cell_t *restrict out,
+                                  size_t cols, const gol_rule_t *rule);
+
+
+/* Count the cells born and died between the previous and the computed row */
+typedef void (*dense_changes_fn)(const cell_t *restrict before, const cell_t *restrict after,
+                                 size_t cols, uint64_t *births, uint64_t *deaths);
+/* Compare a computed span of packed words with the previous generation */
+typedef void (*packed_changes_fn)(const uint64_t *restrict before, const uint64_t *restrict after,
+                                  size_t words, uint8_t *restrict changed,
+                                  uint64_t *restrict births, uint64_t *restrict deaths);
+
+typedef struct {
+    const char *name;
+    bool (*supported)(void);
+    dense_row_fn dense_row;
+    packed_row_fn packed_row;
+    dense_rule_row_fn dense_rule_row;
+    dense_changes_fn dense_changes;
+    packed_changes_fn packed_changes;
+} gol_kernel_t;
+
+/*
+ * HashLife quadtree node. A node of level k is a 2^k x 2^k square built
+ * from four level k-1 children; the two level 0 nodes are the dead and
+ * the live cell. Nodes are canonical, so equal squares share one node.
+ */
+typedef struct hl_node {
+    struct hl_node *nw, *ne, *sw, *se; /* Children, NULL for leaves */
+    struct hl_node *next;      /* Hash chain, or free list link */
+    struct hl_node *result;    /* Memoized RESULT, NULL until computed */
+    uint64_t population;       /* Live cells in the square */
+    uint8_t level;
+    uint8_t marked;            /* Reachable in the current collection */
+    uint8_t bits;              /* Level 1 only: nw | ne << 1 | sw << 2 | se << 3 */
+} hl_node_t;
+
+/*
+ * Nodes held by a RESULT computation in progress. The frames of a jump
+ * form a stack, and a collection during the jump keeps their nodes.
+ */
+typedef struct hl_frame {
+    struct hl_frame *parent;
+    hl_node_t *nodes[14];      /* The node, its nine squares, then its quarters */
+} hl_frame_t;
+
+/* HashLife engine state: node store, canonical table and root */
+typedef struct gol_hashlife {
+    hl_node_t leaf[2];                         /* Dead and live cell */
+    hl_node_t *empty[HASHLIFE_MAX_LEVEL + 1];  /* All-dead node of each level */
+    hl_node_t *level1[16];                     /* Level 1 node of each 2x2 code */
+    uint8_t lut[1 << 16];    /* 4x4 square -> level 1 code of its next centre */
+    hl_node_t **buckets;     /* Canonical table, bucket_count is a power of two */
+    size_t bucket_count;
+    size_t node_count;       /* Nodes in the table */
+    size_t memory;           /* Bytes of the table, the blocks and the block list */
+    size_t memory_budget;    /* @hashlife_mem in bytes */
+    bool bounded;            /* Set during jumps: storage may not grow past the budget */
+    bool exhausted;          /* A bounded allocation failed, so the jump is abandoned */
+    hl_frame_t *frames;      /* Innermost RESULT in progress, NULL between jumps */
+    hl_node_t **blocks;      /* Node storage, HASHLIFE_BLOCK_NODES per block */
+    size_t block_count;
+    size_t block_capacity;
+    size_t block_used;       /* Nodes handed out from the last block */
+    hl_node_t *free_list;    /* Nodes recycled by the collector */
+    hl_node_t *root;         /* Universe, centered on the origin */
+    unsigned int step_log;   /* RESULT advances 2^min(step_log, level - 2) */
+} gol_hashlife_t;
+
+/* Phases of a frame of run_simulation(), in the order they run */
+typedef enum {
+    PHASE_EVENTS,
+    PHASE_RENDER,
+    PHASE_PRESENT,
+    PHASE_SIMULATE,
+    PHASE_DELAY,
+    PHASE_COUNT
+} gol_phase_t;
+
+#if GOL_PROFILE
+/* Rolling frame phase timings */
+typedef struct {
+    uint64_t samples[PHASE_COUNT][PROFILE_WINDOW];  /* Durations in ns, slot frames % window */
+    uint64_t frames;          /* Frames completed */
+    uint64_t origin_ns;       /* Run start; trace timestamps are relative to it */
+    uint64_t last_report_ns;
+    FILE *trace;              /* Chrome trace-event output, NULL when off */
+    bool trace_started;       /* An event was written, so the next needs a comma */
+    bool overlay;             /* Draw the timings over the board (P key) */
+    bool report;              /* Print a stderr line every PROFILE_REPORT_MS (--profile) */
+} gol_profile_t;
+#endif
+
+/*
+ * Cycle detection of headless runs. The board hash after each of the
+ * last `capacity` steps is kept in a ring. A hash seen again makes its
+ * distance a candidate period, which is confirmed when the board one
+ * period later equals a copy taken at the repeat.
+ */
+typedef struct {
+    uint64_t *hashes;       /* Board hash after step n at hashes[n % capacity] */
+    size_t capacity;        /* Steps kept, the longest period looked for */
+    uint64_t steps;         /* Steps recorded; step 0 is the starting board */
+    uint64_t *rows;         /* Board at the candidate's repeat, packed like snapshot rows */
+    uint64_t *scratch;      /* Rows for hashing and comparing the current board */
+    uint64_t candidate;     /* Candidate period in generations, 0 for none */
+    uint64_t confirm_step;  /* Step whose board must equal rows */
+    uint64_t start;         /* Generation the cycle was first entered */
+    uint64_t period;        /* Confirmed period in generations, 0 until found */
+} gol_cycle_t;
+
+/*
+ * Windowed view onto the board. The window keeps a fixed size and shows
+ * the board at 2^zoom pixels per cell side; below zero, each pixel shows a
+ * block of 2^-zoom by 2^-zoom cells, alive if any of its cells is. The
+ * position is kept in 1/2^VIEW_MAX_ZOOM cells, always a whole number of
+ * pixels, so every transform is exact integer arithmetic.
+ */
+typedef struct {
+    int64_t x;            /* Left window edge, in 1/2^VIEW_MAX_ZOOM cells */
+    int64_t y;            /* Top window edge */
+    int zoom;             /* log2 of pixels per cell side */
+    int min_zoom;         /* Zoom at which the whole board fits, or 0 if it fits closer */
+    int width;            /* Window size in pixels */
+    int height;
+    bool drawn_valid;     /* The texture holds the cells of `drawn` */
+    gol_region_t drawn;   /* Cells in the texture from texel (0, 0) at zoom >= 0 */
+    uint32_t *scratch;    /* One row of pixels for engines without draw_blocks() */
+    size_t scratch_size;
+} gol_view_t;
+
+/* Controls of a windowed run */
+typedef struct {
+    unsigned int gens_per_frame;
+    bool paused;          /* Stepping stops, except toward run_to */
+    uint64_t run_to;      /* Step up to this generation and pause, 0 for none */
+    uint64_t count;       /* Number typed before N or G, 0 for none */
+} gol_controls_t;
+
 /* Game Context Structure */
 typedef struct {
     size_t rows;
     size_t cols;
-    cell_state_t **grid;
+    const struct gol_engine *engine;
+    const gol_kernel_t *kernel;
+    gol_thread_pool_t *pool;
+    gol_arena_t arena;         /* Dense and packed engines: every grid buffer */
+    uint64_t *board_rows;      /* Arena scratch for bit-packed board fills, or NULL */
+    gol_arena_t block_arena;   /* Temporal blocking: per-thread scratch rows */
+    gol_dense_grid_t dense;
+    gol_packed_grid_t packed;
+    gol_sparse_grid_t sparse;
+    struct gol_hashlife *hashlife;  /* HashLife engine state */
+    struct gol_gpu *gpu;       /* GPU engine state */
+    struct gol_dist *dist;     /* Distributed run state, NULL for a single process */
+    size_t origin_row;         /* Board cell of local cell (0, 0); non-zero only when */
+    size_t origin_col;         /* the board is split between ranks */
+    uint64_t generation;       /* Generations simulated since the last reset */
+    uint64_t step_generations; /* Generations advanced by one simulate_step() */
+    gol_stats_t stats;
+    bool log_stats;            /* Headless: print the statistics of every step */
+    gol_cycle_t *cycle;        /* Headless: cycle detection, NULL when off */
+    struct gol_frames *frames; /* Frame export, NULL when off */
+    struct gol_sim *sim;       /* Windowed: simulation thread, NULL when the window steps */
+    bool track_hash;           /* Steps add their changes to board_hash; edits do not */
+    uint64_t board_hash;       /* Sum of board_word_hash() over the board's words */
     SDL_Window *window;
     SDL_Renderer *renderer;
+    SDL_Texture *texture;      /* One texel per window pixel, NULL if it could not be created */
+    gol_view_t view;
+#if GOL_PROFILE
+    gol_profile_t profile;
+#endif
     gol_config_t config;
 } gol_context_t;
 
+/* Callback receiving one region of cells */
+typedef void (*gol_region_fn)(gol_context_t *ctx, const gol_region_t *region, void *arg);
+
+/*
+ * Row operations of a bounded engine for temporal blocking. Scratch rows
+ * have the engine's own layout: a row pointer addresses cell 0, rows are
+ * row_bytes() apart and carry a halo cell on each side.
+ */
+typedef struct {
+    size_t (*row_bytes)(const gol_context_t *ctx);
+    /* Copy board row `row` of the current generation, reversed if flip; SIZE_MAX gives a dead row */
+    void (*load_row)(const gol_context_t *ctx, void *out, size_t row, bool flip);
+    /* Set the halo cells of a row from its edges, as the boundary wraps or reflects */
+    void (*fill_row_halo)(const gol_context_t *ctx, void *row);
+    /* Compute the next state of board row `row`; births and deaths are counted unless NULL */
+    void (*step_row)(gol_context_t *ctx, const void *above, const void *middle,
+                     const void *below, void *out, size_t row, uint64_t *births,
+                     uint64_t *deaths);
+    /* Board row `row` of the next generation */
+    void *(*back_row)(gol_context_t *ctx, size_t row);
+    /* Optional: prepare a band of rows before its blocks are stepped */
+    void (*begin)(gol_context_t *ctx, size_t row_begin, size_t row_end);
+} gol_block_ops_t;
+
+/*
+ * Simulation engine interface. Every grid backend implements the same
+ * operations so that parsing, rendering and input handling are shared.
+ */
+typedef struct gol_engine {
+    const char *name;
+    gol_result_t (*allocate)(gol_context_t *ctx);
+    void (*deallocate)(gol_context_t *ctx);
+    void (*step)(gol_context_t *ctx);
+    /* Optional split of step() for band-parallel execution */
+    void (*step_rows)(gol_context_t *ctx, size_t row_begin, size_t row_end);
+    void (*swap_buffers)(gol_context_t *ctx);
+    size_t band_rows;    /* Band boundaries must be multiples of this */
+    bool (*get_cell)(const gol_context_t *ctx, size_t row, size_t col);
+    void (*set_cell)(gol_context_t *ctx, size_t row, size_t col, bool alive);
+    /* Live cells on the board */
+    uint64_t (*count_alive)(const gol_context_t *ctx);
+    void (*clear)(gol_context_t *ctx);
+    /* step() adds the births and deaths it makes to ctx->stats */
+    bool counts_changes;
+    /* With ctx->track_hash set, step() adds the hash changes it makes to ctx->board_hash */
+    bool tracks_hash;
+    /* Optional: advance an exact number of generations faster than repeated steps */
+    void (*advance)(gol_context_t *ctx, uint64_t generations);
+    /* Write a region of the grid as ARGB8888 pixels, pitch given in pixels */
+    void (*draw)(const gol_context_t *ctx, const gol_region_t *region,
+                 uint32_t *pixels, size_t pitch);
+    /* Optional: copy the board in or out as packed rows, as in the snapshot payload */
+    void (*read_rows)(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row);
+    void (*write_rows)(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row);
+    /* Optional: report the regions changed since the last call, then forget them */
+    void (*flush_dirty)(gol_context_t *ctx, gol_region_fn emit, void *arg);
+    /*
+     * Optional: write a region of blocks of 2^level cells per side, one pixel
+     * per block, alive if any of its cells is. Returns false if it could not,
+     * and the caller then reduces the pixels from draw().
+     */
+    bool (*draw_blocks)(gol_context_t *ctx, const gol_region_t *blocks, unsigned int level,
+                        uint32_t *pixels, size_t pitch);
+    /* Bounded engines: copy the edges into the halo for a boundary other than dead */
+    void (*fill_halo)(gol_context_t *ctx);
+    /* Optional: row operations for @temporal_block; steps then go through block_step() */
+    const gol_block_ops_t *block;
+} gol_engine_t;
+
+static const char *const boundary_names[BOUNDARY_COUNT] = {
+    [BOUNDARY_DEAD] = BOUNDARY_DEAD_NAME,
+    [BOUNDARY_TORUS] = BOUNDARY_TORUS_NAME,
+    [BOUNDARY_KLEIN] = BOUNDARY_KLEIN_NAME,
+    [BOUNDARY_MIRROR] = BOUNDARY_MIRROR_NAME
+};
+
 
 /* Forward Declarations */
-static gol_result_t parse_config_file(const char *filename, gol_config_t *config);
-static gol_result_t parse_manual_config(const char *filename, gol_context_t *ctx);
+static gol_result_t config_map(const char *filename, gol_config_text_t *text);
+static void config_unmap(gol_config_text_t *text);
+static void config_set_defaults(gol_config_t *config);
+static gol_result_t parse_config_file(gol_config_text_t *text, gol_config_t *config);
+static gol_result_t parse_manual_config(const gol_config_text_t *text, gol_context_t *ctx);
+static const gol_engine_t *find_engine(const char *name);
+static const gol_kernel_t *find_kernel(const char *name);
+static bool rule_parse(const char *text, gol_rule_t *rule);
 static gol_result_t allocate_grid(gol_context_t *ctx);
 static void deallocate_grid(gol_context_t *ctx);
+static void engine_out_of_memory(const char *engine);
+static inline bool get_cell(const gol_context_t *ctx, size_t row, size_t col);
+static inline void set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive);
+static inline void stats_add_changes(gol_context_t *ctx, uint64_t births, uint64_t deaths);
 static gol_result_t initialize_sdl(gol_context_t *ctx);
+static gol_result_t initialize_sdl_view(gol_context_t *ctx, size_t rows, size_t cols,
+                                        int scale);
 static void cleanup_sdl(gol_context_t *ctx);
-static void initialize_grid_random(gol_context_t *ctx);
-static void initialize_grid_manual(gol_context_t *ctx, const char *filename);
+static void clear_grid(gol_context_t *ctx);
+static void write_board_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row);
+static void read_board_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row);
+static gol_result_t initialize_grid_random(gol_context_t *ctx);
+static void initialize_grid_manual(gol_context_t *ctx, const gol_config_text_t *text);
+static gol_result_t snapshot_map(const char *filename, const gol_rule_t *rule,
+                                 gol_snapshot_t *snapshot);
+static void snapshot_unmap(gol_snapshot_t *snapshot);
+static void snapshot_apply(gol_context_t *ctx, const gol_snapshot_t *snapshot);
+static gol_result_t snapshot_save(const gol_context_t *ctx, const char *filename);
+static gol_result_t place_patterns(gol_context_t *ctx);
+static gol_result_t pattern_export(const gol_context_t *ctx, const char *filename);
+static unsigned int online_cpus(void);
+static gol_result_t thread_pool_create(gol_thread_pool_t **pool, unsigned int threads);
+static void thread_pool_destroy(gol_thread_pool_t *pool);
+static void thread_pool_run(gol_thread_pool_t *pool, gol_task_fn task, void *arg);
 static void simulate_step(gol_context_t *ctx);
-static void render_grid(const gol_context_t *ctx);
-static void handle_mouse_click(gol_context_t *ctx, int x, int y);
-static int count_neighbors(const gol_context_t *ctx, size_t row, size_t col);
-static int count_alive_cells(const gol_context_t *ctx);
+static void advance_generations(gol_context_t *ctx, uint64_t generations);
+static gol_result_t cycle_create(gol_context_t *ctx);
+static void cycle_destroy(gol_context_t *ctx);
+static void cycle_record(gol_context_t *ctx);
+static uint64_t cycle_skip(gol_context_t *ctx, uint64_t generations);
+static bool frames_file_name(const char *pattern, uint64_t number, char *out, size_t size);
+static gol_result_t frames_create(gol_context_t *ctx);
+static gol_result_t frames_destroy(gol_context_t *ctx);
+static void frames_capture(gol_context_t *ctx);
+static void frames_advanced(gol_context_t *ctx, uint64_t generations);
+static gol_result_t sim_create(gol_context_t *ctx, const gol_controls_t *controls);
+static void sim_destroy(gol_context_t *ctx);
+static void view_reset(gol_context_t *ctx);
+static void view_zoom(gol_context_t *ctx, int zoom, int x, int y);
+static void view_pan(gol_context_t *ctx, int dx, int dy);
+static bool view_visible(const gol_context_t *ctx, gol_region_t *units, SDL_Rect *dest);
+static void render_grid(gol_context_t *ctx);
+static void render_grid_rects(const gol_context_t *ctx);
+static void draw_region(gol_context_t *ctx, const gol_region_t *region, void *arg);
+static void draw_blocks_from_cells(gol_context_t *ctx, const gol_region_t *blocks,
+                                   unsigned int level, uint32_t *pixels, size_t pitch);
+static void published_draw(const gol_context_t *ctx, const gol_region_t *units,
+                           unsigned int level, uint32_t *pixels, size_t pitch);
+static void handle_mouse_click(gol_context_t *ctx, gol_controls_t *controls, int x, int y);
+static uint64_t count_alive_cells(const gol_context_t *ctx);
 static void print_grid_console(const gol_context_t *ctx);
-static bool is_valid_position(const gol_context_t *ctx, int row, int col);
+static void update_window_title(const gol_context_t *ctx, const gol_controls_t *controls,
+                                uint64_t generation);
+static double now_seconds(void);
+static gol_result_t run_headless(gol_context_t *ctx);
+static void print_stats_line(const gol_context_t *ctx, uint64_t generations);
+static gol_result_t run_benchmarks(int count, char **args, bool json);
+static gol_result_t run_sweep(const char *filename);
+#if GOL_MPI
+static gol_result_t dist_create(gol_context_t *ctx);
+static void dist_destroy(gol_context_t *ctx);
+static gol_result_t dist_agree(const gol_context_t *ctx, gol_result_t result);
+static void dist_step(gol_context_t *ctx);
+static gol_stats_t dist_total_stats(const gol_context_t *ctx);
+static gol_result_t dist_snapshot_save(const gol_context_t *ctx, const char *filename);
+static gol_result_t dist_report(const gol_context_t *ctx, uint64_t steps, double elapsed);
+static gol_result_t dist_run_simulation(gol_context_t *ctx);
+#endif
+static bool arena_size(size_t count, size_t size, size_t extra, size_t *bytes);
+static gol_result_t arena_create(gol_arena_t *arena, size_t size);
+static void *arena_alloc(gol_arena_t *arena, size_t size);
+static void arena_destroy(gol_arena_t *arena);
+static void dense_step_row(const cell_t *restrict above, const cell_t *restrict middle,
+                           const cell_t *restrict below, cell_t *restrict out, size_t cols);
+static gol_result_t dense_allocate(gol_context_t *ctx);
+static void dense_deallocate(gol_context_t *ctx);
+static void dense_count_changes(const cell_t *restrict before, const cell_t *restrict after,
+                                size_t cols, uint64_t *births, uint64_t *deaths);
+static void dense_step_rows(gol_context_t *ctx, size_t row_begin, size_t row_end);
+static void dense_swap_buffers(gol_context_t *ctx);
+static void dense_step(gol_context_t *ctx);
+static void dense_fill_halo(gol_context_t *ctx);
+static size_t dense_block_row_bytes(const gol_context_t *ctx);
+static void dense_block_load_row(const gol_context_t *ctx, void *out, size_t row, bool flip);
+static void dense_block_fill_row_halo(const gol_context_t *ctx, void *row);
+static void dense_block_step_row(gol_context_t *ctx, const void *above, const void *middle,
+                                 const void *below, void *out, size_t row, uint64_t *births,
+                                 uint64_t *deaths);
+static void *dense_block_back_row(gol_context_t *ctx, size_t row);
+static bool dense_get_cell(const gol_context_t *ctx, size_t row, size_t col);
+static void dense_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive);
+static uint64_t dense_count_alive(const gol_context_t *ctx);
+static void dense_clear(gol_context_t *ctx);
+static void dense_draw(const gol_context_t *ctx, const gol_region_t *region,
+                       uint32_t *pixels, size_t pitch);
+static bool dense_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                              unsigned int level, uint32_t *pixels, size_t pitch);
+static void dense_read_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row);
+static gol_result_t packed_allocate(gol_context_t *ctx);
+static void packed_deallocate(gol_context_t *ctx);
+static void packed_step_row(const uint64_t *restrict above, const uint64_t *restrict middle,
+                            const uint64_t *restrict below, uint64_t *restrict out,
+                            size_t words);
+static void packed_step_region(gol_context_t *ctx, size_t row_begin, size_t row_end,
+                               size_t word_begin, size_t word_end);
+static void packed_step_rows(gol_context_t *ctx, size_t row_begin, size_t row_end);
+static void packed_swap_buffers(gol_context_t *ctx);
+static void packed_step(gol_context_t *ctx);
+static void packed_fill_halo(gol_context_t *ctx);
+static size_t packed_block_row_bytes(const gol_context_t *ctx);
+static void packed_block_load_row(const gol_context_t *ctx, void *out, size_t row, bool flip);
+static void packed_block_fill_row_halo(const gol_context_t *ctx, void *row);
+static void packed_block_step_row(gol_context_t *ctx, const void *above, const void *middle,
+                                  const void *below, void *out, size_t row, uint64_t *births,
+                                  uint64_t *deaths);
+static void *packed_block_back_row(gol_context_t *ctx, size_t row);
+static void packed_block_begin(gol_context_t *ctx, size_t row_begin, size_t row_end);
+static bool packed_get_cell(const gol_context_t *ctx, size_t row, size_t col);
+static void packed_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive);
+static uint64_t packed_count_alive(const gol_context_t *ctx);
+static void packed_clear(gol_context_t *ctx);
+static void packed_draw(const gol_context_t *ctx, const gol_region_t *region,
+                        uint32_t *pixels, size_t pitch);
+static void packed_read_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row);
+static void packed_write_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row);
+static void packed_flush_dirty(gol_context_t *ctx, gol_region_fn emit, void *arg);
+static bool packed_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                               unsigned int level, uint32_t *pixels, size_t pitch);
+static gol_result_t sparse_allocate(gol_context_t *ctx);
+static void sparse_deallocate(gol_context_t *ctx);
+static void sparse_step(gol_context_t *ctx);
+static bool sparse_get_cell(const gol_context_t *ctx, size_t row, size_t col);
+static void sparse_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive);
+static uint64_t sparse_count_alive(const gol_context_t *ctx);
+static void sparse_clear(gol_context_t *ctx);
+static void sparse_draw(const gol_context_t *ctx, const gol_region_t *region,
+                        uint32_t *pixels, size_t pitch);
+static bool sparse_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                               unsigned int level, uint32_t *pixels, size_t pitch);
+static gol_result_t hashlife_allocate(gol_context_t *ctx);
+static void hashlife_deallocate(gol_context_t *ctx);
+static void hashlife_step(gol_context_t *ctx);
+static void hashlife_advance(gol_context_t *ctx, uint64_t generations);
+static bool hashlife_get_cell(const gol_context_t *ctx, size_t row, size_t col);
+static void hashlife_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive);
+static uint64_t hashlife_count_alive(const gol_context_t *ctx);
+static void hashlife_clear(gol_context_t *ctx);
+static void hashlife_draw(const gol_context_t *ctx, const gol_region_t *region,
+                          uint32_t *pixels, size_t pitch);
+static bool hashlife_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                                 unsigned int level, uint32_t *pixels, size_t pitch);
+static void hashlife_write_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row);
+
+#if GOL_OPENCL
+static gol_result_t gpu_allocate(gol_context_t *ctx);
+static void gpu_deallocate(gol_context_t *ctx);
+static void gpu_step(gol_context_t *ctx);
+static void gpu_fill_halo(gol_context_t *ctx);
+static bool gpu_get_cell(const gol_context_t *ctx, size_t row, size_t col);
+static void gpu_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive);
+static uint64_t gpu_count_alive(const gol_context_t *ctx);
+static void gpu_clear(gol_context_t *ctx);
+static void gpu_draw(const gol_context_t *ctx, const gol_region_t *region,
+                     uint32_t *pixels, size_t pitch);
+static bool gpu_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                            unsigned int level, uint32_t *pixels, size_t pitch);
+static void gpu_read_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row);
+static void gpu_write_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row);
+#endif
+
+/* Row operations for temporal blocking */
+static const gol_block_ops_t dense_block_ops = {
+    .row_bytes = dense_block_row_bytes,
+    .load_row = dense_block_load_row,
+    .fill_row_halo = dense_block_fill_row_halo,
+    .step_row = dense_block_step_row,
+    .back_row = dense_block_back_row
+};
+
+static const gol_block_ops_t packed_block_ops = {
+    .row_bytes = packed_block_row_bytes,
+    .load_row = packed_block_load_row,
+    .fill_row_halo = packed_block_fill_row_halo,
+    .step_row = packed_block_step_row,
+    .back_row = packed_block_back_row,
+    .begin = packed_block_begin
+};
+
+/* Available Engines */
+static const gol_engine_t dense_engine = {
+    .name = ENGINE_DENSE,
+    .allocate = dense_allocate,
+    .deallocate = dense_deallocate,
+    .step = dense_step,
+    .step_rows = dense_step_rows,
+    .swap_buffers = dense_swap_buffers,
+    .band_rows = 1,
+    .get_cell = dense_get_cell,
+    .set_cell = dense_set_cell,
+    .count_alive = dense_count_alive,
+    .clear = dense_clear,
+    .counts_changes = true,
+    .draw = dense_draw,
+    .draw_blocks = dense_draw_blocks,
+    .read_rows = dense_read_rows,
+    .fill_halo = dense_fill_halo,
+    .block = &dense_block_ops
+};
+
+static const gol_engine_t packed_engine = {
+    .name = ENGINE_PACKED,
+    .allocate = packed_allocate,
+    .deallocate = packed_deallocate,
+    .step = packed_step,
+    .step_rows = packed_step_rows,
+    .swap_buffers = packed_swap_buffers,
+    .band_rows = TILE_ROWS,
+    .get_cell = packed_get_cell,
+    .set_cell = packed_set_cell,
+    .count_alive = packed_count_alive,
+    .clear = packed_clear,
+    .counts_changes = true,
+    .tracks_hash = true,
+    .draw = packed_draw,
+    .read_rows = packed_read_rows,
+    .write_rows = packed_write_rows,
+    .flush_dirty = packed_flush_dirty,
+    .draw_blocks = packed_draw_blocks,
+    .fill_halo = packed_fill_halo,
+    .block = &packed_block_ops
+};
+
+static const gol_engine_t sparse_engine = {
+    .name = ENGINE_SPARSE,
+    .allocate = sparse_allocate,
+    .deallocate = sparse_deallocate,
+    .step = sparse_step,
+    .get_cell = sparse_get_cell,
+    .set_cell = sparse_set_cell,
+    .count_alive = sparse_count_alive,
+    .clear = sparse_clear,
+    .counts_changes = true,
+    .draw = sparse_draw,
+    .draw_blocks = sparse_draw_blocks
+};
+
+static const gol_engine_t hashlife_engine = {
+    .name = ENGINE_HASHLIFE,
+    .allocate = hashlife_allocate,
+    .deallocate = hashlife_deallocate,
+    .step = hashlife_step,
+    .advance = hashlife_advance,
+    .get_cell = hashlife_get_cell,
+    .set_cell = hashlife_set_cell,
+    .count_alive = hashlife_count_alive,
+    .clear = hashlife_clear,
+    .draw = hashlife_draw,
+    .write_rows = hashlife_write_rows,
+    .draw_blocks = hashlife_draw_blocks
+};
+
+#if GOL_OPENCL
+static const gol_engine_t gpu_engine = {
+    .name = ENGINE_GPU,
+    .allocate = gpu_allocate,
+    .deallocate = gpu_deallocate,
+    .step = gpu_step,
+    .get_cell = gpu_get_cell,
+    .set_cell = gpu_set_cell,
+    .count_alive = gpu_count_alive,
+    .clear = gpu_clear,
+    .counts_changes = true,
+    .draw = gpu_draw,
+    .draw_blocks = gpu_draw_blocks,
+    .read_rows = gpu_read_rows,
+    .write_rows = gpu_write_rows,
+    .fill_halo = gpu_fill_halo
+};
+#endif
+
+static const gol_engine_t *const engines[] = {
+    &packed_engine,
+    &dense_engine,
+    &sparse_engine,
+    &hashlife_engine,
+#if GOL_OPENCL
+    &gpu_engine
+#endif
+};
 
 
 /**
- * @brief Parse configuration file
+ * @brief Map a configuration file for parsing
  * @param filename Configuration file path
- * @param config Pointer to configuration structure to fill
- * @return GOL_SUCCESS on success, error code otherwise
+ * @param text Filled with the mapping on success
+ * @return GOL_SUCCESS on success, GOL_ERROR_FILE on failure
  */
-static gol_result_t parse_config_file(const char *filename, gol_config_t *config) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
+static gol_result_t config_map(const char *filename, gol_config_text_t *text) {
+    memset(text, 0, sizeof(*text));
+    int fd = open(filename, O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
         fprintf(stderr, "Error: Cannot open configuration file '%s': %s\n", 
                 filename, strerror(errno));
+        if (fd >= 0) close(fd);
         return GOL_ERROR_FILE;
     }
+    
+    text->size = (size_t)st.st_size;
+    if (text->size > 0) {
+        void *map = mmap(NULL, text->size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            fprintf(stderr, "Error: Cannot map configuration file '%s': %s\n",
+                    filename, strerror(errno));
+            close(fd);
+            return GOL_ERROR_FILE;
+        }
+        
+        /* Headers and grid are read front to back, once */
+        madvise(map, text->size, MADV_SEQUENTIAL);
+        text->map = map;
+    }
+    close(fd);
+    text->grid = SIZE_MAX;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Release a configuration file mapping
+ * @param text Mapping made by config_map()
+ */
+static void config_unmap(gol_config_text_t *text) {
+    if (text->map) {
+        munmap(text->map, text->size);
+    }
+    memset(text, 0, sizeof(*text));
+}
+
+/**
+ * @brief Find the end of a line of a mapped file
+ * @param line Start of the line
+ * @param end End of the file
+ * @return The line's newline, or end if the last line has none
+ */
+static inline const char *line_end(const char *line, const char *end) {
+    const char *newline = memchr(line, '\n', (size_t)(end - line));
+    return newline ? newline : end;
+}
+
+/**
+ * @brief Fill a configuration with the defaults of every optional key
+ * @param config Configuration to reset
+ */
+static void config_set_defaults(gol_config_t *config) {
+    config->steps = 0;  /* 0 means infinite */
+    config->seed = 0;   /* 0 means use time as seed */
+    config->density = DEFAULT_DENSITY;
+    config->threads = DEFAULT_THREADS;
+    config->gens_per_frame = DEFAULT_GENS_PER_FRAME;
+    config->hashlife_step = DEFAULT_HASHLIFE_STEP;
+    config->hashlife_mem_mb = DEFAULT_HASHLIFE_MEM_MB;
+    config->temporal_block = DEFAULT_TEMPORAL_BLOCK;
+    config->cycle_period = 0;
+    config->checkpoint_every = 0;
+    config->frame_every = 1;
+    config->frame_scale = 1;
+    config->frame_buffers = DEFAULT_FRAME_BUFFERS;
+    config->sim_thread = 0;
+    config->frames_path[0] = '\0';
+    config->snapshot_path[0] = '\0';
+    config->checkpoint_path[0] = '\0';
+    config->export_path[0] = '\0';
+    config->trace_path[0] = '\0';
+    config->pattern_count = 0;
+    strcpy(config->render_mode, RENDER_SDL);
+    strcpy(config->engine_name, DEFAULT_ENGINE);
+    strcpy(config->kernel_name, KERNEL_AUTO);
+    strcpy(config->rule_name, DEFAULT_RULE);
+    rule_parse(config->rule_name, &config->rule);
+    strcpy(config->boundary_name, BOUNDARY_DEAD_NAME);
+    config->boundary = BOUNDARY_DEAD;
+}
 
+/**
+ * @brief Parse the configuration headers
+ * 
+ * Parsing stops at @grid, whose rows are left for parse_manual_config()
+ * once the grid is allocated, so the file is only ever read once.
+ * 
+ * @param text Mapped configuration file; its grid offset is set
+ * @param config Pointer to configuration structure to fill
+ * @return GOL_SUCCESS on success, error code otherwise
+ */
+static gol_result_t parse_config_file(gol_config_text_t *text, gol_config_t *config) {
+    const char *data = text->map, *end = data + text->size;
     char buffer[BUFFER_SIZE];
     bool rows_set = false, cols_set = false, config_set = false;
     
-    /* Initialize with default values */
-    config->steps = 0;  /* 0 means infinite */
-    config->seed = 0;   /* 0 means use time as seed */
+    config_set_defaults(config);
     
-    while (fgets(buffer, sizeof(buffer), file)) {
+    for (const char *line = data, *next; line < end; line = next < end ? next + 1 : end) {
+        next = line_end(line, end);
+        
         /* Skip empty lines and comments */
-        if (buffer[0] == '\n' || buffer[0] == '#') continue;
+        if (line == next || line[0] == '#') continue;
+        
+        /* The grid follows; its rows are parsed once the grid exists */
+        if (next - line >= 5 && memcmp(line, "@grid", 5) == 0) {
+            text->grid = next < end ? (size_t)(next + 1 - data) : text->size;
+            break;
+        }
+        
+        /* Headers are short, so overlong lines are cut rather than buffered */
+        size_t length = (size_t)(next - line);
+        if (length >= sizeof(buffer)) length = sizeof(buffer) - 1;
+        memcpy(buffer, line, length);
+        buffer[length] = '\0';
         
         if (sscanf(buffer, "@nrows %zu", &config->rows) == 1) {
             rows_set = true;
         } else if (sscanf(buffer, "@ncols %zu", &config->cols) == 1) {
             cols_set = true;
-        } else if (sscanf(buffer, "@steps %u", &config->steps) == 1) {
+        } else if (sscanf(buffer, "@steps %" SCNu64, &config->steps) == 1) {
             /* Optional parameter */
         } else if (sscanf(buffer, "@seed %u", &config->seed) == 1) {
             /* Optional parameter */
+        } else if (sscanf(buffer, "@density %lf", &config->density) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@threads %u", &config->threads) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@gens_per_frame %u", &config->gens_per_frame) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@hashlife_step %u", &config->hashlife_step) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@hashlife_mem %u", &config->hashlife_mem_mb) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@temporal_block %u", &config->temporal_block) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@detect_cycles %u", &config->cycle_period) == 1) {
+            /* Optional parameter */
         } else if (sscanf(buffer, "@config %199s", config->config_type) == 1) {
             config_set = true;
+        } else if (sscanf(buffer, "@render %199s", config->render_mode) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@engine %199s", config->engine_name) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@kernel %199s", config->kernel_name) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@rule %199s", config->rule_name) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@boundary %199s", config->boundary_name) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@snapshot %199s", config->snapshot_path) == 1) {
+            /* Required by @config snapshot */
+        } else if (sscanf(buffer, "@checkpoint_every %" SCNu64, &config->checkpoint_every) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@checkpoint %199s", config->checkpoint_path) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@export %199s", config->export_path) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@trace %199s", config->trace_path) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@frame_every %" SCNu64, &config->frame_every) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@frame_scale %u", &config->frame_scale) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@frame_buffers %u", &config->frame_buffers) == 1) {
+            /* Optional parameter */
+        } else if (sscanf(buffer, "@sim_thread %u", &config->sim_thread) == 1) {
+            /* Optional parameter */
+        } else if (strncmp(buffer, "@frames ", 8) == 0) {
+            /* The rest of the line, so that a |command keeps its arguments */
+            const char *target = buffer + 8;
+            while (*target == ' ' || *target == '\t') target++;
+            size_t target_length = strlen(target);
+            while (target_length > 0 && (target[target_length - 1] == ' ' ||
+                                         target[target_length - 1] == '\t' ||
+                                         target[target_length - 1] == '\r')) {
+                target_length--;
+            }
+            if (target_length >= sizeof(config->frames_path)) {
+                fprintf(stderr, "Error: @frames is longer than %d characters\n",
+                        MAX_CONFIG_LENGTH - 1);
+                return GOL_ERROR_CONFIG;
+            }
+            memcpy(config->frames_path, target, target_length);
+            config->frames_path[target_length] = '\0';
+        } else if (strncmp(buffer, "@pattern ", 9) == 0) {
+            if (config->pattern_count == MAX_PATTERNS) {
+                fprintf(stderr, "Error: At most %d @pattern lines are supported\n", MAX_PATTERNS);
+                return GOL_ERROR_CONFIG;
+            }
+            gol_pattern_t *pattern = &config->patterns[config->pattern_count];
+            pattern->x = 0;
+            pattern->y = 0;
+            if (sscanf(buffer, "@pattern %199s %" SCNd64 " %" SCNd64,
+                       pattern->path, &pattern->x, &pattern->y) >= 1) {
+                config->pattern_count++;
+            }
         }
     }
     
-    fclose(file);
-    
-    /* Validate required parameters */
-    if (!rows_set || !cols_set || !config_set) {
+    /* Validate required parameters; a snapshot brings its own dimensions */
+    bool from_snapshot = config_set && strcmp(config->config_type, CONFIG_SNAPSHOT) == 0;
+    if (!config_set || (!from_snapshot && (!rows_set || !cols_set))) {
         fprintf(stderr, "Error: Missing required configuration parameters\n");
         return GOL_ERROR_CONFIG;
     }
     
-    if (config->rows == 0 || config->cols == 0) {
-        fprintf(stderr, "Error: Grid dimensions must be positive\n");
+    if (from_snapshot && config->snapshot_path[0] == '\0') {
+        fprintf(stderr, "Error: @config snapshot requires @snapshot <file>\n");
         return GOL_ERROR_CONFIG;
     }
     
-    return GOL_SUCCESS;
-}
-
-/**
- * @brief Parse manual configuration from file
- * @param filename Configuration file path
- * @param ctx Game context
- * @return GOL_SUCCESS on success, error code otherwise
- */
-static gol_result_t parse_manual_config(const char *filename, gol_context_t *ctx) {
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        fprintf(stderr, "Error: Cannot open configuration file '%s': %s\n", 
-                filename, strerror(errno));
-        return GOL_ERROR_FILE;
+    if (config_set && strcmp(config->config_type, CONFIG_PATTERN) == 0 &&
+        config->pattern_count == 0) {
+        fprintf(stderr, "Error: @config pattern requires @pattern <file>\n");
+        return GOL_ERROR_CONFIG;
     }
-
-    char buffer[BUFFER_SIZE];
-    bool in_grid_section = false;
-    size_t current_row = 0;
     
-    while (fgets(buffer, sizeof(buffer), file)) {
-        /* Skip empty lines and comments */
-        if (buffer[0] == '\n' || buffer[0] == '#') continue;
-        
-        /* Check if we're entering the grid section */
-        if (strncmp(buffer, "@grid", 5) == 0) {
-            in_grid_section = true;
-            current_row = 0;
-            continue;
-        }
-        
-        /* Parse grid rows if we're in the grid section */
-        if (in_grid_section) {
-            /* Skip configuration lines */
-            if (buffer[0] == '@') continue;
-            
-            /* Parse grid row */
-            if (current_row < ctx->rows) {
-                size_t col = 0;
-                for (size_t i = 0; i < strlen(buffer) && col < ctx->cols; i++) {
-                    char c = buffer[i];
-                    if (c == '1' || c == '#' || c == '*' || c == 'X') {
-                        ctx->grid[current_row][col] = CELL_ALIVE;
-                        col++;
-                    } else if (c == '0' || c == '.' || c == ' ') {
-                        ctx->grid[current_row][col] = CELL_DEAD;
-                        col++;
-                    }
-                    /* Skip other characters like separators */
-                }
-                current_row++;
-            }
-        }
+    if (config->checkpoint_every > 0 && config->checkpoint_path[0] == '\0') {
+        fprintf(stderr, "Error: @checkpoint_every requires @checkpoint <file>\n");
+        return GOL_ERROR_CONFIG;
     }
     
-    fclose(file);
-    
-    if (in_grid_section && current_row < ctx->rows) {
-        fprintf(stderr, "Warning: Only %zu of %zu grid rows were specified\n", 
-                current_row, ctx->rows);
+    if (!from_snapshot && (config->rows == 0 || config->cols == 0)) {
+        fprintf(stderr, "Error: Grid dimensions must be positive\n");
+        return GOL_ERROR_CONFIG;
     }
     
-    return GOL_SUCCESS;
-}
-
-/**
- * @brief Allocate memory for the game grid
- * @param ctx Game context
- * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
- */
-static gol_result_t allocate_grid(gol_context_t *ctx) {
-    /* Allocate array of row pointers */
-    ctx->grid = calloc(ctx->rows, sizeof(cell_state_t*));
-    if (!ctx->grid) {
-        return GOL_ERROR_MEMORY;
+    if (!from_snapshot && (config->rows > MAX_GRID_SIDE || config->cols > MAX_GRID_SIDE)) {
+        fprintf(stderr, "Error: Grid dimensions must be at most %zu\n", MAX_GRID_SIDE);
+        return GOL_ERROR_CONFIG;
     }
     
-    /* Allocate memory for each row */
-    for (size_t i = 0; i < ctx->rows; i++) {
-        ctx->grid[i] = calloc(ctx->cols, sizeof(cell_state_t));
-        if (!ctx->grid[i]) {
-            /* Clean up previously allocated rows */
-            for (size_t j = 0; j < i; j++) {
-                free(ctx->grid[j]);
-            }
-            free(ctx->grid);
-            ctx->grid = NULL;
-            return GOL_ERROR_MEMORY;
-        }
+    if (strcmp(config->render_mode, RENDER_SDL) != 0 &&
+        strcmp(config->render_mode, RENDER_NONE) != 0) {
+        fprintf(stderr, "Error: Unknown render mode '%s'\n", config->render_mode);
+        return GOL_ERROR_CONFIG;
     }
     
-    return GOL_SUCCESS;
-}
-
-/**
- * @brief Deallocate grid memory
- * @param ctx Game context
- */
-static void deallocate_grid(gol_context_t *ctx) {
-    if (!ctx->grid) return;
+    if (!(config->density >= 0.0 && config->density <= 1.0)) {
+        fprintf(stderr, "Error: @density must be between 0 and 1\n");
+        return GOL_ERROR_CONFIG;
+    }
     
-    for (size_t i = 0; i < ctx->rows; i++) {
-        free(ctx->grid[i]);
+    if (config->gens_per_frame == 0 || config->gens_per_frame > MAX_GENS_PER_FRAME) {
+        fprintf(stderr, "Error: @gens_per_frame must be between 1 and %d\n",
+                MAX_GENS_PER_FRAME);
+        return GOL_ERROR_CONFIG;
     }
-    free(ctx->grid);
-    ctx->grid = NULL;
-}
-
-/**
- * @brief Initialize SDL components
- * @param ctx Game context
- * @return GOL_SUCCESS on success, GOL_ERROR_SDL on failure
- */
-static gol_result_t initialize_sdl(gol_context_t *ctx) {
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        fprintf(stderr, "Error: SDL initialization failed: %s\n", SDL_GetError());
-        return GOL_ERROR_SDL;
+    
+    if (config->hashlife_step > HASHLIFE_MAX_LEVEL - 3) {
+        fprintf(stderr, "Error: @hashlife_step must be at most %d\n", HASHLIFE_MAX_LEVEL - 3);
+        return GOL_ERROR_CONFIG;
     }
     
-    int window_width = (int)(ctx->cols * CELL_SIZE);
-    int window_height = (int)(ctx->rows * CELL_SIZE);
+    if (config->hashlife_mem_mb == 0) {
+        fprintf(stderr, "Error: @hashlife_mem must be positive\n");
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->temporal_block == 0 || config->temporal_block > MAX_TEMPORAL_BLOCK) {
+        fprintf(stderr, "Error: @temporal_block must be between 1 and %d\n", MAX_TEMPORAL_BLOCK);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    char frame_name[MAX_CONFIG_LENGTH + 32];
+    if (config->frames_path[0] != '\0' && config->frames_path[0] != '|' &&
+        !frames_file_name(config->frames_path, 0, frame_name, sizeof(frame_name))) {
+        fprintf(stderr, "Error: @frames takes at most one counter like %%06d, and no other %%\n");
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->frame_every == 0) {
+        fprintf(stderr, "Error: @frame_every must be positive\n");
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->frame_scale == 0 || config->frame_scale > MAX_FRAME_SCALE) {
+        fprintf(stderr, "Error: @frame_scale must be between 1 and %d\n", MAX_FRAME_SCALE);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->frame_buffers == 0 || config->frame_buffers > MAX_FRAME_BUFFERS) {
+        fprintf(stderr, "Error: @frame_buffers must be between 1 and %d\n", MAX_FRAME_BUFFERS);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->cycle_period > MAX_CYCLE_PERIOD) {
+        fprintf(stderr, "Error: @detect_cycles must be at most %d\n", MAX_CYCLE_PERIOD);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->threads > MAX_THREADS) {
+        fprintf(stderr, "Error: At most %d threads are supported\n", MAX_THREADS);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (!find_engine(config->engine_name)) {
+        if (strcmp(config->engine_name, ENGINE_GPU) == 0) {
+            fprintf(stderr, "Error: The gpu engine needs a build with -DGOL_OPENCL=1\n");
+            return GOL_ERROR_CONFIG;
+        }
+        fprintf(stderr, "Error: Unknown engine '%s'\n", config->engine_name);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (!find_kernel(config->kernel_name)) {
+        fprintf(stderr, "Error: Kernel '%s' is unknown or not supported on this CPU\n",
+                config->kernel_name);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (!rule_parse(config->rule_name, &config->rule)) {
+        fprintf(stderr, "Error: Unknown rule '%s', expected B<digits>/S<digits> like B36/S23\n",
+                config->rule_name);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    /* Under B0 empty space comes alive, which an unbounded universe cannot hold */
+    const gol_engine_t *engine = find_engine(config->engine_name);
+    if ((config->rule.birth & 1u) && (engine == &sparse_engine || engine == &hashlife_engine)) {
+        fprintf(stderr, "Error: Rule %s has B0, which the %s engine does not support\n",
+                config->rule.name, engine->name);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    /* The thread publishes whole boards, which needs an engine that copies out packed rows */
+    if (config->sim_thread > 1) {
+        fprintf(stderr, "Error: @sim_thread must be 0 or 1\n");
+        return GOL_ERROR_CONFIG;
+    }
+    if (config->sim_thread && !engine->read_rows) {
+        fprintf(stderr, "Error: @sim_thread needs the dense, packed or gpu engine\n");
+        return GOL_ERROR_CONFIG;
+    }
+    
+    config->boundary = BOUNDARY_COUNT;
+    for (int b = 0; b < BOUNDARY_COUNT; b++) {
+        if (strcmp(config->boundary_name, boundary_names[b]) == 0) {
+            config->boundary = (gol_boundary_t)b;
+        }
+    }
+    if (config->boundary == BOUNDARY_COUNT) {
+        fprintf(stderr, "Error: Unknown boundary '%s' (dead|torus|klein|mirror)\n",
+                config->boundary_name);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->boundary != BOUNDARY_DEAD && !engine->fill_halo) {
+        fprintf(stderr, "Error: The %s engine has an unbounded universe, so its boundary is dead\n",
+                engine->name);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    if (config->temporal_block > 1 && !engine->block) {
+        fprintf(stderr, "Error: @temporal_block needs the %s or %s engine\n",
+                ENGINE_DENSE, ENGINE_PACKED);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    /* An unbounded universe can hold a cycle the board does not show, and vice versa */
+    if (config->cycle_period > 0 && !engine->fill_halo) {
+        fprintf(stderr, "Error: @detect_cycles needs a bounded engine, not %s\n", engine->name);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    /* Blocked steps only see every k-th generation, which hides the true period */
+    if (config->cycle_period > 0 && config->temporal_block > 1) {
+        fprintf(stderr, "Error: @detect_cycles cannot be combined with @temporal_block\n");
+        return GOL_ERROR_CONFIG;
+    }
+    
+    return GOL_SUCCESS;
+}
+
+/* Classes of @grid characters */
+enum { GRID_CHAR_SKIP, GRID_CHAR_DEAD, GRID_CHAR_ALIVE };
+
+static const uint8_t grid_chars[256] = {
+    ['0'] = GRID_CHAR_DEAD, ['.'] = GRID_CHAR_DEAD, [' '] = GRID_CHAR_DEAD,
+    ['1'] = GRID_CHAR_ALIVE, ['#'] = GRID_CHAR_ALIVE, ['*'] = GRID_CHAR_ALIVE,
+    ['X'] = GRID_CHAR_ALIVE,
+};
+
+/**
+ * @brief Parse the @grid rows of a manual configuration
+ * 
+ * Rows are scanned in place in the mapping, so their length is not
+ * limited. Only live cells are written: the grid is freshly allocated and
+ * therefore already dead.
+ * 
+ * @param text Mapped configuration file, already parsed by parse_config_file()
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, error code otherwise
+ */
+static gol_result_t parse_manual_config(const gol_config_text_t *text, gol_context_t *ctx) {
+    const char *data = text->map, *end = data + text->size;
+    if (text->grid == SIZE_MAX) {
+        return GOL_SUCCESS;
+    }
+    
+    /* Board rows and columns past the local block, if the board is split between ranks */
+    size_t row_end = ctx->origin_row + ctx->rows;
+    size_t col_end = ctx->origin_col + ctx->cols;
+    
+    size_t current_row = 0;
+    for (const char *line = data + text->grid, *next; line < end && current_row < row_end;
+         line = next < end ? next + 1 : end) {
+        next = line_end(line, end);
+        
+        /* Skip empty lines, comments and configuration lines */
+        if (line == next || line[0] == '#') continue;
+        if (line[0] == '@') {
+            fprintf(stderr, "Warning: Ignoring '%.*s' after @grid\n",
+                    (int)(next - line < 40 ? next - line : 40), line);
+            continue;
+        }
+        
+        /* Rows above the local block are only counted */
+        if (current_row < ctx->origin_row) {
+            current_row++;
+            continue;
+        }
+        
+        /* Parse grid row; characters that are not cells, like separators, are skipped */
+        size_t col = 0;
+        for (const char *c = line; c < next && col < col_end; c++) {
+            uint8_t kind = grid_chars[(unsigned char)*c];
+            if (kind == GRID_CHAR_ALIVE && col >= ctx->origin_col) {
+                set_cell(ctx, current_row - ctx->origin_row, col - ctx->origin_col, true);
+            }
+            col += kind != GRID_CHAR_SKIP;
+        }
+        current_row++;
+    }
+    
+    if (current_row < row_end) {
+        fprintf(stderr, "Warning: Only %zu of %zu grid rows were specified\n", 
+                current_row, row_end);
+    }
+    
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Look up a simulation engine by name
+ * @param name Engine name as given by the @engine key
+ * @return Engine descriptor, or NULL if the name is unknown
+ */
+static const gol_engine_t *find_engine(const char *name) {
+    for (size_t i = 0; i < sizeof(engines) / sizeof(engines[0]); i++) {
+        if (strcmp(engines[i]->name, name) == 0) {
+            return engines[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Allocate memory for the game grid
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t allocate_grid(gol_context_t *ctx) {
+    return ctx->engine->allocate(ctx);
+}
+
+/**
+ * @brief Deallocate grid memory
+ * @param ctx Game context
+ */
+static void deallocate_grid(gol_context_t *ctx) {
+    ctx->engine->deallocate(ctx);
+    arena_destroy(&ctx->block_arena);
+}
+
+/**
+ * @brief Abort when an engine cannot grow its storage during a step
+ * 
+ * Engines whose storage follows the population allocate inside step(),
+ * which has no way to report failure, so running out of memory there
+ * ends the program.
+ * 
+ * @param engine Engine name, for the message
+ */
+static void engine_out_of_memory(const char *engine) {
+    fprintf(stderr, "Error: %s engine ran out of memory\n", engine);
+    exit(GOL_ERROR_MEMORY);
+}
+
+/**
+ * @brief Read the state of a cell through the active engine
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @return true if the cell is alive
+ */
+static inline bool get_cell(const gol_context_t *ctx, size_t row, size_t col) {
+    return ctx->engine->get_cell(ctx, row, col);
+}
+
+/**
+ * @brief Set the state of a cell through the active engine
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @param alive New cell state
+ */
+static inline void set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive) {
+    if (ctx->engine->get_cell(ctx, row, col) == alive) {
+        return;
+    }
+    
+    ctx->engine->set_cell(ctx, row, col, alive);
+    ctx->stats.population += alive ? 1 : (uint64_t)-1;
+}
+
+/**
+ * @brief Add the births and deaths of one band of a step to the statistics
+ * 
+ * Bands run concurrently, so each one adds its totals atomically, once.
+ * 
+ * @param ctx Game context
+ * @param births Cells born in the band
+ * @param deaths Cells that died in the band
+ */
+static inline void stats_add_changes(gol_context_t *ctx, uint64_t births, uint64_t deaths) {
+    __atomic_fetch_add(&ctx->stats.births, births, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&ctx->stats.deaths, deaths, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Initialize SDL components
+ * 
+ * The window shows the board at CELL_SIZE pixels per cell when that fits
+ * in VIEW_MAX_WIDTH by VIEW_MAX_HEIGHT pixels, and keeps that size at
+ * most otherwise, starting zoomed out far enough to show the whole board.
+ * The texture has one texel per window pixel whatever the board size.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_SDL on failure
+ */
+static gol_result_t initialize_sdl(gol_context_t *ctx) {
+    gol_view_t *view = &ctx->view;
+    view->width = ctx->cols <= VIEW_MAX_WIDTH / CELL_SIZE ? (int)ctx->cols * CELL_SIZE
+                                                          : VIEW_MAX_WIDTH;
+    view->height = ctx->rows <= VIEW_MAX_HEIGHT / CELL_SIZE ? (int)ctx->rows * CELL_SIZE
+                                                            : VIEW_MAX_HEIGHT;
+    view_reset(ctx);
+    return initialize_sdl_view(ctx, (size_t)view->height, (size_t)view->width, 1);
+}
+
+/**
+ * @brief Open the window, renderer and grid texture for an image of cells
+ * @param ctx Game context
+ * @param rows Texture rows
+ * @param cols Texture columns
+ * @param scale Window pixels per texel
+ * @return GOL_SUCCESS on success, GOL_ERROR_SDL on failure
+ */
+static gol_result_t initialize_sdl_view(gol_context_t *ctx, size_t rows, size_t cols,
+                                        int scale) {
+    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
+        fprintf(stderr, "Error: SDL initialization failed: %s\n", SDL_GetError());
+        return GOL_ERROR_SDL;
+    }
+    
+    int window_width = (int)cols * scale;
+    int window_height = (int)rows * scale;
     
     ctx->window = SDL_CreateWindow(
         "Conway's Game of Life",
@@ -285,277 +1685,9609 @@ static gol_result_t initialize_sdl(gol_context_t *ctx) {
         return GOL_ERROR_SDL;
     }
     
-    return GOL_SUCCESS;
+    /* One texel per cell, scaled up with nearest-neighbor filtering */
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+    ctx->texture = SDL_CreateTexture(ctx->renderer, SDL_PIXELFORMAT_ARGB8888,
+                                     SDL_TEXTUREACCESS_STREAMING, (int)cols, (int)rows);
+    if (!ctx->texture) {
+        fprintf(stderr, "Warning: Grid texture creation failed (%s), "
+                "falling back to per-cell drawing\n", SDL_GetError());
+    }
+    
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Clean up SDL resources
+ * @param ctx Game context
+ */
+static void cleanup_sdl(gol_context_t *ctx) {
+    free(ctx->view.scratch);
+    ctx->view.scratch = NULL;
+    ctx->view.scratch_size = 0;
+    if (ctx->texture) {
+        SDL_DestroyTexture(ctx->texture);
+        ctx->texture = NULL;
+    }
+    if (ctx->renderer) {
+        SDL_DestroyRenderer(ctx->renderer);
+        ctx->renderer = NULL;
+    }
+    if (ctx->window) {
+        SDL_DestroyWindow(ctx->window);
+        ctx->window = NULL;
+    }
+    SDL_Quit();
+}
+
+
+/**
+ * @brief Kill every cell through the active engine
+ * @param ctx Game context
+ */
+static void clear_grid(gol_context_t *ctx) {
+    ctx->engine->clear(ctx);
+    memset(&ctx->stats, 0, sizeof(ctx->stats));
+}
+
+/**
+ * @brief Replace the board with bit-packed rows
+ * 
+ * Engines that store packed rows copy them directly; the others get one
+ * set_cell() per live cell. Bits beyond the last column are ignored.
+ * 
+ * @param ctx Game context
+ * @param rows Input, ctx->rows rows of words_per_row words, bit b of word w being column 64w + b
+ * @param words_per_row Words between input rows, enough for ctx->cols bits
+ */
+static void write_board_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row) {
+    size_t words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    size_t remainder = ctx->cols % CELLS_PER_WORD;
+    uint64_t last_mask = remainder ? ((UINT64_C(1) << remainder) - 1) : ~UINT64_C(0);
+    
+    clear_grid(ctx);
+    if (ctx->engine->write_rows) {
+        ctx->engine->write_rows(ctx, rows, words_per_row);
+        
+        uint64_t population = 0;
+        for (size_t i = 0; i < ctx->rows; i++) {
+            const uint64_t *row = rows + i * words_per_row;
+            for (size_t w = 0; w + 1 < words; w++) {
+                population += (uint64_t)__builtin_popcountll(row[w]);
+            }
+            population += (uint64_t)__builtin_popcountll(row[words - 1] & last_mask);
+        }
+        ctx->stats.population = population;
+    } else {
+        for (size_t i = 0; i < ctx->rows; i++) {
+            const uint64_t *row = rows + i * words_per_row;
+            for (size_t w = 0; w < words; w++) {
+                uint64_t bits = w + 1 < words ? row[w] : row[w] & last_mask;
+                while (bits) {
+                    set_cell(ctx, i, w * CELLS_PER_WORD + (size_t)__builtin_ctzll(bits), true);
+                    bits &= bits - 1;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Copy the board out as bit-packed rows
+ * 
+ * Engines that store packed rows copy them directly; the others are read
+ * one get_cell() at a time. Bits beyond the last column are zero.
+ * 
+ * @param ctx Game context
+ * @param rows Output, ctx->rows rows of words_per_row words, laid out as in write_board_rows()
+ * @param words_per_row Words between output rows, equal to the board's words
+ */
+static void read_board_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row) {
+    if (ctx->engine->read_rows) {
+        ctx->engine->read_rows(ctx, rows, words_per_row);
+        return;
+    }
+    
+    memset(rows, 0, ctx->rows * words_per_row * sizeof(uint64_t));
+    for (size_t i = 0; i < ctx->rows; i++) {
+        for (size_t j = 0; j < ctx->cols; j++) {
+            if (get_cell(ctx, i, j)) {
+                rows[i * words_per_row + j / CELLS_PER_WORD] |= UINT64_C(1) << (j % CELLS_PER_WORD);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Scramble a 64-bit value (the SplitMix64 finalizer)
+ * @param z Input value
+ * @return Mixed value; the function is a bijection
+ */
+static inline uint64_t random_mix(uint64_t z) {
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief Draw 64 random bits, a pure function of key and counter
+ * @param key Stream key derived from the seed
+ * @param counter Draw index
+ * @return Random word
+ */
+static inline uint64_t random_word(uint64_t key, uint64_t counter) {
+    return random_mix(key + random_mix(counter));
+}
+
+/**
+ * @brief Hash one word of cells at its place on the board
+ * 
+ * The board hash is the sum of these over all words, so a step updates
+ * it by the difference of each word it rewrites, and dead words add 0.
+ * 
+ * @param index Word index, row * words + word
+ * @param word Cells of the word, bits past the last column clear
+ * @return Hash contribution
+ */
+static inline uint64_t board_word_hash(uint64_t index, uint64_t word) {
+    return word ? random_mix(random_mix(index) ^ word) : 0;
+}
+
+/**
+ * @brief Pool task: fill one band of random rows
+ * 
+ * Each word of cells is built from draws indexed by its position alone,
+ * so the board does not depend on how rows are split between threads.
+ * A cell is alive with probability threshold / 2^RANDOM_DENSITY_BITS:
+ * starting from all dead, bit b of the threshold, lowest first, ORs in
+ * (bit set) or ANDs in (bit clear) one draw, so each step maps the
+ * probability p to (bit + p) / 2.
+ * 
+ * @param arg Random fill job
+ * @param index Band index
+ * @param count Number of bands
+ */
+static void random_fill_task(void *arg, size_t index, size_t count) {
+    const gol_random_fill_t *fill = arg;
+    size_t row_begin = fill->row_count * index / count;
+    size_t row_end = fill->row_count * (index + 1) / count;
+    unsigned int first_bit = fill->threshold ? (unsigned int)__builtin_ctz(fill->threshold) : 0;
+    
+    for (size_t i = row_begin; i < row_end; i++) {
+        uint64_t *row = fill->rows + i * fill->words;
+        for (size_t w = 0; w < fill->words; w++) {
+            uint64_t counter = ((uint64_t)(fill->first_row + i) * fill->board_words +
+                                fill->first_word + w) << RANDOM_DENSITY_BITS;
+            uint64_t bits = 0;
+            if (fill->threshold >> RANDOM_DENSITY_BITS) {
+                bits = ~UINT64_C(0);
+            } else if (fill->threshold) {
+                for (unsigned int b = first_bit; b < RANDOM_DENSITY_BITS; b++) {
+                    uint64_t draw = random_word(fill->key, counter + b);
+                    bits = (fill->threshold >> b) & 1 ? bits | draw : bits & draw;
+                }
+            }
+            row[w] = bits;
+        }
+    }
+}
+
+/**
+ * @brief Initialize grid with random values
+ * 
+ * Cells are alive with probability @density. The board depends only on
+ * the seed and the board size, not on the platform, the thread count or
+ * how the board is split between ranks.
+ * The dense and packed engines keep the scratch rows in their arena, so
+ * resetting the board (R key) does not allocate.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY if the board was left unchanged
+ */
+static gol_result_t initialize_grid_random(gol_context_t *ctx) {
+    unsigned int seed = ctx->config.seed;
+    if (seed == 0) {
+        seed = (unsigned int)time(NULL);
+    }
+    
+    gol_random_fill_t fill;
+    fill.words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    fill.row_count = ctx->rows;
+    fill.first_row = ctx->origin_row;
+    fill.first_word = ctx->origin_col / CELLS_PER_WORD;
+    fill.board_words = ctx->dist ? (ctx->config.cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD
+                                 : fill.words;
+    fill.key = random_mix(seed);
+    fill.threshold = (uint32_t)(ctx->config.density * (1u << RANDOM_DENSITY_BITS) + 0.5);
+    fill.rows = ctx->board_rows ? ctx->board_rows
+                                : malloc(ctx->rows * fill.words * sizeof(uint64_t));
+    if (!fill.rows) {
+        fprintf(stderr, "Error: Out of memory while filling the grid\n");
+        return GOL_ERROR_MEMORY;
+    }
+    
+    if (ctx->pool) {
+        thread_pool_run(ctx->pool, random_fill_task, &fill);
+    } else {
+        random_fill_task(&fill, 0, 1);
+    }
+    write_board_rows(ctx, fill.rows, fill.words);
+    if (fill.rows != ctx->board_rows) {
+        free(fill.rows);
+    }
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Initialize a freshly allocated grid with manual configuration
+ * @param ctx Game context
+ * @param text Mapped configuration file
+ */
+static void initialize_grid_manual(gol_context_t *ctx, const gol_config_text_t *text) {
+    /* Allocation leaves every cell dead, so only live cells are set */
+    parse_manual_config(text, ctx);
+}
+
+/*
+ * Binary snapshots: a fixed header followed by the board as bit-packed
+ * rows, words_per_row 64-bit words each, bit b of word w being column
+ * 64w + b. Loading maps the file and copies rows straight out of the
+ * mapping; saving builds the whole file in memory and writes it once.
+ * Only the board is saved, so unbounded engines lose cells outside it.
+ */
+
+/**
+ * @brief Map a snapshot file and validate its header
+ * @param filename Snapshot path
+ * @param rule Rule the snapshot has to have been saved with
+ * @param snapshot Filled with the mapping on success
+ * @return GOL_SUCCESS on success, GOL_ERROR_FILE or GOL_ERROR_CONFIG on failure
+ */
+static gol_result_t snapshot_map(const char *filename, const gol_rule_t *rule,
+                                 gol_snapshot_t *snapshot) {
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot open snapshot '%s': %s\n", filename, strerror(errno));
+        return GOL_ERROR_FILE;
+    }
+    
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(gol_snapshot_header_t)) {
+        fprintf(stderr, "Error: '%s' is not a snapshot\n", filename);
+        close(fd);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Error: Cannot map snapshot '%s': %s\n", filename, strerror(errno));
+        return GOL_ERROR_FILE;
+    }
+    
+    const gol_snapshot_header_t *header = map;
+    size_t size = (size_t)st.st_size;
+    const char *problem = NULL;
+    gol_rule_t saved_rule;
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic)) != 0) {
+        problem = "is not a snapshot";
+    } else if (header->version != SNAPSHOT_VERSION || header->byte_order != SNAPSHOT_BYTE_ORDER) {
+        problem = "has an unsupported version or byte order";
+    } else if (header->rows == 0 || header->cols == 0 || header->words_per_row == 0 ||
+               header->cols > SIZE_MAX - CELLS_PER_WORD ||
+               header->words_per_row != (header->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD ||
+               header->rows > (size - sizeof(*header)) / sizeof(uint64_t) / header->words_per_row) {
+        problem = "has inconsistent dimensions";
+    } else if (memchr(header->rule, '\0', sizeof(header->rule)) == NULL ||
+               !rule_parse(header->rule, &saved_rule) ||
+               saved_rule.birth != rule->birth || saved_rule.survive != rule->survive) {
+        problem = "was saved with a different rule";
+    }
+    if (problem) {
+        fprintf(stderr, "Error: Snapshot '%s' %s\n", filename, problem);
+        munmap(map, size);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    /* Sequential copy into the grid follows */
+    madvise(map, size, MADV_SEQUENTIAL);
+    
+    snapshot->map = map;
+    snapshot->size = size;
+    snapshot->header = header;
+    snapshot->rows = (const uint64_t *)(header + 1);
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Release a snapshot mapping
+ * @param snapshot Snapshot mapped by snapshot_map()
+ */
+static void snapshot_unmap(gol_snapshot_t *snapshot) {
+    if (snapshot->map) {
+        munmap(snapshot->map, snapshot->size);
+    }
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+/**
+ * @brief Replace the board with the contents of a mapped snapshot
+ * 
+ * The board must have the snapshot's dimensions. A rank of a distributed
+ * run copies only its own block, so only those pages are read.
+ * 
+ * @param ctx Game context
+ * @param snapshot Mapped snapshot
+ */
+static void snapshot_apply(gol_context_t *ctx, const gol_snapshot_t *snapshot) {
+    size_t words = (size_t)snapshot->header->words_per_row;
+    write_board_rows(ctx, snapshot->rows + ctx->origin_row * words +
+                     ctx->origin_col / CELLS_PER_WORD, words);
+    ctx->generation = snapshot->header->generation;
+}
+
+/**
+ * @brief Save the board to a snapshot file
+ * 
+ * The file is written under a temporary name and renamed into place, so
+ * an interrupted save never destroys the previous checkpoint.
+ * 
+ * @param ctx Game context
+ * @param filename Snapshot path
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY or GOL_ERROR_FILE on failure
+ */
+static gol_result_t snapshot_save(const gol_context_t *ctx, const char *filename) {
+#if GOL_MPI
+    if (ctx->dist) {
+        return dist_snapshot_save(ctx, filename);
+    }
+#endif
+    size_t words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    size_t size = sizeof(gol_snapshot_header_t) + ctx->rows * words * sizeof(uint64_t);
+    gol_snapshot_header_t *header = calloc(1, size);
+    if (!header) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    memcpy(header->magic, SNAPSHOT_MAGIC, sizeof(header->magic));
+    header->version = SNAPSHOT_VERSION;
+    header->byte_order = SNAPSHOT_BYTE_ORDER;
+    header->rows = ctx->rows;
+    header->cols = ctx->cols;
+    header->generation = ctx->generation;
+    header->words_per_row = words;
+    snprintf(header->rule, sizeof(header->rule), "%s", ctx->config.rule.name);
+    snprintf(header->engine, sizeof(header->engine), "%s", ctx->engine->name);
+    
+    read_board_rows(ctx, (uint64_t *)(header + 1), words);
+    
+    char temp[MAX_CONFIG_LENGTH + 8];
+    snprintf(temp, sizeof(temp), "%s.tmp", filename);
+    int fd = open(temp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "Error: Cannot create snapshot '%s': %s\n", temp, strerror(errno));
+        free(header);
+        return GOL_ERROR_FILE;
+    }
+    
+    /* A single write unless the kernel returns early */
+    const char *data = (const char *)header;
+    size_t done = 0;
+    while (done < size) {
+        ssize_t written = write(fd, data + done, size - done);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) break;
+        done += (size_t)written;
+    }
+    
+    bool ok = done == size && close(fd) == 0 && rename(temp, filename) == 0;
+    if (!ok) {
+        fprintf(stderr, "Error: Cannot write snapshot '%s': %s\n", filename, strerror(errno));
+        if (done != size) close(fd);
+        unlink(temp);
+    }
+    free(header);
+    return ok ? GOL_SUCCESS : GOL_ERROR_FILE;
+}
+
+/**
+ * @brief Compute the bytes of one part of an arena layout
+ * 
+ * Parts are capped at an eighth of the address space, so adding a few
+ * of them up, aligned, cannot wrap either.
+ * 
+ * @param count Number of items, such as rows
+ * @param size Bytes per item
+ * @param extra Bytes added after the items
+ * @param bytes Receives count * size + extra
+ * @return false if the part would be above the cap
+ */
+static bool arena_size(size_t count, size_t size, size_t extra, size_t *bytes) {
+    size_t total;
+    if (__builtin_mul_overflow(count, size, &total) ||
+        __builtin_add_overflow(total, extra, &total) || total > SIZE_MAX / 8) {
+        return false;
+    }
+    *bytes = total;
+    return true;
+}
+
+/**
+ * @brief Map a zeroed arena
+ * 
+ * Arenas of a huge page or more are rounded up to whole huge pages and
+ * mapped on a huge page boundary, then offered to the kernel for
+ * transparent huge pages where it supports them: a 16k-row board then
+ * needs hundreds of TLB entries instead of hundreds of thousands.
+ * 
+ * @param arena Arena to create
+ * @param size Bytes needed
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t arena_create(gol_arena_t *arena, size_t size) {
+    size_t align = size >= ARENA_HUGE_PAGE ? ARENA_HUGE_PAGE : 0;
+    if (align) {
+        size = (size + align - 1) & ~(align - 1);
+    }
+    
+    /* Over-map by one huge page and trim both ends to the boundary */
+    uint8_t *map = mmap(NULL, size + align, PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) {
+        memset(arena, 0, sizeof(*arena));
+        return GOL_ERROR_MEMORY;
+    }
+    
+    uint8_t *base = map;
+    if (align) {
+        base = (uint8_t *)(((uintptr_t)map + align - 1) & ~(uintptr_t)(align - 1));
+        if (base > map) {
+            munmap(map, (size_t)(base - map));
+        }
+        if (base + size < map + size + align) {
+            munmap(base + size, (size_t)(map + size + align - (base + size)));
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(base, size, MADV_HUGEPAGE);
+#endif
+    }
+    
+    arena->base = base;
+    arena->size = size;
+    arena->used = 0;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Hand out a zeroed block of an arena
+ * @param arena Arena to allocate from
+ * @param size Bytes needed
+ * @return Block aligned to ARENA_ALIGNMENT, or NULL if the arena is full
+ */
+static void *arena_alloc(gol_arena_t *arena, size_t size) {
+    size = ARENA_ALIGN(size);
+    if (size > arena->size - arena->used) {
+        return NULL;
+    }
+    
+    void *block = arena->base + arena->used;
+    arena->used += size;
+    return block;
+}
+
+/**
+ * @brief Unmap an arena and every block handed out from it
+ * @param arena Arena to destroy, may have no mapping
+ */
+static void arena_destroy(gol_arena_t *arena) {
+    if (arena->base) {
+        munmap(arena->base, arena->size);
+    }
+    memset(arena, 0, sizeof(*arena));
+}
+
+/*
+ * Dense engine: one byte per cell, front and back generation buffers.
+ * Both carry a one-cell halo on every side: rows -1 and rows are halo
+ * rows and cells -1 and cols of each row are halo cells. The halo is kept
+ * dead (or filled with the board edges), so the step kernel reads all
+ * eight neighbors without bounds checks.
+ */
+
+/**
+ * @brief Locate a row of a dense buffer
+ * @param grid Dense grid
+ * @param buffer Front or back buffer
+ * @param row Row index, -1 and rows are the halo rows
+ * @return Pointer to cell 0 of the row
+ */
+static inline cell_t *dense_row(const gol_dense_grid_t *grid, cell_t *buffer, ptrdiff_t row) {
+    return buffer + row * (ptrdiff_t)grid->stride;
+}
+
+/**
+ * @brief Allocate memory for the dense grid
+ * 
+ * Both buffers and the scratch rows of random fills share one arena, so
+ * resetting the board never allocates.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t dense_allocate(gol_context_t *ctx) {
+    gol_dense_grid_t *grid = &ctx->dense;
+    if (ctx->rows > SIZE_MAX - 2 || ctx->cols > SIZE_MAX / 2) {
+        return GOL_ERROR_MEMORY;
+    }
+    grid->stride = ARENA_ALIGN(ctx->cols + 2);
+    
+    /* A leading line for the first left halo cell, then the halo and board rows */
+    size_t buffer_bytes, board_bytes;
+    size_t words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    if (!arena_size(ctx->rows + 2, grid->stride, ARENA_ALIGNMENT, &buffer_bytes) ||
+        !arena_size(ctx->rows, words * sizeof(uint64_t), 0, &board_bytes)) {
+        return GOL_ERROR_MEMORY;
+    }
+    board_bytes = ARENA_ALIGN(board_bytes);
+    if (arena_create(&ctx->arena, 2 * buffer_bytes + board_bytes) != GOL_SUCCESS) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    cell_t *front = arena_alloc(&ctx->arena, buffer_bytes);
+    cell_t *back = arena_alloc(&ctx->arena, buffer_bytes);
+    ctx->board_rows = arena_alloc(&ctx->arena, board_bytes);
+    grid->front = front + ARENA_ALIGNMENT + grid->stride;
+    grid->back = back + ARENA_ALIGNMENT + grid->stride;
+    
+    ctx->step_generations = ctx->config.temporal_block;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Deallocate dense grid memory
+ * @param ctx Game context
+ */
+static void dense_deallocate(gol_context_t *ctx) {
+    arena_destroy(&ctx->arena);
+    memset(&ctx->dense, 0, sizeof(ctx->dense));
+    ctx->board_rows = NULL;
+}
+
+/**
+ * @brief Read a cell of the dense grid
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @return true if the cell is alive
+ */
+static bool dense_get_cell(const gol_context_t *ctx, size_t row, size_t col) {
+    return dense_row(&ctx->dense, ctx->dense.front, (ptrdiff_t)row)[col] == CELL_ALIVE;
+}
+
+/**
+ * @brief Write a cell of the dense grid
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @param alive New cell state
+ */
+static void dense_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive) {
+    dense_row(&ctx->dense, ctx->dense.front, (ptrdiff_t)row)[col] = alive ? CELL_ALIVE : CELL_DEAD;
+}
+
+/**
+ * @brief Count living cells of the dense grid
+ * @param ctx Game context
+ * @return Number of living cells
+ */
+static uint64_t dense_count_alive(const gol_context_t *ctx) {
+    /* Kept up to date by set_cell() and the step, the board is the universe */
+    return ctx->stats.population;
+}
+
+/**
+ * @brief Kill every cell of the dense grid
+ * @param ctx Game context
+ */
+static void dense_clear(gol_context_t *ctx) {
+    for (size_t i = 0; i < ctx->rows; i++) {
+        memset(dense_row(&ctx->dense, ctx->dense.front, (ptrdiff_t)i), CELL_DEAD,
+               ctx->cols * sizeof(cell_t));
+    }
+}
+
+/**
+ * @brief Write a region of the dense grid as pixels
+ * @param ctx Game context
+ * @param region Cells to draw
+ * @param pixels Destination for the region's top-left cell, one ARGB8888 pixel per cell
+ * @param pitch Distance between destination rows, in pixels
+ */
+static void dense_draw(const gol_context_t *ctx, const gol_region_t *region,
+                       uint32_t *pixels, size_t pitch) {
+    static const uint32_t colors[2] = { DEAD_COLOR, ALIVE_COLOR };
+    
+    for (size_t i = 0; i < region->rows; i++) {
+        const cell_t *row = dense_row(&ctx->dense, ctx->dense.front,
+                                      (ptrdiff_t)(region->row + i)) + region->col;
+        uint32_t *out = pixels + i * pitch;
+        for (size_t j = 0; j < region->cols; j++) {
+            out[j] = colors[row[j]];
+        }
+    }
+}
+
+/**
+ * @brief Check a span of dense cells for a live one, eight cells per load
+ * @param cells First cell
+ * @param count Cells in the span
+ * @return true if any cell is alive
+ */
+static bool dense_span_alive(const cell_t *cells, size_t count) {
+    size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        uint64_t words[4];
+        memcpy(words, cells + i, sizeof(words));
+        if (words[0] | words[1] | words[2] | words[3]) {
+            return true;
+        }
+    }
+    for (; i < count; i++) {
+        if (cells[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Draw blocks of cells, one pixel per block, alive if any of its cells is
+ * 
+ * Each block is scanned until its first live cell, so only empty blocks
+ * are read completely.
+ * 
+ * @param ctx Game context
+ * @param blocks Region of blocks to draw
+ * @param level log2 of cells per block side
+ * @param pixels Destination for the region's top-left block
+ * @param pitch Distance between destination rows, in pixels
+ * @return true
+ */
+static bool dense_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                              unsigned int level, uint32_t *pixels, size_t pitch) {
+    size_t block = (size_t)1 << level;
+    
+    for (size_t i = 0; i < blocks->rows; i++) {
+        size_t row_begin = (blocks->row + i) << level;
+        size_t row_end = row_begin + block < ctx->rows ? row_begin + block : ctx->rows;
+        
+        for (size_t j = 0; j < blocks->cols; j++) {
+            size_t col = (blocks->col + j) << level;
+            size_t cols = col + block < ctx->cols ? block : ctx->cols - col;
+            bool alive = false;
+            for (size_t r = row_begin; r < row_end && !alive; r++) {
+                alive = dense_span_alive(dense_row(&ctx->dense, ctx->dense.front, (ptrdiff_t)r) +
+                                         col, cols);
+            }
+            pixels[i * pitch + j] = alive ? ALIVE_COLOR : DEAD_COLOR;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copy the dense grid out as bit-packed rows
+ * @param ctx Game context
+ * @param rows Output, rows * words_per_row words
+ * @param words_per_row Words per output row, equal to the board's words
+ */
+static void dense_read_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row) {
+    for (size_t i = 0; i < ctx->rows; i++) {
+        const cell_t *row = dense_row(&ctx->dense, ctx->dense.front, (ptrdiff_t)i);
+        uint64_t *out = rows + i * words_per_row;
+        for (size_t w = 0; w < words_per_row; w++) {
+            size_t end = (w + 1) * CELLS_PER_WORD < ctx->cols ? (w + 1) * CELLS_PER_WORD
+                                                              : ctx->cols;
+            uint64_t word = 0;
+            for (size_t j = w * CELLS_PER_WORD; j < end; j++) {
+                word |= (uint64_t)row[j] << (j % CELLS_PER_WORD);
+            }
+            out[w] = word;
+        }
+    }
+}
+
+/**
+ * @brief Compute the next state of one dense row
+ * 
+ * Branch-free over the whole row: the halo supplies the neighbors of the
+ * first and last cell, so the loop has no bounds checks and vectorizes.
+ * 
+ * @param above Row above (index -1 and cols are read)
+ * @param middle Current row (index -1 and cols are read)
+ * @param below Row below (index -1 and cols are read)
+ * @param out Output row
+ * @param cols Number of cells in the row
+ */
+static void dense_step_row(const cell_t *restrict above, const cell_t *restrict middle,
+                           const cell_t *restrict below, cell_t *restrict out, size_t cols) {
+    for (ptrdiff_t j = 0; j < (ptrdiff_t)cols; j++) {
+        unsigned int neighbors = above[j - 1] + above[j] + above[j + 1] +
+                                 middle[j - 1] + middle[j + 1] +
+                                 below[j - 1] + below[j] + below[j + 1];
+        
+        unsigned int born = (neighbors == NEIGHBORS_TO_BIRTH);
+        unsigned int survives = middle[j] &
+                                (neighbors >= MIN_NEIGHBORS_TO_SURVIVE) &
+                                (neighbors <= MAX_NEIGHBORS_TO_SURVIVE);
+        out[j] = (cell_t)(born | survives);
+    }
+}
+
+/**
+ * @brief Compute the next state of one dense row under any rule
+ * @param above Row above (index -1 and cols are read)
+ * @param middle Current row (index -1 and cols are read)
+ * @param below Row below (index -1 and cols are read)
+ * @param out Output row
+ * @param cols Number of cells in the row
+ * @param rule Rule whose lookup table gives the next states
+ */
+static void dense_step_row_rule(const cell_t *restrict above, const cell_t *restrict middle,
+                                const cell_t *restrict below, cell_t *restrict out,
+                                size_t cols, const gol_rule_t *rule) {
+    for (ptrdiff_t j = 0; j < (ptrdiff_t)cols; j++) {
+        unsigned int neighbors = above[j - 1] + above[j] + above[j + 1] +
+                                 middle[j - 1] + middle[j + 1] +
+                                 below[j - 1] + below[j] + below[j + 1];
+        out[j] = rule->next[middle[j]][neighbors];
+    }
+}
+
+/**
+ * @brief Count the cells born and died between two dense rows
+ * 
+ * Cells are 0 or 1, so eight of them are handled per 64-bit word: the
+ * bytes of the masked words are summed in place and folded before any
+ * byte can overflow.
+ * 
+ * @param before Row of the previous generation
+ * @param after Row of the generation just computed
+ * @param cols Number of cells
+ * @param births Incremented by the cells born
+ * @param deaths Incremented by the cells that died
+ */
+static void dense_count_changes(const cell_t *restrict before, const cell_t *restrict after,
+                                size_t cols, uint64_t *births, uint64_t *deaths) {
+    const uint64_t low_bytes = UINT64_C(0x00FF00FF00FF00FF);
+    size_t j = 0;
+    
+    while (j + 8 <= cols) {
+        uint64_t born = 0, died = 0;
+        
+        /* At most 255 words per round, so no byte of the sums overflows */
+        for (size_t n = 0; n < 255 && j + 8 <= cols; n++, j += 8) {
+            uint64_t b, a;
+            memcpy(&b, before + j, sizeof(b));
+            memcpy(&a, after + j, sizeof(a));
+            born += a & ~b;
+            died += b & ~a;
+        }
+        
+        born = (born & low_bytes) + ((born >> 8) & low_bytes);
+        died = (died & low_bytes) + ((died >> 8) & low_bytes);
+        *births += (born * UINT64_C(0x0001000100010001)) >> 48;
+        *deaths += (died * UINT64_C(0x0001000100010001)) >> 48;
+    }
+    
+    for (; j < cols; j++) {
+        *births += after[j] & ~before[j] & 1u;
+        *deaths += before[j] & ~after[j] & 1u;
+    }
+}
+
+/**
+ * @brief Compute the next generation for a band of dense rows
+ * @param ctx Game context
+ * @param row_begin First row of the band
+ * @param row_end One past the last row of the band
+ */
+static void dense_step_rows(gol_context_t *ctx, size_t row_begin, size_t row_end) {
+    const gol_dense_grid_t *grid = &ctx->dense;
+    const gol_rule_t *rule = &ctx->config.rule;
+    ptrdiff_t stride = (ptrdiff_t)grid->stride;
+    uint64_t births = 0, deaths = 0;
+    
+    /* Read the current generation, write the next one in the same sweep */
+    for (ptrdiff_t i = (ptrdiff_t)row_begin; i < (ptrdiff_t)row_end; i++) {
+        const cell_t *middle = dense_row(grid, grid->front, i);
+        cell_t *out = dense_row(grid, grid->back, i);
+        if (rule->conway) {
+            ctx->kernel->dense_row(middle - stride, middle, middle + stride, out, ctx->cols);
+        } else {
+            ctx->kernel->dense_rule_row(middle - stride, middle, middle + stride, out,
+                                        ctx->cols, rule);
+        }
+        
+        ctx->kernel->dense_changes(middle, out, ctx->cols, &births, &deaths);
+    }
+    
+    stats_add_changes(ctx, births, deaths);
+}
+
+/**
+ * @brief Swap buffers: the next generation becomes the current one
+ * @param ctx Game context
+ */
+static void dense_swap_buffers(gol_context_t *ctx) {
+    cell_t *swap = ctx->dense.front;
+    ctx->dense.front = ctx->dense.back;
+    ctx->dense.back = swap;
+}
+
+/**
+ * @brief Simulate one generation of the dense grid following Conway's rules
+ * @param ctx Game context
+ */
+static void dense_step(gol_context_t *ctx) {
+    dense_step_rows(ctx, 0, ctx->rows);
+    dense_swap_buffers(ctx);
+}
+
+/**
+ * @brief Fill a dense halo row with a row reversed left to right
+ * @param out Halo row; index -1 and cols are written too
+ * @param row Source row, with its halo cells already filled
+ * @param cols Number of cells in a row
+ */
+static void dense_reverse_row(cell_t *restrict out, const cell_t *restrict row, size_t cols) {
+    for (ptrdiff_t j = -1; j <= (ptrdiff_t)cols; j++) {
+        out[j] = row[(ptrdiff_t)cols - 1 - j];
+    }
+}
+
+/**
+ * @brief Copy the board edges into the halo of the current generation
+ * 
+ * The halo cells of each row are filled first, so copying whole rows into
+ * the halo rows takes the corners along.
+ * 
+ * @param ctx Game context
+ */
+static void dense_fill_halo(gol_context_t *ctx) {
+    const gol_dense_grid_t *grid = &ctx->dense;
+    ptrdiff_t rows = (ptrdiff_t)ctx->rows, cols = (ptrdiff_t)ctx->cols;
+    bool mirror = ctx->config.boundary == BOUNDARY_MIRROR;
+    
+    for (ptrdiff_t i = 0; i < rows; i++) {
+        cell_t *row = dense_row(grid, grid->front, i);
+        row[-1] = row[mirror ? 0 : cols - 1];
+        row[cols] = row[mirror ? cols - 1 : 0];
+    }
+    
+    cell_t *top = dense_row(grid, grid->front, -1);
+    cell_t *first = dense_row(grid, grid->front, 0);
+    cell_t *last = dense_row(grid, grid->front, rows - 1);
+    cell_t *bottom = dense_row(grid, grid->front, rows);
+    size_t bytes = (ctx->cols + 2) * sizeof(cell_t);
+    switch (ctx->config.boundary) {
+    case BOUNDARY_TORUS:
+        memcpy(top - 1, last - 1, bytes);
+        memcpy(bottom - 1, first - 1, bytes);
+        break;
+    case BOUNDARY_KLEIN:
+        dense_reverse_row(top, last, ctx->cols);
+        dense_reverse_row(bottom, first, ctx->cols);
+        break;
+    case BOUNDARY_MIRROR:
+        memcpy(top - 1, first - 1, bytes);
+        memcpy(bottom - 1, last - 1, bytes);
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * @brief Bytes between dense scratch rows
+ * @param ctx Game context
+ * @return Row stride of the dense grid
+ */
+static size_t dense_block_row_bytes(const gol_context_t *ctx) {
+    return ctx->dense.stride;
+}
+
+/**
+ * @brief Copy a dense board row into a scratch row
+ * @param ctx Game context
+ * @param out Scratch row
+ * @param row Board row, SIZE_MAX for a dead row including its halo
+ * @param flip Reverse the row left to right
+ */
+static void dense_block_load_row(const gol_context_t *ctx, void *out, size_t row, bool flip) {
+    cell_t *cells = out;
+    if (row == SIZE_MAX) {
+        memset(cells - 1, CELL_DEAD, (ctx->cols + 2) * sizeof(cell_t));
+        return;
+    }
+    
+    const cell_t *source = dense_row(&ctx->dense, ctx->dense.front, (ptrdiff_t)row);
+    if (flip) {
+        dense_reverse_row(cells, source, ctx->cols);
+    } else {
+        memcpy(cells, source, ctx->cols * sizeof(cell_t));
+    }
+}
+
+/**
+ * @brief Set the halo cells of a dense scratch row
+ * @param ctx Game context
+ * @param row Scratch row
+ */
+static void dense_block_fill_row_halo(const gol_context_t *ctx, void *row) {
+    cell_t *cells = row;
+    ptrdiff_t cols = (ptrdiff_t)ctx->cols;
+    
+    switch (ctx->config.boundary) {
+    case BOUNDARY_DEAD:
+        cells[-1] = CELL_DEAD;
+        cells[cols] = CELL_DEAD;
+        break;
+    case BOUNDARY_MIRROR:
+        cells[-1] = cells[0];
+        cells[cols] = cells[cols - 1];
+        break;
+    default:
+        cells[-1] = cells[cols - 1];
+        cells[cols] = cells[0];
+        break;
+    }
+}
+
+/**
+ * @brief Compute the next state of one dense row for temporal blocking
+ * @param ctx Game context
+ * @param above Row above
+ * @param middle Current row
+ * @param below Row below
+ * @param out Output row
+ * @param row Board row being computed, unused
+ * @param births Incremented by the cells born, or NULL
+ * @param deaths Incremented by the cells that died, or NULL
+ */
+static void dense_block_step_row(gol_context_t *ctx, const void *above, const void *middle,
+                                 const void *below, void *out, size_t row, uint64_t *births,
+                                 uint64_t *deaths) {
+    const gol_rule_t *rule = &ctx->config.rule;
+    (void)row;
+    
+    if (rule->conway) {
+        ctx->kernel->dense_row(above, middle, below, out, ctx->cols);
+    } else {
+        ctx->kernel->dense_rule_row(above, middle, below, out, ctx->cols, rule);
+    }
+    if (births) {
+        ctx->kernel->dense_changes(middle, out, ctx->cols, births, deaths);
+    }
+}
+
+/**
+ * @brief Locate a row of the dense next generation
+ * @param ctx Game context
+ * @param row Board row
+ * @return Pointer to cell 0 of the row in the back buffer
+ */
+static void *dense_block_back_row(gol_context_t *ctx, size_t row) {
+    return dense_row(&ctx->dense, ctx->dense.back, (ptrdiff_t)row);
+}
+
+/* Packed engine: one bit per cell, 64 cells per word, double buffered */
+
+/**
+ * @brief Get a pointer to the first cell word of a packed row
+ * @param grid Packed grid
+ * @param buffer Buffer base (front or back)
+ * @param row Row index, -1 and rows address the halo rows
+ * @return Pointer to word 0 of the row
+ */
+static inline uint64_t *packed_row(const gol_packed_grid_t *grid, uint64_t *buffer,
+                                   ptrdiff_t row) {
+    return buffer + row * (ptrdiff_t)grid->stride;
+}
+
+/**
+ * @brief Allocate memory for the packed grid
+ * 
+ * Both buffers, the tile flags and the scratch rows of random fills share
+ * one arena, so resetting the board never allocates.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t packed_allocate(gol_context_t *ctx) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    if (ctx->rows > SIZE_MAX - TILE_ROWS || ctx->cols > SIZE_MAX / 2) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    grid->words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    grid->stride = ARENA_ALIGN((grid->words + 2) * sizeof(uint64_t)) / sizeof(uint64_t);
+    
+    size_t remainder = ctx->cols % CELLS_PER_WORD;
+    grid->last_mask = remainder ? ((UINT64_C(1) << remainder) - 1) : ~UINT64_C(0);
+    
+    /* Both buffers: a leading line for the first left halo word, then the halo and board rows */
+    size_t line_words = ARENA_ALIGNMENT / sizeof(uint64_t);
+    size_t buffer_bytes, tile_bytes, board_bytes;
+    if (!arena_size(ctx->rows + 2, grid->stride * sizeof(uint64_t), ARENA_ALIGNMENT,
+                    &buffer_bytes)) {
+        return GOL_ERROR_MEMORY;
+    }
+    size_t buffer_words = buffer_bytes / sizeof(uint64_t);
+    
+    /* Four tile flag arrays, each with a halo ring of clear flags */
+    grid->tiles_x = grid->words;
+    grid->tiles_y = (ctx->rows + TILE_ROWS - 1) / TILE_ROWS;
+    grid->tile_stride = grid->tiles_x + 2;
+    if (!arena_size(grid->tiles_y + 2, 4 * grid->tile_stride * sizeof(uint8_t), 0, &tile_bytes) ||
+        !arena_size(ctx->rows, grid->words * sizeof(uint64_t), 0, &board_bytes)) {
+        return GOL_ERROR_MEMORY;
+    }
+    size_t tile_flags = tile_bytes / 4;
+    
+    size_t storage_bytes = ARENA_ALIGN(2 * buffer_bytes);
+    tile_bytes = ARENA_ALIGN(tile_bytes);
+    board_bytes = ARENA_ALIGN(board_bytes);
+    if (arena_create(&ctx->arena, storage_bytes + tile_bytes + board_bytes) != GOL_SUCCESS) {
+        return GOL_ERROR_MEMORY;
+    }
+    grid->storage = arena_alloc(&ctx->arena, storage_bytes);
+    grid->tile_storage = arena_alloc(&ctx->arena, tile_bytes);
+    ctx->board_rows = arena_alloc(&ctx->arena, board_bytes);
+    
+    /* Skip the leading line and the top halo row */
+    grid->front = grid->storage + line_words + grid->stride;
+    grid->back = grid->storage + buffer_words + line_words + grid->stride;
+    
+    grid->changed = grid->tile_storage + grid->tile_stride + 1;
+    grid->next_changed = grid->changed + tile_flags;
+    grid->redraw = grid->next_changed + tile_flags;
+    grid->lod_dirty = grid->redraw + tile_flags;
+    
+    /* Everything is computed and drawn at least once */
+    for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+        memset(grid->changed + ty * grid->tile_stride, 1, grid->tiles_x);
+        memset(grid->redraw + ty * grid->tile_stride, 1, grid->tiles_x);
+        memset(grid->lod_dirty + ty * grid->tile_stride, 1, grid->tiles_x);
+    }
+    
+    ctx->step_generations = ctx->config.temporal_block;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Deallocate packed grid memory
+ * @param ctx Game context
+ */
+static void packed_deallocate(gol_context_t *ctx) {
+    free(ctx->packed.lod[1]);
+    arena_destroy(&ctx->arena);
+    memset(&ctx->packed, 0, sizeof(ctx->packed));
+    ctx->board_rows = NULL;
+}
+
+/**
+ * @brief Get the flag of a tile
+ * @param grid Packed grid
+ * @param flags Flag array (changed, next_changed or redraw)
+ * @param ty Tile row, -1 and tiles_y address the halo
+ * @param tx Tile column, -1 and tiles_x address the halo
+ * @return Pointer to the tile's flag
+ */
+static inline uint8_t *packed_tile(const gol_packed_grid_t *grid, uint8_t *flags,
+                                   ptrdiff_t ty, ptrdiff_t tx) {
+    return flags + ty * (ptrdiff_t)grid->tile_stride + tx;
+}
+
+/**
+ * @brief Check whether any tile in the 3x3 neighborhood of a tile changed
+ * @param grid Packed grid
+ * @param ty Tile row
+ * @param tx Tile column
+ * @return true if the tile has to be recomputed
+ */
+static inline bool packed_tile_active(const gol_packed_grid_t *grid, ptrdiff_t ty, ptrdiff_t tx) {
+    const uint8_t *above = packed_tile(grid, grid->changed, ty - 1, tx);
+    const uint8_t *middle = packed_tile(grid, grid->changed, ty, tx);
+    const uint8_t *below = packed_tile(grid, grid->changed, ty + 1, tx);
+    
+    return (above[-1] | above[0] | above[1] | middle[-1] | middle[0] | middle[1] |
+            below[-1] | below[0] | below[1]) != 0;
+}
+
+/**
+ * @brief Read a cell of the packed grid
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @return true if the cell is alive
+ */
+static bool packed_get_cell(const gol_context_t *ctx, size_t row, size_t col) {
+    const gol_packed_grid_t *grid = &ctx->packed;
+    uint64_t word = packed_row(grid, grid->front, (ptrdiff_t)row)[col / CELLS_PER_WORD];
+    return (word >> (col % CELLS_PER_WORD)) & 1;
+}
+
+/**
+ * @brief Write a cell of the packed grid
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @param alive New cell state
+ */
+static void packed_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    uint64_t *word = &packed_row(grid, grid->front, (ptrdiff_t)row)[col / CELLS_PER_WORD];
+    uint64_t bit = UINT64_C(1) << (col % CELLS_PER_WORD);
+    
+    if (alive) {
+        *word |= bit;
+    } else {
+        *word &= ~bit;
+    }
+    
+    /* The edit invalidates the tile for both stepping and drawing */
+    ptrdiff_t ty = (ptrdiff_t)(row / TILE_ROWS);
+    ptrdiff_t tx = (ptrdiff_t)(col / CELLS_PER_WORD);
+    *packed_tile(grid, grid->changed, ty, tx) = 1;
+    *packed_tile(grid, grid->redraw, ty, tx) = 1;
+    *packed_tile(grid, grid->lod_dirty, ty, tx) = 1;
+}
+
+/**
+ * @brief Count living cells of the packed grid
+ * @param ctx Game context
+ * @return Number of living cells
+ */
+static uint64_t packed_count_alive(const gol_context_t *ctx) {
+    /* Kept up to date by set_cell() and the step, the board is the universe */
+    return ctx->stats.population;
+}
+
+/**
+ * @brief Kill every cell of the packed grid
+ * @param ctx Game context
+ */
+static void packed_clear(gol_context_t *ctx) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    
+    for (size_t i = 0; i < ctx->rows; i++) {
+        memset(packed_row(grid, grid->front, (ptrdiff_t)i), 0, grid->words * sizeof(uint64_t));
+    }
+    
+    /* Every tile may differ from its back buffer now */
+    for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+        memset(packed_tile(grid, grid->changed, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+        memset(packed_tile(grid, grid->redraw, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+        memset(packed_tile(grid, grid->lod_dirty, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+    }
+}
+
+/**
+ * @brief Copy the packed grid out as rows without halo words
+ * @param ctx Game context
+ * @param rows Output, rows * words_per_row words
+ * @param words_per_row Words per output row, equal to the grid's words
+ */
+static void packed_read_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row) {
+    const gol_packed_grid_t *grid = &ctx->packed;
+    
+    for (size_t i = 0; i < ctx->rows; i++) {
+        memcpy(rows + i * words_per_row, packed_row(grid, grid->front, (ptrdiff_t)i),
+               grid->words * sizeof(uint64_t));
+    }
+}
+
+/**
+ * @brief Overwrite the packed grid with rows without halo words
+ * @param ctx Game context
+ * @param rows Input, rows * words_per_row words
+ * @param words_per_row Words between input rows, at least the grid's words
+ */
+static void packed_write_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    
+    for (size_t i = 0; i < ctx->rows; i++) {
+        uint64_t *row = packed_row(grid, grid->front, (ptrdiff_t)i);
+        memcpy(row, rows + i * words_per_row, grid->words * sizeof(uint64_t));
+        row[grid->words - 1] &= grid->last_mask;
+    }
+    
+    /* Every tile may differ from its back buffer now */
+    for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+        memset(packed_tile(grid, grid->changed, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+        memset(packed_tile(grid, grid->redraw, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+        memset(packed_tile(grid, grid->lod_dirty, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+    }
+}
+
+/**
+ * @brief Get the byte-to-pixels lookup table used by packed_draw()
+ * 
+ * Entry b holds the eight pixels for the eight cells stored in byte b,
+ * lowest bit first. The table is built on first use.
+ * 
+ * @return Pointer to 256 rows of eight pixels
+ */
+static const uint32_t (*packed_pixel_lut(void))[8] {
+    static uint32_t lut[256][8];
+    static bool built = false;
+    
+    if (!built) {
+        for (int b = 0; b < 256; b++) {
+            for (int bit = 0; bit < 8; bit++) {
+                lut[b][bit] = ((b >> bit) & 1) ? ALIVE_COLOR : DEAD_COLOR;
+            }
+        }
+        built = true;
+    }
+    return (const uint32_t (*)[8])lut;
+}
+
+/**
+ * @brief Write a span of a bit-packed row as pixels, eight cells per table lookup
+ * @param row Packed row, bit b of word w is column 64w + b
+ * @param col First column to draw
+ * @param cols Columns to draw
+ * @param out Destination for column col, one ARGB8888 pixel per cell
+ */
+static void packed_draw_row(const uint64_t *row, size_t col, size_t cols, uint32_t *out) {
+    const uint32_t (*lut)[8] = packed_pixel_lut();
+    
+    /* Leading cells up to a byte boundary, then whole bytes, then the tail */
+    size_t first = col;
+    size_t col_end = col + cols;
+    size_t head_end = (col + 7) / 8 * 8;
+    if (head_end > col_end) head_end = col_end;
+    size_t full_end = col_end / 8 * 8;
+    if (full_end < head_end) full_end = head_end;
+    
+    for (; col < head_end; col++) {
+        out[col - first] = ((row[col / CELLS_PER_WORD] >> (col % CELLS_PER_WORD)) & 1)
+                           ? ALIVE_COLOR : DEAD_COLOR;
+    }
+    
+    /* Bit b of a word is column 64w + b, so byte k holds columns 8k..8k+7 */
+    for (; col < full_end; col += 8) {
+        uint8_t byte = (uint8_t)(row[col / CELLS_PER_WORD] >> (col % CELLS_PER_WORD));
+        memcpy(out + (col - first), lut[byte], sizeof(lut[byte]));
+    }
+    
+    if (col < col_end) {
+        uint8_t byte = (uint8_t)(row[col / CELLS_PER_WORD] >> (col % CELLS_PER_WORD));
+        memcpy(out + (col - first), lut[byte], (col_end - col) * sizeof(uint32_t));
+    }
+}
+
+/**
+ * @brief Write a region of the packed grid as pixels, eight cells per table lookup
+ * @param ctx Game context
+ * @param region Cells to draw
+ * @param pixels Destination for the region's top-left cell, one ARGB8888 pixel per cell
+ * @param pitch Distance between destination rows, in pixels
+ */
+static void packed_draw(const gol_context_t *ctx, const gol_region_t *region,
+                        uint32_t *pixels, size_t pitch) {
+    const gol_packed_grid_t *grid = &ctx->packed;
+    
+    for (size_t i = 0; i < region->rows; i++) {
+        packed_draw_row(packed_row(grid, grid->front, (ptrdiff_t)(region->row + i)),
+                        region->col, region->cols, pixels + i * pitch);
+    }
+}
+
+/**
+ * @brief Report the regions changed since the last call, one span of tiles at a time
+ * @param ctx Game context
+ * @param emit Callback receiving each changed region
+ * @param arg Argument passed to the callback
+ */
+static void packed_flush_dirty(gol_context_t *ctx, gol_region_fn emit, void *arg) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    
+    for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+        uint8_t *redraw = packed_tile(grid, grid->redraw, (ptrdiff_t)ty, 0);
+        size_t tx = 0;
+        
+        while (tx < grid->tiles_x) {
+            if (!redraw[tx]) {
+                tx++;
+                continue;
+            }
+            
+            /* Merge horizontally adjacent dirty tiles into one region */
+            size_t run_end = tx;
+            while (run_end < grid->tiles_x && redraw[run_end]) {
+                redraw[run_end++] = 0;
+            }
+            
+            gol_region_t region;
+            region.row = ty * TILE_ROWS;
+            region.rows = (region.row + TILE_ROWS <= ctx->rows) ? TILE_ROWS : ctx->rows - region.row;
+            region.col = tx * CELLS_PER_WORD;
+            size_t col_end = run_end * CELLS_PER_WORD;
+            region.cols = (col_end <= ctx->cols ? col_end : ctx->cols) - region.col;
+            emit(ctx, &region, arg);
+            
+            tx = run_end;
+        }
+    }
+}
+
+/**
+ * @brief OR adjacent pairs of bits together and pack the results
+ * @param x 64 cells or blocks
+ * @return Bit i set if bit 2i or 2i + 1 of x is, in the low 32 bits
+ */
+static inline uint64_t lod_pairs(uint64_t x) {
+    x = (x | (x >> 1)) & UINT64_C(0x5555555555555555);
+    x = (x | (x >> 1)) & UINT64_C(0x3333333333333333);
+    x = (x | (x >> 2)) & UINT64_C(0x0F0F0F0F0F0F0F0F);
+    x = (x | (x >> 4)) & UINT64_C(0x00FF00FF00FF00FF);
+    x = (x | (x >> 8)) & UINT64_C(0x0000FFFF0000FFFF);
+    return (x | (x >> 16)) & UINT64_C(0x00000000FFFFFFFF);
+}
+
+/**
+ * @brief Get the number of block rows of a LOD level
+ * @param ctx Game context
+ * @param level LOD level, 0 for the cells themselves
+ * @return ceil(rows / 2^level)
+ */
+static inline size_t packed_lod_rows(const gol_context_t *ctx, unsigned int level) {
+    return ((ctx->rows - 1) >> level) + 1;
+}
+
+/**
+ * @brief Get the number of words per row of a LOD level
+ * @param ctx Game context
+ * @param level LOD level, 0 for the cells themselves
+ * @return ceil(ceil(cols / 2^level) / 64)
+ */
+static inline size_t packed_lod_words(const gol_context_t *ctx, unsigned int level) {
+    return (((ctx->cols - 1) >> level) + CELLS_PER_WORD) / CELLS_PER_WORD;
+}
+
+/**
+ * @brief Get one row of a LOD level
+ * @param ctx Game context
+ * @param level LOD level, 0 for the current generation
+ * @param row Block row
+ * @return First word of the row
+ */
+static inline uint64_t *packed_lod_row(gol_context_t *ctx, unsigned int level, size_t row) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    if (level == 0) {
+        return packed_row(grid, grid->front, (ptrdiff_t)row);
+    }
+    return grid->lod[level] + row * packed_lod_words(ctx, level);
+}
+
+/**
+ * @brief Recompute a rectangle of a LOD level from the level below
+ * @param ctx Game context
+ * @param level Level to recompute, at least 1
+ * @param row_begin First block row
+ * @param row_end Block row after the last
+ * @param word_begin First word of each row
+ * @param word_end Word after the last
+ */
+static void packed_lod_reduce(gol_context_t *ctx, unsigned int level, size_t row_begin,
+                              size_t row_end, size_t word_begin, size_t word_end) {
+    size_t below_rows = packed_lod_rows(ctx, level - 1);
+    size_t below_words = packed_lod_words(ctx, level - 1);
+    
+    for (size_t r = row_begin; r < row_end; r++) {
+        const uint64_t *top = packed_lod_row(ctx, level - 1, 2 * r);
+        const uint64_t *bottom = 2 * r + 1 < below_rows ? packed_lod_row(ctx, level - 1, 2 * r + 1)
+                                                        : top;
+        uint64_t *out = packed_lod_row(ctx, level, r);
+        
+        /* Word w covers words 2w and 2w + 1 of both rows below */
+        for (size_t w = word_begin; w < word_end; w++) {
+            uint64_t low = top[2 * w] | bottom[2 * w];
+            uint64_t high = 2 * w + 1 < below_words ? top[2 * w + 1] | bottom[2 * w + 1] : 0;
+            out[w] = lod_pairs(low) | (lod_pairs(high) << 32);
+        }
+    }
+}
+
+/**
+ * @brief Bring the LOD levels up to date with the tiles changed since the last call
+ * @param ctx Game context
+ * @return false if the levels could not be allocated
+ */
+static bool packed_lod_update(gol_context_t *ctx) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    
+    if (!grid->lod[1]) {
+        /* Levels up to the one holding the whole board in a single block */
+        unsigned int levels = 1;
+        while (levels < MAX_LOD_LEVEL &&
+               (packed_lod_rows(ctx, levels) > 1 || ((ctx->cols - 1) >> levels) > 0)) {
+            levels++;
+        }
+        
+        size_t words = 0;
+        for (unsigned int l = 1; l <= levels; l++) {
+            words += packed_lod_rows(ctx, l) * packed_lod_words(ctx, l);
+        }
+        uint64_t *storage = malloc(words * sizeof(uint64_t));
+        if (!storage) {
+            return false;
+        }
+        for (unsigned int l = 1; l <= levels; l++) {
+            grid->lod[l] = storage;
+            storage += packed_lod_rows(ctx, l) * packed_lod_words(ctx, l);
+        }
+        grid->lod_levels = levels;
+        
+        for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+            memset(packed_tile(grid, grid->lod_dirty, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+        }
+    }
+    
+    for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+        uint8_t *dirty = packed_tile(grid, grid->lod_dirty, (ptrdiff_t)ty, 0);
+        size_t tx = 0;
+        
+        while (tx < grid->tiles_x) {
+            if (!dirty[tx]) {
+                tx++;
+                continue;
+            }
+            
+            size_t run_end = tx;
+            while (run_end < grid->tiles_x && dirty[run_end]) {
+                dirty[run_end++] = 0;
+            }
+            
+            /* Each level halves the rectangle of rows and words that changed */
+            size_t row_begin = ty * TILE_ROWS;
+            size_t row_end = row_begin + TILE_ROWS < ctx->rows ? row_begin + TILE_ROWS : ctx->rows;
+            size_t word_begin = tx, word_end = run_end;
+            for (unsigned int l = 1; l <= grid->lod_levels; l++) {
+                row_begin /= 2;
+                row_end = (row_end - 1) / 2 + 1;
+                word_begin /= 2;
+                word_end = (word_end - 1) / 2 + 1;
+                packed_lod_reduce(ctx, l, row_begin, row_end, word_begin, word_end);
+            }
+            
+            tx = run_end;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Draw blocks of cells from the LOD levels, one pixel per block
+ * 
+ * Only the levels over tiles changed since the last call are recomputed,
+ * so a frame costs the size of the region plus the recent activity, not
+ * the size of the board.
+ * 
+ * @param ctx Game context
+ * @param blocks Region of blocks to draw
+ * @param level log2 of cells per block side, at least 1
+ * @param pixels Destination for the region's top-left block
+ * @param pitch Distance between destination rows, in pixels
+ * @return false if the levels could not be allocated
+ */
+static bool packed_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                               unsigned int level, uint32_t *pixels, size_t pitch) {
+    if (!packed_lod_update(ctx) || level > ctx->packed.lod_levels) {
+        return false;
+    }
+    
+    for (size_t i = 0; i < blocks->rows; i++) {
+        packed_draw_row(packed_lod_row(ctx, level, blocks->row + i), blocks->col, blocks->cols,
+                        pixels + i * pitch);
+    }
+    return true;
+}
+
+/**
+ * @brief Bit-sliced full adder over 64 lanes
+ * @param a First addend
+ * @param b Second addend
+ * @param c Third addend
+ * @param sum Receives the low bit of a + b + c per lane
+ * @param carry Receives the high bit of a + b + c per lane
+ */
+static inline void full_add(uint64_t a, uint64_t b, uint64_t c,
+                            uint64_t *sum, uint64_t *carry) {
+    uint64_t t = a ^ b;
+    *sum = t ^ c;
+    *carry = (a & b) | (t & c);
+}
+
+/**
+ * @brief Compute the next state of 64 cells from their 3x3 neighborhood
+ * @param above Centre word of the row above; words at -1 and +1 are read too
+ * @param middle Centre word of the current row; words at -1 and +1 are read too
+ * @param below Centre word of the row below; words at -1 and +1 are read too
+ * @return Next state of the 64 cells of the centre word
+ */
+static inline uint64_t packed_next_word(const uint64_t *above, const uint64_t *middle,
+                                        const uint64_t *below) {
+    /* Neighbor to the left of bit b is column b - 1, to the right is b + 1 */
+    uint64_t a_l = (above[0] << 1) | (above[-1] >> 63);
+    uint64_t a_r = (above[0] >> 1) | (above[1] << 63);
+    uint64_t m_l = (middle[0] << 1) | (middle[-1] >> 63);
+    uint64_t m_r = (middle[0] >> 1) | (middle[1] << 63);
+    uint64_t b_l = (below[0] << 1) | (below[-1] >> 63);
+    uint64_t b_r = (below[0] >> 1) | (below[1] << 63);
+    
+    /* Per-row partial sums: above and below are 0..3, middle is 0..2 */
+    uint64_t s_a, c_a, s_b, c_b;
+    full_add(a_l, above[0], a_r, &s_a, &c_a);
+    full_add(b_l, below[0], b_r, &s_b, &c_b);
+    uint64_t s_m = m_l ^ m_r;
+    uint64_t c_m = m_l & m_r;
+    
+    /* Combine into a 4-bit neighbor count: ones, twos, and >= 4 */
+    uint64_t ones, k, twos_lo, fours;
+    full_add(s_a, s_m, s_b, &ones, &k);
+    full_add(c_a, c_m, c_b, &twos_lo, &fours);
+    uint64_t twos = twos_lo ^ k;
+    uint64_t four_or_more = fours | (twos_lo & k);
+    
+    /* Alive next if count == 3, or count == 2 and currently alive */
+    return twos & ~four_or_more & (ones | middle[0]);
+}
+
+/**
+ * @brief Compute the next state of one packed row
+ * @param above Row above (words -1 and words are read)
+ * @param middle Current row (words -1 and words are read)
+ * @param below Row below (words -1 and words are read)
+ * @param out Output row
+ * @param words Number of cell words in the row
+ */
+static void packed_step_row(const uint64_t *restrict above, const uint64_t *restrict middle,
+                            const uint64_t *restrict below, uint64_t *restrict out,
+                            size_t words) {
+    for (size_t w = 0; w < words; w++) {
+        out[w] = packed_next_word(above + w, middle + w, below + w);
+    }
+}
+
+/**
+ * @brief Select between two words bit by bit
+ * @param select Mask choosing the bits of if_set
+ * @param if_set Bits taken where select is 1
+ * @param if_clear Bits taken where select is 0
+ * @return The selected bits
+ */
+static inline uint64_t bit_select(uint64_t select, uint64_t if_set, uint64_t if_clear) {
+    return if_clear ^ (select & (if_set ^ if_clear));
+}
+
+/**
+ * @brief Compute the next state of 64 cells under any rule
+ * 
+ * The neighbor count is summed into four bit planes, and the rule is a
+ * multiplexer tree over them and the cell's own state whose leaves are
+ * the rule's mask bits. Inlined with constant masks, the compiler folds
+ * the tree into the boolean circuit of that rule.
+ * 
+ * @param above Centre word of the row above; words at -1 and +1 are read too
+ * @param middle Centre word of the current row; words at -1 and +1 are read too
+ * @param below Centre word of the row below; words at -1 and +1 are read too
+ * @param birth Birth mask of the rule
+ * @param survive Survival mask of the rule
+ * @return Next state of the 64 cells of the centre word
+ * @see packed_next_word
+ */
+static inline __attribute__((always_inline))
+uint64_t packed_rule_word(const uint64_t *above, const uint64_t *middle, const uint64_t *below,
+                          unsigned int birth, unsigned int survive) {
+    uint64_t a_l = (above[0] << 1) | (above[-1] >> 63);
+    uint64_t a_r = (above[0] >> 1) | (above[1] << 63);
+    uint64_t m_l = (middle[0] << 1) | (middle[-1] >> 63);
+    uint64_t m_r = (middle[0] >> 1) | (middle[1] << 63);
+    uint64_t b_l = (below[0] << 1) | (below[-1] >> 63);
+    uint64_t b_r = (below[0] >> 1) | (below[1] << 63);
+    
+    uint64_t s_a, c_a, s_b, c_b;
+    full_add(a_l, above[0], a_r, &s_a, &c_a);
+    full_add(b_l, below[0], b_r, &s_b, &c_b);
+    uint64_t s_m = m_l ^ m_r;
+    uint64_t c_m = m_l & m_r;
+    
+    /* The full count 0..8 as bit planes; 8 is the only count with the eights bit */
+    uint64_t ones, k, twos_lo, fours_lo;
+    full_add(s_a, s_m, s_b, &ones, &k);
+    full_add(c_a, c_m, c_b, &twos_lo, &fours_lo);
+    uint64_t twos = twos_lo ^ k;
+    uint64_t carry = twos_lo & k;
+    uint64_t fours = fours_lo ^ carry;
+    uint64_t eights = fours_lo & carry;
+    
+    /* Leaves: all ones if the rule keeps a cell with that state and count alive */
+#define RULE_LEAF(mask, count) (0 - (uint64_t)(((mask) >> (count)) & 1u))
+    uint64_t next[2];
+    for (int alive = 0; alive < 2; alive++) {
+        unsigned int mask = alive ? survive : birth;
+        uint64_t low = bit_select(twos, bit_select(ones, RULE_LEAF(mask, 3), RULE_LEAF(mask, 2)),
+                                        bit_select(ones, RULE_LEAF(mask, 1), RULE_LEAF(mask, 0)));
+        uint64_t high = bit_select(twos, bit_select(ones, RULE_LEAF(mask, 7), RULE_LEAF(mask, 6)),
+                                         bit_select(ones, RULE_LEAF(mask, 5), RULE_LEAF(mask, 4)));
+        next[alive] = bit_select(eights, RULE_LEAF(mask, 8), bit_select(fours, high, low));
+    }
+#undef RULE_LEAF
+    
+    return bit_select(middle[0], next[1], next[0]);
+}
+
+/**
+ * @brief Compute the next state of one packed row under any rule
+ * @param above Row above (words -1 and words are read)
+ * @param middle Current row (words -1 and words are read)
+ * @param below Row below (words -1 and words are read)
+ * @param out Output row
+ * @param words Number of cell words in the row
+ * @param rule Rule to apply
+ */
+static void packed_step_row_rule(const uint64_t *restrict above, const uint64_t *restrict middle,
+                                 const uint64_t *restrict below, uint64_t *restrict out,
+                                 size_t words, const gol_rule_t *rule) {
+    for (size_t w = 0; w < words; w++) {
+        out[w] = packed_rule_word(above + w, middle + w, below + w, rule->birth, rule->survive);
+    }
+}
+
+/* Row function with the circuit of one rule compiled in */
+#define PACKED_RULE_ROW(name, birth, survive)                                                  \
+    static void packed_step_row_##name(const uint64_t *restrict above,                        \
+                                       const uint64_t *restrict middle,                       \
+                                       const uint64_t *restrict below,                        \
+                                       uint64_t *restrict out, size_t words,                  \
+                                       const gol_rule_t *rule) {                              \
+        (void)rule;                                                                           \
+        for (size_t w = 0; w < words; w++) {                                                  \
+            out[w] = packed_rule_word(above + w, middle + w, below + w, birth, survive);      \
+        }                                                                                     \
+    }
+
+/* Masks of the rules that get their own circuit */
+#define RULE_MASK_CONWAY_B 0x008u       /* B3 */
+#define RULE_MASK_CONWAY_S 0x00Cu       /* S23 */
+#define RULE_MASK_HIGHLIFE_B 0x048u     /* B36 */
+#define RULE_MASK_DAY_NIGHT_B 0x1C8u    /* B3678 */
+#define RULE_MASK_DAY_NIGHT_S 0x1D8u    /* S34678 */
+#define RULE_MASK_SEEDS_B 0x004u        /* B2 */
+#define RULE_MASK_NO_DEATH_S 0x1FFu     /* S012345678 */
+#define RULE_MASK_MORLEY_B 0x148u       /* B368 */
+#define RULE_MASK_MORLEY_S 0x034u       /* S245 */
+#define RULE_MASK_MAZE_S 0x03Eu         /* S12345 */
+
+PACKED_RULE_ROW(conway, RULE_MASK_CONWAY_B, RULE_MASK_CONWAY_S)
+PACKED_RULE_ROW(highlife, RULE_MASK_HIGHLIFE_B, RULE_MASK_CONWAY_S)
+PACKED_RULE_ROW(day_night, RULE_MASK_DAY_NIGHT_B, RULE_MASK_DAY_NIGHT_S)
+PACKED_RULE_ROW(seeds, RULE_MASK_SEEDS_B, 0u)
+PACKED_RULE_ROW(no_death, RULE_MASK_CONWAY_B, RULE_MASK_NO_DEATH_S)
+PACKED_RULE_ROW(morley, RULE_MASK_MORLEY_B, RULE_MASK_MORLEY_S)
+PACKED_RULE_ROW(maze, RULE_MASK_CONWAY_B, RULE_MASK_MAZE_S)
+
+/* Rules with a compiled circuit; any other rule runs packed_step_row_rule() */
+static const struct {
+    uint16_t birth;
+    uint16_t survive;
+    packed_rule_row_fn row;
+} rule_circuits[] = {
+    { RULE_MASK_CONWAY_B, RULE_MASK_CONWAY_S, packed_step_row_conway },
+    { RULE_MASK_HIGHLIFE_B, RULE_MASK_CONWAY_S, packed_step_row_highlife },
+    { RULE_MASK_DAY_NIGHT_B, RULE_MASK_DAY_NIGHT_S, packed_step_row_day_night },
+    { RULE_MASK_SEEDS_B, 0u, packed_step_row_seeds },
+    { RULE_MASK_CONWAY_B, RULE_MASK_NO_DEATH_S, packed_step_row_no_death },
+    { RULE_MASK_MORLEY_B, RULE_MASK_MORLEY_S, packed_step_row_morley },
+    { RULE_MASK_CONWAY_B, RULE_MASK_MAZE_S, packed_step_row_maze },
+};
+
+/**
+ * @brief Parse an outer-totalistic rule
+ * 
+ * Accepts B/S notation in either order and either case ("B36/S23",
+ * "s23/b36") and the older S/B notation without letters ("23/36").
+ * 
+ * @param text Rule string
+ * @param rule Filled with the masks, the canonical name and the step functions
+ * @return true on success, false if the string is not a rule
+ */
+static bool rule_parse(const char *text, gol_rule_t *rule) {
+    uint16_t masks[2] = { 0, 0 };   /* Birth, survive */
+    bool seen[2] = { false, false };
+    bool lettered = text[0] == 'B' || text[0] == 'b' || text[0] == 'S' || text[0] == 's';
+    const char *c = text;
+    
+    for (int part = 0; part < 2; part++) {
+        int which;
+        if (lettered) {
+            which = (*c == 'B' || *c == 'b') ? 0 : (*c == 'S' || *c == 's') ? 1 : -1;
+            if (which < 0 || seen[which]) {
+                return false;
+            }
+            c++;
+        } else {
+            which = part == 0;  /* Survival counts come first */
+        }
+        seen[which] = true;
+        
+        for (; *c >= '0' && *c <= '8'; c++) {
+            masks[which] |= (uint16_t)(1u << (*c - '0'));
+        }
+        if (part == 0 && *c++ != '/') {
+            return false;
+        }
+    }
+    if (*c != '\0') {
+        return false;
+    }
+    
+    rule->birth = masks[0];
+    rule->survive = masks[1];
+    rule->conway = rule->birth == RULE_MASK_CONWAY_B && rule->survive == RULE_MASK_CONWAY_S;
+    
+    char *name = rule->name;
+    *name++ = 'B';
+    for (int n = 0; n <= 8; n++) {
+        if (rule->birth & (1u << n)) *name++ = (char)('0' + n);
+    }
+    *name++ = '/';
+    *name++ = 'S';
+    for (int n = 0; n <= 8; n++) {
+        if (rule->survive & (1u << n)) *name++ = (char)('0' + n);
+    }
+    *name = '\0';
+    
+    memset(rule->next, 0, sizeof(rule->next));
+    for (int n = 0; n <= 8; n++) {
+        rule->next[0][n] = (rule->birth >> n) & 1u;
+        rule->next[1][n] = (rule->survive >> n) & 1u;
+    }
+    
+    rule->packed_row = packed_step_row_rule;
+    for (size_t i = 0; i < sizeof(rule_circuits) / sizeof(rule_circuits[0]); i++) {
+        if (rule_circuits[i].birth == rule->birth && rule_circuits[i].survive == rule->survive) {
+            rule->packed_row = rule_circuits[i].row;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Flag changed words and count the cells born and died in a span
+ * 
+ * Shared by the scalar and the popcnt-targeted variant, which differ only
+ * in how the compiler lowers the popcount.
+ * 
+ * @param before Words of the previous generation
+ * @param after Words of the generation just computed
+ * @param words Number of words
+ * @param changed One flag per word, set if the word changed
+ * @param births Incremented by the cells born
+ * @param deaths Incremented by the cells that died
+ */
+static inline void packed_changes_body(const uint64_t *restrict before,
+                                       const uint64_t *restrict after, size_t words,
+                                       uint8_t *restrict changed, uint64_t *restrict births,
+                                       uint64_t *restrict deaths) {
+    uint64_t born = 0, died = 0;
+    
+    for (size_t w = 0; w < words; w++) {
+        uint64_t diff = after[w] ^ before[w];
+        changed[w] |= diff != 0;
+        born += (uint64_t)__builtin_popcountll(diff & after[w]);
+        died += (uint64_t)__builtin_popcountll(diff & before[w]);
+    }
+    *births += born;
+    *deaths += died;
+}
+
+/**
+ * @brief Portable change counter
+ * @see packed_changes_body
+ */
+static void packed_changes(const uint64_t *restrict before, const uint64_t *restrict after,
+                           size_t words, uint8_t *restrict changed, uint64_t *restrict births,
+                           uint64_t *restrict deaths) {
+    packed_changes_body(before, after, words, changed, births, deaths);
+}
+
+/**
+ * @brief Compute the next generation of a span of tiles within one tile row
+ * @param ctx Game context
+ * @param row_begin First row of the tile row
+ * @param row_end One past the last row of the tile row
+ * @param word_begin First word (tile column) of the span
+ * @param word_end One past the last word of the span
+ * @param next_changed Tile flags of this tile row for the generation being computed
+ * @param births Incremented by the cells born in the span
+ * @param deaths Incremented by the cells that died in the span
+ * @param hash Incremented by the span's change of the board hash, if ctx->track_hash
+ */
+static void packed_step_span(gol_context_t *ctx, size_t row_begin, size_t row_end,
+                             size_t word_begin, size_t word_end, uint8_t *next_changed,
+                             uint64_t *births, uint64_t *deaths, uint64_t *hash) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    const gol_rule_t *rule = &ctx->config.rule;
+    size_t words = word_end - word_begin;
+    bool has_last = word_end == grid->words;
+    
+    for (ptrdiff_t i = (ptrdiff_t)row_begin; i < (ptrdiff_t)row_end; i++) {
+        const uint64_t *middle = packed_row(grid, grid->front, i);
+        uint64_t *out = packed_row(grid, grid->back, i);
+        
+        /* Halo words at index -1 and words keep the edges dead */
+        const uint64_t *above = packed_row(grid, grid->front, i - 1) + word_begin;
+        const uint64_t *below = packed_row(grid, grid->front, i + 1) + word_begin;
+        if (rule->conway) {
+            ctx->kernel->packed_row(above, middle + word_begin, below, out + word_begin, words);
+        } else {
+            rule->packed_row(above, middle + word_begin, below, out + word_begin, words, rule);
+        }
+        
+        /*
+         * Bits past the last column are dead, except where the halo fill
+         * put the wrapped neighbor of the last column; they are carried
+         * over for the comparison so that it does not count as a change.
+         */
+        uint64_t *last = out + grid->words - 1;
+        if (has_last) {
+            *last = (*last & grid->last_mask) | (middle[grid->words - 1] & ~grid->last_mask);
+        }
+        
+        /* The words are still in cache: one XOR gives the tile flags and the changes */
+        ctx->kernel->packed_changes(middle + word_begin, out + word_begin, words,
+                                    next_changed + word_begin, births, deaths);
+        if (has_last) {
+            *last &= grid->last_mask;
+        }
+        
+        if (ctx->track_hash) {
+            /* Only rewritten words move the hash; the last one has the halo bits masked */
+            uint64_t index = (uint64_t)i * grid->words + word_begin;
+            for (size_t w = 0; w < words; w++) {
+                uint64_t before = middle[word_begin + w], after = out[word_begin + w];
+                if (has_last && w + 1 == words) {
+                    before &= grid->last_mask;
+                }
+                if (before != after) {
+                    *hash += board_word_hash(index + w, after) - board_word_hash(index + w, before);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Compute the next generation for a rectangle of packed tiles
+ * 
+ * Only spans of active tiles are recomputed; see gol_packed_grid_t.
+ * 
+ * @param ctx Game context
+ * @param row_begin First row, a multiple of TILE_ROWS
+ * @param row_end One past the last row, a multiple of TILE_ROWS or the row count
+ * @param word_begin First word (tile column)
+ * @param word_end One past the last word
+ */
+static void packed_step_region(gol_context_t *ctx, size_t row_begin, size_t row_end,
+                               size_t word_begin, size_t word_end) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    uint64_t births = 0, deaths = 0, hash = 0;
+    
+    for (size_t ty = row_begin / TILE_ROWS; ty * TILE_ROWS < row_end; ty++) {
+        size_t tile_row_begin = ty * TILE_ROWS;
+        size_t tile_row_end = tile_row_begin + TILE_ROWS < row_end ?
+                              tile_row_begin + TILE_ROWS : row_end;
+        uint8_t *next_changed = packed_tile(grid, grid->next_changed, (ptrdiff_t)ty, 0);
+        memset(next_changed + word_begin, 0, word_end - word_begin);
+        
+        size_t tx = word_begin;
+        while (tx < word_end) {
+            if (!packed_tile_active(grid, (ptrdiff_t)ty, (ptrdiff_t)tx)) {
+                tx++;
+                continue;
+            }
+            
+            size_t run_end = tx + 1;
+            while (run_end < word_end &&
+                   packed_tile_active(grid, (ptrdiff_t)ty, (ptrdiff_t)run_end)) {
+                run_end++;
+            }
+            
+            packed_step_span(ctx, tile_row_begin, tile_row_end, tx, run_end, next_changed,
+                             &births, &deaths, &hash);
+            tx = run_end;
+        }
+    }
+    
+    /* Skipped tiles are unchanged, so the computed spans hold every change */
+    stats_add_changes(ctx, births, deaths);
+    if (hash) {
+        __atomic_fetch_add(&ctx->board_hash, hash, __ATOMIC_RELAXED);
+    }
+}
+
+/**
+ * @brief Compute the next generation for a band of packed rows
+ * @param ctx Game context
+ * @param row_begin First row of the band, a multiple of TILE_ROWS
+ * @param row_end One past the last row of the band
+ */
+static void packed_step_rows(gol_context_t *ctx, size_t row_begin, size_t row_end) {
+    packed_step_region(ctx, row_begin, row_end, 0, ctx->packed.tiles_x);
+}
+
+/**
+ * @brief Swap buffers: the next generation becomes the current one
+ * @param ctx Game context
+ */
+static void packed_swap_buffers(gol_context_t *ctx) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    uint64_t *swap = grid->front;
+    grid->front = grid->back;
+    grid->back = swap;
+    
+    uint8_t *swap_flags = grid->changed;
+    grid->changed = grid->next_changed;
+    grid->next_changed = swap_flags;
+    
+    /*
+     * Skipped tiles keep the back buffer's words, which become current at
+     * the next swap, so clear the neighbors the halo fill left after the
+     * last column.
+     */
+    if (ctx->config.boundary != BOUNDARY_DEAD && grid->last_mask != ~UINT64_C(0)) {
+        for (ptrdiff_t i = 0; i < (ptrdiff_t)ctx->rows; i++) {
+            packed_row(grid, grid->back, i)[grid->words - 1] &= grid->last_mask;
+        }
+    }
+    
+    /* Accumulate changes until the renderer collects them */
+    for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+        const uint8_t *changed = packed_tile(grid, grid->changed, (ptrdiff_t)ty, 0);
+        uint8_t *redraw = packed_tile(grid, grid->redraw, (ptrdiff_t)ty, 0);
+        uint8_t *lod_dirty = packed_tile(grid, grid->lod_dirty, (ptrdiff_t)ty, 0);
+        for (size_t tx = 0; tx < grid->tiles_x; tx++) {
+            redraw[tx] |= changed[tx];
+            lod_dirty[tx] |= changed[tx];
+        }
+    }
+}
+
+/**
+ * @brief Simulate one generation of the packed grid, 64 cells at a time
+ * @param ctx Game context
+ */
+static void packed_step(gol_context_t *ctx) {
+    packed_step_rows(ctx, 0, ctx->rows);
+    packed_swap_buffers(ctx);
+}
+
+/**
+ * @brief Reverse the bits of a word
+ * @param x Word
+ * @return x with bit b moved to bit 63 - b
+ */
+static inline uint64_t reverse_bits(uint64_t x) {
+    x = ((x >> 1) & UINT64_C(0x5555555555555555)) | ((x & UINT64_C(0x5555555555555555)) << 1);
+    x = ((x >> 2) & UINT64_C(0x3333333333333333)) | ((x & UINT64_C(0x3333333333333333)) << 2);
+    x = ((x >> 4) & UINT64_C(0x0F0F0F0F0F0F0F0F)) | ((x & UINT64_C(0x0F0F0F0F0F0F0F0F)) << 4);
+    return __builtin_bswap64(x);
+}
+
+/**
+ * @brief Set the halo bits of one packed row
+ * 
+ * Column -1 is bit 63 of halo word -1. The column after the last one is
+ * bit 0 of halo word `words` when the width is a multiple of 64, and
+ * otherwise the first padding bit of the last word.
+ * 
+ * @param grid Packed grid
+ * @param row Row to fill
+ * @param cols Number of cells in a row
+ * @param left Cell seen at column -1, 0 or 1
+ * @param right Cell seen at column cols, 0 or 1
+ */
+static inline void packed_set_row_halo(const gol_packed_grid_t *grid, uint64_t *row,
+                                       size_t cols, uint64_t left, uint64_t right) {
+    size_t tail = cols % CELLS_PER_WORD;
+    
+    row[-1] = left << 63;
+    if (tail == 0) {
+        row[grid->words] = right;
+    } else {
+        row[grid->words - 1] = (row[grid->words - 1] & grid->last_mask) | (right << tail);
+    }
+}
+
+/**
+ * @brief Fill the halo bits of one packed row from its own edges
+ * @param grid Packed grid
+ * @param row Row to fill
+ * @param cols Number of cells in a row
+ * @param mirror Reflect the edge cells instead of wrapping around
+ */
+static inline void packed_fill_row_halo(const gol_packed_grid_t *grid, uint64_t *row,
+                                        size_t cols, bool mirror) {
+    uint64_t first = row[0] & 1u;
+    uint64_t last = (row[(cols - 1) / CELLS_PER_WORD] >> ((cols - 1) % CELLS_PER_WORD)) & 1u;
+    
+    packed_set_row_halo(grid, row, cols, mirror ? first : last, mirror ? last : first);
+}
+
+/**
+ * @brief Fill a packed halo row with a row reversed left to right
+ * @param grid Packed grid
+ * @param out Halo row
+ * @param row Source row; its padding bits are ignored
+ * @param cols Number of cells in a row
+ */
+static void packed_reverse_row(const gol_packed_grid_t *grid, uint64_t *restrict out,
+                               const uint64_t *restrict row, size_t cols) {
+    size_t words = grid->words;
+    unsigned int shift = (unsigned int)(words * CELLS_PER_WORD - cols);
+    
+    /* Reversing the padded row puts column c at words * 64 - 1 - c; shift it to cols - 1 - c */
+    for (size_t k = 0; k < words; k++) {
+        uint64_t low = reverse_bits(row[words - 1 - k]);
+        uint64_t high = k + 1 < words ? reverse_bits(row[words - 2 - k]) : 0;
+        out[k] = shift ? (low >> shift) | (high << (CELLS_PER_WORD - shift)) : low;
+    }
+    packed_fill_row_halo(grid, out, cols, false);
+}
+
+/**
+ * @brief Copy the board edges into the halo of the current generation
+ * 
+ * Also fills the halo ring of the tile flags as the cells wrap, so
+ * tiles next to a changed tile across an edge are recomputed.
+ * 
+ * @param ctx Game context
+ */
+static void packed_fill_halo(gol_context_t *ctx) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    gol_boundary_t boundary = ctx->config.boundary;
+    bool mirror = boundary == BOUNDARY_MIRROR;
+    ptrdiff_t rows = (ptrdiff_t)ctx->rows;
+    size_t bytes = (grid->words + 2) * sizeof(uint64_t);
+    
+    for (ptrdiff_t i = 0; i < rows; i++) {
+        packed_fill_row_halo(grid, packed_row(grid, grid->front, i), ctx->cols, mirror);
+    }
+    
+    uint64_t *top = packed_row(grid, grid->front, -1);
+    uint64_t *bottom = packed_row(grid, grid->front, rows);
+    const uint64_t *first = packed_row(grid, grid->front, 0);
+    const uint64_t *last = packed_row(grid, grid->front, rows - 1);
+    if (boundary == BOUNDARY_KLEIN) {
+        packed_reverse_row(grid, top, last, ctx->cols);
+        packed_reverse_row(grid, bottom, first, ctx->cols);
+    } else {
+        memcpy(top - 1, (mirror ? first : last) - 1, bytes);
+        memcpy(bottom - 1, (mirror ? last : first) - 1, bytes);
+    }
+    
+    /* Tile flags, edges first so the halo rows take the corners along */
+    ptrdiff_t tiles_x = (ptrdiff_t)grid->tiles_x, tiles_y = (ptrdiff_t)grid->tiles_y;
+    for (ptrdiff_t ty = 0; ty < tiles_y; ty++) {
+        uint8_t *flags = packed_tile(grid, grid->changed, ty, 0);
+        flags[-1] = flags[mirror ? 0 : tiles_x - 1];
+        flags[tiles_x] = flags[mirror ? tiles_x - 1 : 0];
+    }
+    
+    uint8_t *top_flags = packed_tile(grid, grid->changed, -1, 0);
+    uint8_t *bottom_flags = packed_tile(grid, grid->changed, tiles_y, 0);
+    const uint8_t *first_flags = packed_tile(grid, grid->changed, 0, 0);
+    const uint8_t *last_flags = packed_tile(grid, grid->changed, tiles_y - 1, 0);
+    if (boundary == BOUNDARY_KLEIN) {
+        /* Flipped, tile tx faces columns cols - 64 tx - 64 .. cols - 64 tx - 1 */
+        for (ptrdiff_t tx = 0; tx < tiles_x; tx++) {
+            ptrdiff_t high = ((ptrdiff_t)ctx->cols - 1 - tx * CELLS_PER_WORD) / CELLS_PER_WORD;
+            ptrdiff_t low = high > 0 ? high - 1 : 0;
+            top_flags[tx] = last_flags[low] | last_flags[high];
+            bottom_flags[tx] = first_flags[low] | first_flags[high];
+        }
+        top_flags[-1] = top_flags[tiles_x - 1];
+        top_flags[tiles_x] = top_flags[0];
+        bottom_flags[-1] = bottom_flags[tiles_x - 1];
+        bottom_flags[tiles_x] = bottom_flags[0];
+    } else {
+        memcpy(top_flags - 1, (mirror ? first_flags : last_flags) - 1, grid->tile_stride);
+        memcpy(bottom_flags - 1, (mirror ? last_flags : first_flags) - 1, grid->tile_stride);
+    }
+}
+
+/**
+ * @brief Bytes between packed scratch rows
+ * @param ctx Game context
+ * @return Row stride of the packed grid in bytes
+ */
+static size_t packed_block_row_bytes(const gol_context_t *ctx) {
+    return ctx->packed.stride * sizeof(uint64_t);
+}
+
+/**
+ * @brief Copy a packed board row into a scratch row
+ * @param ctx Game context
+ * @param out Scratch row
+ * @param row Board row, SIZE_MAX for a dead row including its halo
+ * @param flip Reverse the row left to right
+ */
+static void packed_block_load_row(const gol_context_t *ctx, void *out, size_t row, bool flip) {
+    const gol_packed_grid_t *grid = &ctx->packed;
+    uint64_t *words = out;
+    if (row == SIZE_MAX) {
+        memset(words - 1, 0, (grid->words + 2) * sizeof(uint64_t));
+        return;
+    }
+    
+    const uint64_t *source = packed_row(grid, grid->front, (ptrdiff_t)row);
+    if (flip) {
+        packed_reverse_row(grid, words, source, ctx->cols);
+    } else {
+        memcpy(words, source, grid->words * sizeof(uint64_t));
+    }
+}
+
+/**
+ * @brief Set the halo cells of a packed scratch row
+ * @param ctx Game context
+ * @param row Scratch row
+ */
+static void packed_block_fill_row_halo(const gol_context_t *ctx, void *row) {
+    const gol_packed_grid_t *grid = &ctx->packed;
+    uint64_t *words = row;
+    
+    if (ctx->config.boundary == BOUNDARY_DEAD) {
+        words[-1] = 0;
+        words[grid->words] = 0;
+        words[grid->words - 1] &= grid->last_mask;
+    } else {
+        packed_fill_row_halo(grid, words, ctx->cols,
+                             ctx->config.boundary == BOUNDARY_MIRROR);
+    }
+}
+
+/**
+ * @brief Compute the next state of one packed row for temporal blocking
+ * 
+ * Counted rows also flag their changed tiles, so the renderer redraws
+ * every tile that changed in any generation of the step.
+ * 
+ * @param ctx Game context
+ * @param above Row above
+ * @param middle Current row
+ * @param below Row below
+ * @param out Output row, its padding bits are cleared
+ * @param row Board row being computed
+ * @param births Incremented by the cells born, or NULL
+ * @param deaths Incremented by the cells that died, or NULL
+ */
+static void packed_block_step_row(gol_context_t *ctx, const void *above, const void *middle,
+                                  const void *below, void *out, size_t row, uint64_t *births,
+                                  uint64_t *deaths) {
+    const gol_packed_grid_t *grid = &ctx->packed;
+    const gol_rule_t *rule = &ctx->config.rule;
+    const uint64_t *current = middle;
+    uint64_t *next = out;
+    
+    if (rule->conway) {
+        ctx->kernel->packed_row(above, current, below, next, grid->words);
+    } else {
+        rule->packed_row(above, current, below, next, grid->words, rule);
+    }
+    
+    /* As in packed_step_span, halo bits in the padding are not changes */
+    uint64_t *last = next + grid->words - 1;
+    if (births) {
+        *last = (*last & grid->last_mask) | (current[grid->words - 1] & ~grid->last_mask);
+        ctx->kernel->packed_changes(current, next, grid->words,
+                                    packed_tile(grid, grid->next_changed,
+                                                (ptrdiff_t)(row / TILE_ROWS), 0),
+                                    births, deaths);
+    }
+    *last &= grid->last_mask;
+}
+
+/**
+ * @brief Locate a row of the packed next generation
+ * @param ctx Game context
+ * @param row Board row
+ * @return Pointer to word 0 of the row in the back buffer
+ */
+static void *packed_block_back_row(gol_context_t *ctx, size_t row) {
+    return packed_row(&ctx->packed, ctx->packed.back, (ptrdiff_t)row);
+}
+
+/**
+ * @brief Clear the tile flags of a band before its blocks are stepped
+ * @param ctx Game context
+ * @param row_begin First row of the band, a multiple of TILE_ROWS
+ * @param row_end One past the last row of the band
+ */
+static void packed_block_begin(gol_context_t *ctx, size_t row_begin, size_t row_end) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    
+    for (size_t ty = row_begin / TILE_ROWS; ty * TILE_ROWS < row_end; ty++) {
+        memset(packed_tile(grid, grid->next_changed, (ptrdiff_t)ty, 0), 0, grid->tiles_x);
+    }
+}
+
+/*
+ * SIMD kernels. Each one processes full vectors and hands the remaining
+ * tail of the row to the scalar kernel. They are compiled with per-function
+ * target attributes so a single binary carries all of them, and the best
+ * one the CPU supports is picked at startup unless @kernel forces one.
+ */
+
+/**
+ * @brief Scalar kernels are always available
+ * @return true
+ */
+static bool cpu_has_scalar(void) {
+    return true;
+}
+
+#ifdef GOL_HAVE_X86_KERNELS
+
+/**
+ * @brief Check for AVX2 support
+ * @return true if the CPU supports AVX2
+ */
+static bool cpu_has_avx2(void) {
+    return __builtin_cpu_supports("avx2");
+}
+
+/**
+ * @brief Check for the AVX-512 subsets used by the kernels
+ * @return true if the CPU supports AVX-512F and AVX-512BW
+ */
+static bool cpu_has_avx512(void) {
+    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+}
+
+/**
+ * @brief Dense change counter, 32 cells per iteration
+ * 
+ * Byte sums go through SAD against zero, which widens them to 64 bits.
+ * 
+ * @see dense_count_changes
+ */
+__attribute__((target("avx2")))
+static void dense_count_changes_avx2(const cell_t *restrict before, const cell_t *restrict after,
+                                     size_t cols, uint64_t *births, uint64_t *deaths) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i born = zero, died = zero;
+    size_t j = 0;
+    
+    for (; j + 32 <= cols; j += 32) {
+        __m256i b = _mm256_loadu_si256((const __m256i *)(before + j));
+        __m256i a = _mm256_loadu_si256((const __m256i *)(after + j));
+        born = _mm256_add_epi64(born, _mm256_sad_epu8(_mm256_andnot_si256(b, a), zero));
+        died = _mm256_add_epi64(died, _mm256_sad_epu8(_mm256_andnot_si256(a, b), zero));
+    }
+    
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i *)lanes, born);
+    *births += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    _mm256_storeu_si256((__m256i *)lanes, died);
+    *deaths += lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    
+    dense_count_changes(before + j, after + j, cols - j, births, deaths);
+}
+
+/**
+ * @brief Change counter using the POPCNT instruction, present on every AVX2 CPU
+ * @see packed_changes_body
+ */
+__attribute__((target("popcnt")))
+static void packed_changes_popcnt(const uint64_t *restrict before, const uint64_t *restrict after,
+                                  size_t words, uint8_t *restrict changed,
+                                  uint64_t *restrict births, uint64_t *restrict deaths) {
+    packed_changes_body(before, after, words, changed, births, deaths);
+}
+
+/**
+ * @brief Dense row kernel, 32 cells per iteration
+ * @see dense_step_row
+ */
+__attribute__((target("avx2")))
+static void dense_step_row_avx2(const cell_t *restrict above, const cell_t *restrict middle,
+                                const cell_t *restrict below, cell_t *restrict out,
+                                size_t cols) {
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i birth = _mm256_set1_epi8(NEIGHBORS_TO_BIRTH);
+    const __m256i min_survive = _mm256_set1_epi8(MIN_NEIGHBORS_TO_SURVIVE);
+    const __m256i max_survive = _mm256_set1_epi8(MAX_NEIGHBORS_TO_SURVIVE);
+    size_t j = 0;
+    
+    for (; j + 32 <= cols; j += 32) {
+        __m256i n = _mm256_loadu_si256((const __m256i *)(above + j - 1));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(above + j)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(above + j + 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(middle + j - 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(middle + j + 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(below + j - 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(below + j)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(below + j + 1)));
+        __m256i alive = _mm256_loadu_si256((const __m256i *)(middle + j));
+        
+        __m256i born = _mm256_cmpeq_epi8(n, birth);
+        __m256i clamped = _mm256_min_epu8(_mm256_max_epu8(n, min_survive), max_survive);
+        __m256i survives = _mm256_and_si256(_mm256_cmpeq_epi8(clamped, n),
+                                            _mm256_cmpeq_epi8(alive, one));
+        __m256i next = _mm256_and_si256(_mm256_or_si256(born, survives), one);
+        _mm256_storeu_si256((__m256i *)(out + j), next);
+    }
+    
+    dense_step_row(above + j, middle + j, below + j, out + j, cols - j);
+}
+
+/**
+ * @brief Dense row kernel under any rule, 32 cells per iteration
+ * 
+ * The neighbor counts index the rule's birth and survival tables with a
+ * byte shuffle, and the cell's state picks between the two.
+ * 
+ * @see dense_step_row_rule
+ */
+__attribute__((target("avx2")))
+static void dense_step_row_rule_avx2(const cell_t *restrict above, const cell_t *restrict middle,
+                                     const cell_t *restrict below, cell_t *restrict out,
+                                     size_t cols, const gol_rule_t *rule) {
+    const __m256i one = _mm256_set1_epi8(1);
+    const __m256i born_table = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)rule->next[0]));
+    const __m256i survive_table = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *)rule->next[1]));
+    size_t j = 0;
+    
+    for (; j + 32 <= cols; j += 32) {
+        __m256i n = _mm256_loadu_si256((const __m256i *)(above + j - 1));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(above + j)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(above + j + 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(middle + j - 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(middle + j + 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(below + j - 1)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(below + j)));
+        n = _mm256_add_epi8(n, _mm256_loadu_si256((const __m256i *)(below + j + 1)));
+        __m256i alive = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(middle + j)), one);
+        
+        __m256i next = _mm256_blendv_epi8(_mm256_shuffle_epi8(born_table, n),
+                                          _mm256_shuffle_epi8(survive_table, n), alive);
+        _mm256_storeu_si256((__m256i *)(out + j), next);
+    }
+    
+    dense_step_row_rule(above + j, middle + j, below + j, out + j, cols - j, rule);
+}
+
+/**
+ * @brief Dense row kernel, 64 cells per iteration
+ * @see dense_step_row
+ */
+__attribute__((target("avx512f,avx512bw")))
+static void dense_step_row_avx512(const cell_t *restrict above, const cell_t *restrict middle,
+                                  const cell_t *restrict below, cell_t *restrict out,
+                                  size_t cols) {
+    const __m512i one = _mm512_set1_epi8(1);
+    const __m512i birth = _mm512_set1_epi8(NEIGHBORS_TO_BIRTH);
+    const __m512i min_survive = _mm512_set1_epi8(MIN_NEIGHBORS_TO_SURVIVE);
+    const __m512i max_survive = _mm512_set1_epi8(MAX_NEIGHBORS_TO_SURVIVE);
+    size_t j = 0;
+    
+    for (; j + 64 <= cols; j += 64) {
+        __m512i n = _mm512_loadu_si512(above + j - 1);
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(above + j));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(above + j + 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(middle + j - 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(middle + j + 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(below + j - 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(below + j));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(below + j + 1));
+        __m512i alive = _mm512_loadu_si512(middle + j);
+        
+        __mmask64 born = _mm512_cmpeq_epi8_mask(n, birth);
+        __mmask64 survives = _mm512_cmpge_epu8_mask(n, min_survive) &
+                             _mm512_cmple_epu8_mask(n, max_survive) &
+                             _mm512_test_epi8_mask(alive, alive);
+        _mm512_storeu_si512(out + j, _mm512_maskz_mov_epi8(born | survives, one));
+    }
+    
+    dense_step_row(above + j, middle + j, below + j, out + j, cols - j);
+}
+
+/**
+ * @brief Dense row kernel under any rule, 64 cells per iteration
+ * @see dense_step_row_rule_avx2
+ */
+__attribute__((target("avx512f,avx512bw")))
+static void dense_step_row_rule_avx512(const cell_t *restrict above,
+                                       const cell_t *restrict middle,
+                                       const cell_t *restrict below, cell_t *restrict out,
+                                       size_t cols, const gol_rule_t *rule) {
+    const __m512i born_table = _mm512_broadcast_i32x4(
+        _mm_loadu_si128((const __m128i *)rule->next[0]));
+    const __m512i survive_table = _mm512_broadcast_i32x4(
+        _mm_loadu_si128((const __m128i *)rule->next[1]));
+    size_t j = 0;
+    
+    for (; j + 64 <= cols; j += 64) {
+        __m512i n = _mm512_loadu_si512(above + j - 1);
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(above + j));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(above + j + 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(middle + j - 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(middle + j + 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(below + j - 1));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(below + j));
+        n = _mm512_add_epi8(n, _mm512_loadu_si512(below + j + 1));
+        __m512i alive = _mm512_loadu_si512(middle + j);
+        
+        __m512i next = _mm512_mask_blend_epi8(_mm512_test_epi8_mask(alive, alive),
+                                              _mm512_shuffle_epi8(born_table, n),
+                                              _mm512_shuffle_epi8(survive_table, n));
+        _mm512_storeu_si512(out + j, next);
+    }
+    
+    dense_step_row_rule(above + j, middle + j, below + j, out + j, cols - j, rule);
+}
+
+/**
+ * @brief Bit-sliced full adder over 256 lanes
+ * @see full_add
+ */
+__attribute__((target("avx2")))
+static inline void full_add_avx2(__m256i a, __m256i b, __m256i c, __m256i *sum, __m256i *carry) {
+    __m256i t = _mm256_xor_si256(a, b);
+    *sum = _mm256_xor_si256(t, c);
+    *carry = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(t, c));
+}
+
+/**
+ * @brief Packed row kernel, 4 words (256 cells) per iteration
+ * @see packed_step_row
+ */
+__attribute__((target("avx2")))
+static void packed_step_row_avx2(const uint64_t *restrict above, const uint64_t *restrict middle,
+                                 const uint64_t *restrict below, uint64_t *restrict out,
+                                 size_t words) {
+    size_t w = 0;
+    
+    for (; w + 4 <= words; w += 4) {
+        __m256i a = _mm256_loadu_si256((const __m256i *)(above + w));
+        __m256i m = _mm256_loadu_si256((const __m256i *)(middle + w));
+        __m256i b = _mm256_loadu_si256((const __m256i *)(below + w));
+        
+        /* Words shifted by one give the carry bits across word boundaries */
+        __m256i a_l = _mm256_or_si256(_mm256_slli_epi64(a, 1), _mm256_srli_epi64(
+                          _mm256_loadu_si256((const __m256i *)(above + w - 1)), 63));
+        __m256i a_r = _mm256_or_si256(_mm256_srli_epi64(a, 1), _mm256_slli_epi64(
+                          _mm256_loadu_si256((const __m256i *)(above + w + 1)), 63));
+        __m256i m_l = _mm256_or_si256(_mm256_slli_epi64(m, 1), _mm256_srli_epi64(
+                          _mm256_loadu_si256((const __m256i *)(middle + w - 1)), 63));
+        __m256i m_r = _mm256_or_si256(_mm256_srli_epi64(m, 1), _mm256_slli_epi64(
+                          _mm256_loadu_si256((const __m256i *)(middle + w + 1)), 63));
+        __m256i b_l = _mm256_or_si256(_mm256_slli_epi64(b, 1), _mm256_srli_epi64(
+                          _mm256_loadu_si256((const __m256i *)(below + w - 1)), 63));
+        __m256i b_r = _mm256_or_si256(_mm256_srli_epi64(b, 1), _mm256_slli_epi64(
+                          _mm256_loadu_si256((const __m256i *)(below + w + 1)), 63));
+        
+        __m256i s_a, c_a, s_b, c_b;
+        full_add_avx2(a_l, a, a_r, &s_a, &c_a);
+        full_add_avx2(b_l, b, b_r, &s_b, &c_b);
+        __m256i s_m = _mm256_xor_si256(m_l, m_r);
+        __m256i c_m = _mm256_and_si256(m_l, m_r);
+        
+        __m256i ones, k, twos_lo, fours;
+        full_add_avx2(s_a, s_m, s_b, &ones, &k);
+        full_add_avx2(c_a, c_m, c_b, &twos_lo, &fours);
+        __m256i twos = _mm256_xor_si256(twos_lo, k);
+        __m256i four_or_more = _mm256_or_si256(fours, _mm256_and_si256(twos_lo, k));
+        
+        __m256i next = _mm256_andnot_si256(four_or_more,
+                                           _mm256_and_si256(twos, _mm256_or_si256(ones, m)));
+        _mm256_storeu_si256((__m256i *)(out + w), next);
+    }
+    
+    packed_step_row(above + w, middle + w, below + w, out + w, words - w);
+}
+
+/**
+ * @brief Packed row kernel, 8 words (512 cells) per iteration
+ * 
+ * Uses ternary logic so each full adder is two instructions.
+ * 
+ * @see packed_step_row
+ */
+__attribute__((target("avx512f")))
+static void packed_step_row_avx512(const uint64_t *restrict above, const uint64_t *restrict middle,
+                                   const uint64_t *restrict below, uint64_t *restrict out,
+                                   size_t words) {
+    size_t w = 0;
+    
+    /* Truth tables: 0x96 is a ^ b ^ c, 0xE8 is majority(a, b, c) */
+#define XOR3(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0x96)
+#define MAJ3(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0xE8)
+    for (; w + 8 <= words; w += 8) {
+        __m512i a = _mm512_loadu_si512(above + w);
+        __m512i m = _mm512_loadu_si512(middle + w);
+        __m512i b = _mm512_loadu_si512(below + w);
+        
+        __m512i a_l = _mm512_or_si512(_mm512_slli_epi64(a, 1),
+                                      _mm512_srli_epi64(_mm512_loadu_si512(above + w - 1), 63));
+        __m512i a_r = _mm512_or_si512(_mm512_srli_epi64(a, 1),
+                                      _mm512_slli_epi64(_mm512_loadu_si512(above + w + 1), 63));
+        __m512i m_l = _mm512_or_si512(_mm512_slli_epi64(m, 1),
+                                      _mm512_srli_epi64(_mm512_loadu_si512(middle + w - 1), 63));
+        __m512i m_r = _mm512_or_si512(_mm512_srli_epi64(m, 1),
+                                      _mm512_slli_epi64(_mm512_loadu_si512(middle + w + 1), 63));
+        __m512i b_l = _mm512_or_si512(_mm512_slli_epi64(b, 1),
+                                      _mm512_srli_epi64(_mm512_loadu_si512(below + w - 1), 63));
+        __m512i b_r = _mm512_or_si512(_mm512_srli_epi64(b, 1),
+                                      _mm512_slli_epi64(_mm512_loadu_si512(below + w + 1), 63));
+        
+        __m512i s_a = XOR3(a_l, a, a_r), c_a = MAJ3(a_l, a, a_r);
+        __m512i s_b = XOR3(b_l, b, b_r), c_b = MAJ3(b_l, b, b_r);
+        __m512i s_m = _mm512_xor_si512(m_l, m_r);
+        __m512i c_m = _mm512_and_si512(m_l, m_r);
+        
+        __m512i ones = XOR3(s_a, s_m, s_b), k = MAJ3(s_a, s_m, s_b);
+        __m512i twos_lo = XOR3(c_a, c_m, c_b), fours = MAJ3(c_a, c_m, c_b);
+        __m512i twos = _mm512_xor_si512(twos_lo, k);
+        __m512i four_or_more = _mm512_or_si512(fours, _mm512_and_si512(twos_lo, k));
+        
+        __m512i next = _mm512_andnot_si512(four_or_more,
+                                           _mm512_and_si512(twos, _mm512_or_si512(ones, m)));
+        _mm512_storeu_si512(out + w, next);
+    }
+#undef XOR3
+#undef MAJ3
+    
+    packed_step_row(above + w, middle + w, below + w, out + w, words - w);
+}
+
+#endif /* GOL_HAVE_X86_KERNELS */
+
+#ifdef GOL_HAVE_NEON_KERNELS
+
+/**
+ * @brief NEON is part of the AArch64 baseline
+ * @return true
+ */
+static bool cpu_has_neon(void) {
+    return true;
+}
+
+/**
+ * @brief Dense row kernel, 16 cells per iteration
+ * @see dense_step_row
+ */
+static void dense_step_row_neon(const cell_t *restrict above, const cell_t *restrict middle,
+                                const cell_t *restrict below, cell_t *restrict out,
+                                size_t cols) {
+    const uint8x16_t one = vdupq_n_u8(1);
+    const uint8x16_t birth = vdupq_n_u8(NEIGHBORS_TO_BIRTH);
+    const uint8x16_t min_survive = vdupq_n_u8(MIN_NEIGHBORS_TO_SURVIVE);
+    const uint8x16_t max_survive = vdupq_n_u8(MAX_NEIGHBORS_TO_SURVIVE);
+    size_t j = 0;
+    
+    for (; j + 16 <= cols; j += 16) {
+        uint8x16_t n = vld1q_u8(above + j - 1);
+        n = vaddq_u8(n, vld1q_u8(above + j));
+        n = vaddq_u8(n, vld1q_u8(above + j + 1));
+        n = vaddq_u8(n, vld1q_u8(middle + j - 1));
+        n = vaddq_u8(n, vld1q_u8(middle + j + 1));
+        n = vaddq_u8(n, vld1q_u8(below + j - 1));
+        n = vaddq_u8(n, vld1q_u8(below + j));
+        n = vaddq_u8(n, vld1q_u8(below + j + 1));
+        uint8x16_t alive = vld1q_u8(middle + j);
+        
+        uint8x16_t born = vceqq_u8(n, birth);
+        uint8x16_t survives = vandq_u8(vandq_u8(vcgeq_u8(n, min_survive),
+                                                vcleq_u8(n, max_survive)),
+                                       vceqq_u8(alive, one));
+        vst1q_u8(out + j, vandq_u8(vorrq_u8(born, survives), one));
+    }
+    
+    dense_step_row(above + j, middle + j, below + j, out + j, cols - j);
+}
+
+/**
+ * @brief Dense row kernel under any rule, 16 cells per iteration
+ * @see dense_step_row_rule_avx2
+ */
+static void dense_step_row_rule_neon(const cell_t *restrict above, const cell_t *restrict middle,
+                                     const cell_t *restrict below, cell_t *restrict out,
+                                     size_t cols, const gol_rule_t *rule) {
+    const uint8x16_t one = vdupq_n_u8(1);
+    const uint8x16_t born_table = vld1q_u8(rule->next[0]);
+    const uint8x16_t survive_table = vld1q_u8(rule->next[1]);
+    size_t j = 0;
+    
+    for (; j + 16 <= cols; j += 16) {
+        uint8x16_t n = vld1q_u8(above + j - 1);
+        n = vaddq_u8(n, vld1q_u8(above + j));
+        n = vaddq_u8(n, vld1q_u8(above + j + 1));
+        n = vaddq_u8(n, vld1q_u8(middle + j - 1));
+        n = vaddq_u8(n, vld1q_u8(middle + j + 1));
+        n = vaddq_u8(n, vld1q_u8(below + j - 1));
+        n = vaddq_u8(n, vld1q_u8(below + j));
+        n = vaddq_u8(n, vld1q_u8(below + j + 1));
+        uint8x16_t alive = vceqq_u8(vld1q_u8(middle + j), one);
+        
+        vst1q_u8(out + j, vbslq_u8(alive, vqtbl1q_u8(survive_table, n),
+                                   vqtbl1q_u8(born_table, n)));
+    }
+    
+    dense_step_row_rule(above + j, middle + j, below + j, out + j, cols - j, rule);
+}
+
+/**
+ * @brief Bit-sliced full adder over 128 lanes
+ * @see full_add
+ */
+static inline void full_add_neon(uint64x2_t a, uint64x2_t b, uint64x2_t c,
+                                 uint64x2_t *sum, uint64x2_t *carry) {
+    uint64x2_t t = veorq_u64(a, b);
+    *sum = veorq_u64(t, c);
+    *carry = vorrq_u64(vandq_u64(a, b), vandq_u64(t, c));
+}
+
+/**
+ * @brief Packed row kernel, 2 words (128 cells) per iteration
+ * @see packed_step_row
+ */
+static void packed_step_row_neon(const uint64_t *restrict above, const uint64_t *restrict middle,
+                                 const uint64_t *restrict below, uint64_t *restrict out,
+                                 size_t words) {
+    size_t w = 0;
+    
+    for (; w + 2 <= words; w += 2) {
+        uint64x2_t a = vld1q_u64(above + w);
+        uint64x2_t m = vld1q_u64(middle + w);
+        uint64x2_t b = vld1q_u64(below + w);
+        
+        uint64x2_t a_l = vorrq_u64(vshlq_n_u64(a, 1), vshrq_n_u64(vld1q_u64(above + w - 1), 63));
+        uint64x2_t a_r = vorrq_u64(vshrq_n_u64(a, 1), vshlq_n_u64(vld1q_u64(above + w + 1), 63));
+        uint64x2_t m_l = vorrq_u64(vshlq_n_u64(m, 1), vshrq_n_u64(vld1q_u64(middle + w - 1), 63));
+        uint64x2_t m_r = vorrq_u64(vshrq_n_u64(m, 1), vshlq_n_u64(vld1q_u64(middle + w + 1), 63));
+        uint64x2_t b_l = vorrq_u64(vshlq_n_u64(b, 1), vshrq_n_u64(vld1q_u64(below + w - 1), 63));
+        uint64x2_t b_r = vorrq_u64(vshrq_n_u64(b, 1), vshlq_n_u64(vld1q_u64(below + w + 1), 63));
+        
+        uint64x2_t s_a, c_a, s_b, c_b;
+        full_add_neon(a_l, a, a_r, &s_a, &c_a);
+        full_add_neon(b_l, b, b_r, &s_b, &c_b);
+        uint64x2_t s_m = veorq_u64(m_l, m_r);
+        uint64x2_t c_m = vandq_u64(m_l, m_r);
+        
+        uint64x2_t ones, k, twos_lo, fours;
+        full_add_neon(s_a, s_m, s_b, &ones, &k);
+        full_add_neon(c_a, c_m, c_b, &twos_lo, &fours);
+        uint64x2_t twos = veorq_u64(twos_lo, k);
+        uint64x2_t four_or_more = vorrq_u64(fours, vandq_u64(twos_lo, k));
+        
+        /* vbicq(x, y) is x & ~y */
+        vst1q_u64(out + w, vbicq_u64(vandq_u64(twos, vorrq_u64(ones, m)), four_or_more));
+    }
+    
+    packed_step_row(above + w, middle + w, below + w, out + w, words - w);
+}
+
+#endif /* GOL_HAVE_NEON_KERNELS */
+
+/* Available Kernels, best first: KERNEL_AUTO picks the first supported one */
+static const gol_kernel_t kernels[] = {
+#ifdef GOL_HAVE_X86_KERNELS
+    { KERNEL_AVX512, cpu_has_avx512, dense_step_row_avx512, packed_step_row_avx512,
+      dense_step_row_rule_avx512, dense_count_changes_avx2, packed_changes_popcnt },
+    { KERNEL_AVX2, cpu_has_avx2, dense_step_row_avx2, packed_step_row_avx2,
+      dense_step_row_rule_avx2, dense_count_changes_avx2, packed_changes_popcnt },
+#endif
+#ifdef GOL_HAVE_NEON_KERNELS
+    { KERNEL_NEON, cpu_has_neon, dense_step_row_neon, packed_step_row_neon,
+      dense_step_row_rule_neon, dense_count_changes, packed_changes },
+#endif
+    { KERNEL_SCALAR, cpu_has_scalar, dense_step_row, packed_step_row,
+      dense_step_row_rule, dense_count_changes, packed_changes }
+};
+
+/**
+ * @brief Look up a step kernel supported by this CPU
+ * @param name Kernel name as given by the @kernel key, or KERNEL_AUTO
+ * @return Kernel descriptor, or NULL if unknown or unsupported
+ */
+static const gol_kernel_t *find_kernel(const char *name) {
+    bool pick_best = strcmp(name, KERNEL_AUTO) == 0;
+    
+    for (size_t i = 0; i < sizeof(kernels) / sizeof(kernels[0]); i++) {
+        if ((pick_best || strcmp(kernels[i].name, name) == 0) && kernels[i].supported()) {
+            return &kernels[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * HashLife engine. The universe is an unbounded quadtree of canonical
+ * nodes, each memoizing its RESULT: the centre half of the square advanced
+ * 2^min(step_log, level - 2) generations. The root stays centered on the
+ * origin and the board is the window [0, cols) x [0, rows) onto it, so
+ * cells that leave the board keep evolving outside it.
+ *
+ * Memory is bounded by @hashlife_mem, counting the node blocks, the
+ * canonical table and the block list. A mark-and-sweep collection keeps
+ * what is reachable from the root, first with and then if needed without
+ * memoized results, and frees the blocks it leaves empty. It runs between
+ * steps once the live nodes fill most of the budget, and during a jump
+ * whenever storage would grow past it, then also keeping the nodes of the
+ * RESULT computations in progress. A jump that still does not fit is
+ * abandoned and taken as two jumps of half the size. Loads and edits run
+ * unbounded, as they must fit the board they are given; a load collects
+ * once when done, and a board that alone exceeds the budget is an error.
+ */
+
+/**
+ * @brief Hash the children of a node
+ * @return Hash value, masked by the caller to the bucket count
+ */
+static inline size_t hl_hash(const hl_node_t *nw, const hl_node_t *ne,
+                             const hl_node_t *sw, const hl_node_t *se) {
+    uint64_t h = (uint64_t)(uintptr_t)nw * UINT64_C(0x9E3779B97F4A7C15);
+    h ^= (uint64_t)(uintptr_t)ne * UINT64_C(0xC2B2AE3D27D4EB4F);
+    h ^= (uint64_t)(uintptr_t)sw * UINT64_C(0x165667B19E3779F9);
+    h ^= (uint64_t)(uintptr_t)se * UINT64_C(0x27D4EB2F165667C5);
+    return (size_t)(h ^ (h >> 32));
+}
+
+static bool hl_reclaim(gol_hashlife_t *hl);
+
+/**
+ * @brief Take a node from the free list, or from the current storage block
+ * 
+ * During a jump, storage that would exceed the budget is not allocated;
+ * a collection makes room instead.
+ * 
+ * @param hl HashLife state
+ * @return Uninitialized node, or NULL if a bounded jump ran out of memory
+ */
+static hl_node_t *hl_alloc_node(gol_hashlife_t *hl) {
+    if (hl->free_list) {
+        hl_node_t *node = hl->free_list;
+        hl->free_list = node->next;
+        return node;
+    }
+    
+    if (hl->block_count == 0 || hl->block_used == HASHLIFE_BLOCK_NODES) {
+        size_t capacity = hl->block_capacity;
+        if (hl->block_count == capacity) {
+            capacity = capacity ? 2 * capacity : 16;
+        }
+        size_t grown = HASHLIFE_BLOCK_NODES * sizeof(hl_node_t) +
+                       (capacity - hl->block_capacity) * sizeof(*hl->blocks);
+        if (hl->bounded && hl->memory + grown > hl->memory_budget) {
+            if (!hl_reclaim(hl)) {
+                hl->exhausted = true;
+                return NULL;
+            }
+            hl_node_t *node = hl->free_list;
+            hl->free_list = node->next;
+            return node;
+        }
+        
+        if (capacity != hl->block_capacity) {
+            hl_node_t **blocks = realloc(hl->blocks, capacity * sizeof(*blocks));
+            if (!blocks) {
+                engine_out_of_memory(ENGINE_HASHLIFE);
+            }
+            hl->blocks = blocks;
+            hl->block_capacity = capacity;
+        }
+        
+        hl_node_t *block = malloc(HASHLIFE_BLOCK_NODES * sizeof(hl_node_t));
+        if (!block) {
+            engine_out_of_memory(ENGINE_HASHLIFE);
+        }
+        hl->blocks[hl->block_count++] = block;
+        hl->block_used = 0;
+        hl->memory += grown;
+    }
+    
+    return &hl->blocks[hl->block_count - 1][hl->block_used++];
+}
+
+/**
+ * @brief Double the canonical table and rehash every node
+ * @param hl HashLife state
+ */
+static void hl_grow_table(gol_hashlife_t *hl) {
+    size_t count = 2 * hl->bucket_count;
+    
+    /* Longer chains are slower but still correct */
+    if (hl->bounded && hl->memory + count * sizeof(*hl->buckets) > hl->memory_budget) {
+        return;
+    }
+    hl_node_t **buckets = calloc(count, sizeof(*buckets));
+    if (!buckets) {
+        return;
+    }
+    
+    for (size_t i = 0; i < hl->bucket_count; i++) {
+        hl_node_t *node = hl->buckets[i];
+        while (node) {
+            hl_node_t *next = node->next;
+            size_t h = hl_hash(node->nw, node->ne, node->sw, node->se) & (count - 1);
+            node->next = buckets[h];
+            buckets[h] = node;
+            node = next;
+        }
+    }
+    
+    free(hl->buckets);
+    hl->memory += (count - hl->bucket_count) * sizeof(*buckets);
+    hl->buckets = buckets;
+    hl->bucket_count = count;
+}
+
+/**
+ * @brief Get the canonical node with the given children, creating it if needed
+ * @param hl HashLife state
+ * @param nw North-west child
+ * @param ne North-east child
+ * @param sw South-west child
+ * @param se South-east child
+ * @return Node one level above the children, or NULL if a bounded jump ran out
+ *         of memory
+ */
+static hl_node_t *hl_find(gol_hashlife_t *hl, hl_node_t *nw, hl_node_t *ne,
+                          hl_node_t *sw, hl_node_t *se) {
+    size_t h = hl_hash(nw, ne, sw, se) & (hl->bucket_count - 1);
+    
+    for (hl_node_t *node = hl->buckets[h]; node; node = node->next) {
+        if (node->nw == nw && node->ne == ne && node->sw == sw && node->se == se) {
+            return node;
+        }
+    }
+    
+    /* A collection to make room must keep the children */
+    hl_frame_t frame = { .parent = hl->frames, .nodes = { nw, ne, sw, se } };
+    hl->frames = &frame;
+    hl_node_t *node = hl_alloc_node(hl);
+    hl->frames = frame.parent;
+    if (!node) {
+        return NULL;
+    }
+    node->nw = nw;
+    node->ne = ne;
+    node->sw = sw;
+    node->se = se;
+    node->result = NULL;
+    node->population = nw->population + ne->population + sw->population + se->population;
+    node->level = (uint8_t)(nw->level + 1);
+    node->marked = 0;
+    node->bits = nw->level == 0
+                 ? (uint8_t)(nw->population | ne->population << 1 |
+                             sw->population << 2 | se->population << 3)
+                 : 0;
+    node->next = hl->buckets[h];
+    hl->buckets[h] = node;
+    
+    if (++hl->node_count > hl->bucket_count) {
+        hl_grow_table(hl);
+    }
+    return node;
+}
+
+/**
+ * @brief Surround a node with empty space, doubling it around the same centre
+ * @param hl HashLife state
+ * @param node Node of level >= 1
+ * @return Node one level up whose centre half is the given node, or NULL if a
+ *         bounded jump ran out of memory
+ */
+static hl_node_t *hl_expand(gol_hashlife_t *hl, hl_node_t *node) {
+    if (node->level >= HASHLIFE_MAX_LEVEL) {
+        fprintf(stderr, "Error: HashLife universe exceeded 2^%d cells across\n",
+                HASHLIFE_MAX_LEVEL);
+        exit(GOL_ERROR_MEMORY);
+    }
+    
+    hl_node_t *border = hl->empty[node->level - 1];
+    hl_frame_t frame = { .parent = hl->frames, .nodes = { node } };
+    hl_node_t **quarter = frame.nodes + 1;
+    hl->frames = &frame;
+    quarter[0] = hl_find(hl, border, border, border, node->nw);
+    quarter[1] = hl_find(hl, border, border, node->ne, border);
+    quarter[2] = hl_find(hl, border, node->sw, border, border);
+    quarter[3] = hl_find(hl, node->se, border, border, border);
+    hl->frames = frame.parent;
+    if (hl->exhausted) {
+        return NULL;
+    }
+    return hl_find(hl, quarter[0], quarter[1], quarter[2], quarter[3]);
+}
+
+/**
+ * @brief Get the centre half of a node without advancing it
+ * @param hl HashLife state
+ * @param node Node of level >= 2
+ * @return Centre node, one level down, or NULL if a bounded jump ran out of memory
+ */
+static hl_node_t *hl_centre(gol_hashlife_t *hl, hl_node_t *node) {
+    return hl_find(hl, node->nw->se, node->ne->sw, node->sw->ne, node->se->nw);
+}
+
+/**
+ * @brief Spread a level 1 code over its 2x2 corner of a 4x4 index
+ * @param code Level 1 code: nw | ne << 1 | sw << 2 | se << 3
+ * @return Bits 0, 1, 4 and 5 of a 4x4 index, where bit y * 4 + x is cell (x, y)
+ */
+static inline unsigned int hl_quad_bits(unsigned int code) {
+    return (code & 3u) | ((code & 12u) << 2);
+}
+
+/**
+ * @brief Compute or recall the RESULT of a node
+ * 
+ * If a bounded jump runs out of memory, every caller up the recursion
+ * returns NULL; the results finished before that stay memoized.
+ * 
+ * @param hl HashLife state
+ * @param node Node of level >= 2
+ * @return Centre half of the node advanced 2^min(step_log, level - 2)
+ *         generations, or NULL if the jump ran out of memory
+ */
+static hl_node_t *hl_result(gol_hashlife_t *hl, hl_node_t *node) {
+    if (node->result) {
+        return node->result;
+    }
+    
+    hl_node_t *result;
+    if (node->population == 0) {
+        result = hl->empty[node->level - 1];
+    } else if (node->level == 2) {
+        /* 4x4 base case: one generation by table lookup */
+        unsigned int index = hl_quad_bits(node->nw->bits) |
+                             hl_quad_bits(node->ne->bits) << 2 |
+                             hl_quad_bits(node->sw->bits) << 8 |
+                             hl_quad_bits(node->se->bits) << 10;
+        result = hl->level1[hl->lut[index]];
+    } else {
+        hl_node_t *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+        hl_frame_t frame = { .parent = hl->frames, .nodes = { node } };
+        hl_node_t **sub = frame.nodes + 1, **quarter = frame.nodes + 10;
+        hl->frames = &frame;
+        
+        /* Nine overlapping squares one level down, three by three */
+        sub[0] = nw;
+        sub[2] = ne;
+        sub[6] = sw;
+        sub[8] = se;
+        sub[1] = hl_find(hl, nw->ne, ne->nw, nw->se, ne->sw);
+        sub[3] = hl_find(hl, nw->sw, nw->se, sw->nw, sw->ne);
+        sub[4] = hl_find(hl, nw->se, ne->sw, sw->ne, se->nw);
+        sub[5] = hl_find(hl, ne->sw, ne->se, se->nw, se->ne);
+        sub[7] = hl_find(hl, sw->ne, se->nw, sw->se, se->sw);
+        
+        /*
+         * Two stages of half the step each. Below full speed the step is
+         * smaller than the node allows, so the first stage only recentres.
+         */
+        bool full_speed = hl->step_log + 2 >= node->level;
+        for (size_t i = 0; i < 9 && !hl->exhausted; i++) {
+            sub[i] = full_speed ? hl_result(hl, sub[i]) : hl_centre(hl, sub[i]);
+        }
+        
+        /* Each quarter of the result comes from four of the nine squares */
+        static const uint8_t quarters[4][4] = {
+            { 0, 1, 3, 4 }, { 1, 2, 4, 5 }, { 3, 4, 6, 7 }, { 4, 5, 7, 8 }
+        };
+        for (size_t q = 0; q < 4 && !hl->exhausted; q++) {
+            const uint8_t *k = quarters[q];
+            quarter[q] = hl_find(hl, sub[k[0]], sub[k[1]], sub[k[2]], sub[k[3]]);
+            if (quarter[q]) {
+                quarter[q] = hl_result(hl, quarter[q]);
+            }
+        }
+        
+        result = hl->exhausted ? NULL
+                               : hl_find(hl, quarter[0], quarter[1], quarter[2], quarter[3]);
+        hl->frames = frame.parent;
+        if (!result) {
+            return NULL;
+        }
+    }
+    
+    node->result = result;
+    return result;
+}
+
+/**
+ * @brief Change the step size, forgetting only the results it affects
+ * @param hl HashLife state
+ * @param step_log New log2 of generations per RESULT
+ */
+static void hl_set_step(gol_hashlife_t *hl, unsigned int step_log) {
+    if (step_log == hl->step_log) {
+        return;
+    }
+    
+    /* A node of level k advances 2^min(step_log, k - 2): small nodes are unaffected */
+    unsigned int keep = (step_log < hl->step_log ? step_log : hl->step_log) + 2;
+    for (size_t i = 0; i < hl->bucket_count; i++) {
+        for (hl_node_t *node = hl->buckets[i]; node; node = node->next) {
+            if (node->level > keep) {
+                node->result = NULL;
+            }
+        }
+    }
+    hl->step_log = step_log;
+}
+
+/**
+ * @brief Mark a node and everything it references as reachable
+ * @param node Node to mark
+ * @param keep_results Whether memoized results are kept alive too
+ */
+static void hl_mark(hl_node_t *node, bool keep_results) {
+    if (node->level == 0 || node->marked) {
+        return;
+    }
+    
+    node->marked = 1;
+    hl_mark(node->nw, keep_results);
+    hl_mark(node->ne, keep_results);
+    hl_mark(node->sw, keep_results);
+    hl_mark(node->se, keep_results);
+    if (keep_results && node->result) {
+        hl_mark(node->result, keep_results);
+    }
+}
+
+/**
+ * @brief Run one mark-and-sweep pass over the canonical table
+ * @param hl HashLife state
+ * @param keep_results Whether memoized results survive the pass
+ */
+static void hl_sweep(gol_hashlife_t *hl, bool keep_results) {
+    if (!keep_results) {
+        for (size_t i = 0; i < hl->bucket_count; i++) {
+            for (hl_node_t *node = hl->buckets[i]; node; node = node->next) {
+                node->result = NULL;
+            }
+        }
+    }
+    
+    hl_mark(hl->root, keep_results);
+    for (unsigned int level = 1; level <= HASHLIFE_MAX_LEVEL; level++) {
+        hl_mark(hl->empty[level], keep_results);
+    }
+    for (unsigned int code = 0; code < 16; code++) {
+        hl_mark(hl->level1[code], keep_results);
+    }
+    for (const hl_frame_t *frame = hl->frames; frame; frame = frame->parent) {
+        for (size_t i = 0; i < sizeof(frame->nodes) / sizeof(frame->nodes[0]); i++) {
+            if (frame->nodes[i]) {
+                hl_mark(frame->nodes[i], keep_results);
+            }
+        }
+    }
+    
+    /*
+     * Rebuild the table and the free list from the blocks, so that blocks
+     * left without a live node can be freed. The last block is kept, as
+     * new nodes are handed out from it.
+     */
+    memset(hl->buckets, 0, hl->bucket_count * sizeof(*hl->buckets));
+    hl->free_list = NULL;
+    hl->node_count = 0;
+    size_t kept = 0;
+    for (size_t b = 0; b < hl->block_count; b++) {
+        hl_node_t *block = hl->blocks[b];
+        bool last = b + 1 == hl->block_count;
+        size_t used = last ? hl->block_used : HASHLIFE_BLOCK_NODES;
+        hl_node_t *free_list = hl->free_list;
+        size_t live = 0;
+        
+        for (size_t i = 0; i < used; i++) {
+            hl_node_t *node = &block[i];
+            if (node->marked) {
+                size_t h = hl_hash(node->nw, node->ne, node->sw, node->se) &
+                           (hl->bucket_count - 1);
+                node->marked = 0;
+                node->next = hl->buckets[h];
+                hl->buckets[h] = node;
+                live++;
+            } else {
+                node->next = free_list;
+                free_list = node;
+            }
+        }
+        
+        if (live == 0 && !last) {
+            free(block);
+            hl->memory -= HASHLIFE_BLOCK_NODES * sizeof(hl_node_t);
+            continue;
+        }
+        hl->free_list = free_list;
+        hl->node_count += live;
+        hl->blocks[kept++] = block;
+    }
+    hl->block_count = kept;
+}
+
+/**
+ * @brief Get the bytes that the live nodes and the table take up
+ * @param hl HashLife state
+ * @return Bytes of the nodes in the table, the buckets and the block list
+ */
+static inline size_t hl_live_memory(const gol_hashlife_t *hl) {
+    return hl->node_count * sizeof(hl_node_t) + hl->bucket_count * sizeof(*hl->buckets) +
+           hl->block_capacity * sizeof(*hl->blocks);
+}
+
+/**
+ * @brief Collect unreachable nodes once they fill most of the budget
+ * @param hl HashLife state
+ * @param force Collect even below the threshold, as when a jump ran out of memory
+ */
+static void hl_collect(gol_hashlife_t *hl, bool force) {
+    if (!force && hl_live_memory(hl) <= hl->memory_budget / 4 * 3) {
+        return;
+    }
+    
+    /* Keeping results is cheap to retry; drop them only if that was not enough */
+    hl_sweep(hl, true);
+    if (hl_live_memory(hl) > hl->memory_budget / 2) {
+        hl_sweep(hl, false);
+    }
+}
+
+/**
+ * @brief Collect after a load and check that the board fits the budget
+ * @param hl HashLife state
+ * @return true if the nodes reachable from the root fit in @hashlife_mem
+ */
+static bool hl_fits(gol_hashlife_t *hl) {
+    hl_collect(hl, false);
+    return hl_live_memory(hl) <= hl->memory_budget;
+}
+
+/**
+ * @brief Collect during a jump to make room for more nodes
+ * 
+ * Gives up when less than a quarter of the stored nodes could be freed,
+ * as the jump would then spend its time collecting.
+ * 
+ * @param hl HashLife state, in a bounded jump
+ * @return true if the free list has room
+ */
+static bool hl_reclaim(gol_hashlife_t *hl) {
+    hl_collect(hl, true);
+    size_t stored = hl->block_count * HASHLIFE_BLOCK_NODES -
+                    (HASHLIFE_BLOCK_NODES - hl->block_used);
+    return hl->free_list && (stored - hl->node_count) * 4 >= stored;
+}
+
+/**
+ * @brief Pad the root and compute its RESULT within the budget
+ * @param hl HashLife state
+ * @return Root advanced 2^step_log generations, or NULL if the budget ran out
+ */
+static hl_node_t *hl_try_jump(gol_hashlife_t *hl) {
+    hl->exhausted = false;
+    
+    /* Pad until nothing can reach the edge of the RESULT during the jump */
+    for (;;) {
+        hl_node_t *root = hl->root;
+        if (root->level >= hl->step_log + 3 &&
+            root->nw->se->se->population + root->ne->sw->sw->population +
+            root->sw->ne->ne->population + root->se->nw->nw->population == root->population) {
+            break;
+        }
+        root = hl_expand(hl, root);
+        if (!root) {
+            return NULL;
+        }
+        hl->root = root;
+    }
+    
+    return hl_result(hl, hl->root);
+}
+
+/**
+ * @brief Advance the root by 2^step_log generations within @hashlife_mem
+ * 
+ * A jump that does not fit even with collections along the way is taken
+ * as two jumps of half the size.
+ * 
+ * @param hl HashLife state
+ */
+static void hl_jump(gol_hashlife_t *hl) {
+    hl->bounded = true;
+    hl_node_t *result = hl_try_jump(hl);
+    hl->bounded = false;
+    hl->exhausted = false;
+    
+    if (result) {
+        hl->root = result;
+        hl_collect(hl, false);
+        return;
+    }
+    
+    if (hl->step_log == 0) {
+        fprintf(stderr, "Error: One HashLife generation needs more than @hashlife_mem "
+                "(%zu MiB)\n", hl->memory_budget >> 20);
+        exit(GOL_ERROR_MEMORY);
+    }
+    unsigned int step_log = hl->step_log;
+    hl_collect(hl, true);
+    hl_set_step(hl, step_log - 1);
+    hl_jump(hl);
+    hl_jump(hl);
+    hl_set_step(hl, step_log);
+}
+
+/**
+ * @brief Get the half size of the root, which is also the offset of board cell (0, 0)
+ * @param hl HashLife state
+ * @return 2^(root level - 1)
+ */
+static inline uint64_t hl_root_half(const gol_hashlife_t *hl) {
+    return UINT64_C(1) << (hl->root->level - 1);
+}
+
+/**
+ * @brief Return a node with one cell changed
+ * @param hl HashLife state
+ * @param node Node containing the cell
+ * @param x Column relative to the node's top-left corner
+ * @param y Row relative to the node's top-left corner
+ * @param alive New cell state
+ * @return Canonical node with the cell set
+ */
+static hl_node_t *hl_node_set(gol_hashlife_t *hl, hl_node_t *node, uint64_t x, uint64_t y,
+                              bool alive) {
+    if (node->level == 0) {
+        return &hl->leaf[alive];
+    }
+    
+    uint64_t half = UINT64_C(1) << (node->level - 1);
+    hl_node_t *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+    if (y < half) {
+        if (x < half) nw = hl_node_set(hl, nw, x, y, alive);
+        else ne = hl_node_set(hl, ne, x - half, y, alive);
+    } else {
+        if (x < half) sw = hl_node_set(hl, sw, x, y - half, alive);
+        else se = hl_node_set(hl, se, x - half, y - half, alive);
+    }
+    return hl_find(hl, nw, ne, sw, se);
+}
+
+/**
+ * @brief Build the node for a square of the board from packed rows
+ * 
+ * Squares outside the board, and 64x64 squares whose words are all zero,
+ * are taken from the empty nodes without visiting their cells.
+ * 
+ * @param hl HashLife state
+ * @param ctx Game context, for the board size
+ * @param rows Input, laid out as in write_board_rows()
+ * @param words_per_row Words between input rows
+ * @param x Board column of the square's top-left corner
+ * @param y Board row of the square's top-left corner
+ * @param level log2 of the square's side, >= 1
+ * @return Canonical node holding the square
+ */
+static hl_node_t *hl_build_rows(gol_hashlife_t *hl, const gol_context_t *ctx,
+                                const uint64_t *rows, size_t words_per_row, size_t x, size_t y,
+                                unsigned int level) {
+    if (x >= ctx->cols || y >= ctx->rows) {
+        return hl->empty[level];
+    }
+    
+    if (level == 1) {
+        unsigned int code = 0;
+        for (unsigned int k = 0; k < 4; k++) {
+            size_t col = x + (k & 1), row = y + (k >> 1);
+            if (col < ctx->cols && row < ctx->rows) {
+                uint64_t word = rows[row * words_per_row + col / CELLS_PER_WORD];
+                code |= (unsigned int)((word >> (col % CELLS_PER_WORD)) & 1) << k;
+            }
+        }
+        return hl->level1[code];
+    }
+    
+    if (level == 6) {
+        /* The square is one word wide */
+        size_t end = y + CELLS_PER_WORD < ctx->rows ? y + CELLS_PER_WORD : ctx->rows;
+        size_t w = x / CELLS_PER_WORD;
+        uint64_t any = 0;
+        for (size_t row = y; row < end; row++) {
+            any |= rows[row * words_per_row + w];
+        }
+        if (!any) {
+            return hl->empty[level];
+        }
+    }
+    
+    size_t half = (size_t)1 << (level - 1);
+    hl_node_t *nw = hl_build_rows(hl, ctx, rows, words_per_row, x, y, level - 1);
+    hl_node_t *ne = hl_build_rows(hl, ctx, rows, words_per_row, x + half, y, level - 1);
+    hl_node_t *sw = hl_build_rows(hl, ctx, rows, words_per_row, x, y + half, level - 1);
+    hl_node_t *se = hl_build_rows(hl, ctx, rows, words_per_row, x + half, y + half, level - 1);
+    return hl_find(hl, nw, ne, sw, se);
+}
+
+/**
+ * @brief Count the live cells of a node that fall inside the board
+ * @param node Node to count
+ * @param x Column of the node's top-left corner, in board coordinates
+ * @param y Row of the node's top-left corner, in board coordinates
+ * @param rows Board height
+ * @param cols Board width
+ * @return Live cells inside [0, cols) x [0, rows)
+ */
+static uint64_t hl_node_count(const hl_node_t *node, int64_t x, int64_t y,
+                              int64_t rows, int64_t cols) {
+    int64_t size = INT64_C(1) << node->level;
+    if (node->population == 0 || x >= cols || y >= rows || x + size <= 0 || y + size <= 0) {
+        return 0;
+    }
+    if (x >= 0 && y >= 0 && x + size <= cols && y + size <= rows) {
+        return node->population;
+    }
+    
+    int64_t half = size / 2;
+    return hl_node_count(node->nw, x, y, rows, cols) +
+           hl_node_count(node->ne, x + half, y, rows, cols) +
+           hl_node_count(node->sw, x, y + half, rows, cols) +
+           hl_node_count(node->se, x + half, y + half, rows, cols);
+}
+
+/**
+ * @brief Paint the live cells of a node that fall inside a region
+ * @param node Node to paint
+ * @param x Column of the node's top-left corner, relative to the region
+ * @param y Row of the node's top-left corner, relative to the region
+ * @param region Region being drawn
+ * @param pixels Region pixels, already cleared to DEAD_COLOR
+ * @param pitch Pixels per row
+ */
+static void hl_node_draw(const hl_node_t *node, int64_t x, int64_t y,
+                         const gol_region_t *region, uint32_t *pixels, size_t pitch) {
+    int64_t size = INT64_C(1) << node->level;
+    if (node->population == 0 || x >= (int64_t)region->cols || y >= (int64_t)region->rows ||
+        x + size <= 0 || y + size <= 0) {
+        return;
+    }
+    if (node->level == 0) {
+        pixels[(size_t)y * pitch + (size_t)x] = ALIVE_COLOR;
+        return;
+    }
+    
+    int64_t half = size / 2;
+    hl_node_draw(node->nw, x, y, region, pixels, pitch);
+    hl_node_draw(node->ne, x + half, y, region, pixels, pitch);
+    hl_node_draw(node->sw, x, y + half, region, pixels, pitch);
+    hl_node_draw(node->se, x + half, y + half, region, pixels, pitch);
+}
+
+/**
+ * @brief Paint the blocks of a region that hold live cells of a node
+ * 
+ * A populated node lying inside the board and inside one block lights
+ * that block without visiting its cells, so the walk stops at most
+ * `level` levels above the leaves, and sooner where a block is already lit.
+ * 
+ * @param node Node to paint
+ * @param x Column of the node's top-left corner, in board coordinates
+ * @param y Row of the node's top-left corner, in board coordinates
+ * @param ctx Game context, for the board size
+ * @param blocks Region of blocks being drawn
+ * @param level log2 of cells per block side
+ * @param pixels Region pixels, already cleared to DEAD_COLOR
+ * @param pitch Pixels per row
+ */
+static void hl_node_draw_blocks(const hl_node_t *node, int64_t x, int64_t y,
+                                const gol_context_t *ctx, const gol_region_t *blocks,
+                                unsigned int level, uint32_t *pixels, size_t pitch) {
+    int64_t size = INT64_C(1) << node->level;
+    int64_t col_begin = (int64_t)(blocks->col << level);
+    int64_t row_begin = (int64_t)(blocks->row << level);
+    int64_t col_end = (int64_t)((blocks->col + blocks->cols) << level);
+    int64_t row_end = (int64_t)((blocks->row + blocks->rows) << level);
+    if (col_end > (int64_t)ctx->cols) col_end = (int64_t)ctx->cols;
+    if (row_end > (int64_t)ctx->rows) row_end = (int64_t)ctx->rows;
+    if (node->population == 0 || x >= col_end || y >= row_end ||
+        x + size <= col_begin || y + size <= row_begin) {
+        return;
+    }
+    
+    /* Nodes straddling the board edge are split until their cells are inside or out */
+    if (x >= 0 && y >= 0 && (x >> level) == ((x + size - 1) >> level) &&
+        (y >> level) == ((y + size - 1) >> level)) {
+        uint32_t *pixel = pixels + ((size_t)(y >> level) - blocks->row) * pitch +
+                          ((size_t)(x >> level) - blocks->col);
+        if (*pixel == ALIVE_COLOR) {
+            return;
+        }
+        if (x + size <= (int64_t)ctx->cols && y + size <= (int64_t)ctx->rows) {
+            *pixel = ALIVE_COLOR;
+            return;
+        }
+    }
+    
+    int64_t half = size / 2;
+    hl_node_draw_blocks(node->nw, x, y, ctx, blocks, level, pixels, pitch);
+    hl_node_draw_blocks(node->ne, x + half, y, ctx, blocks, level, pixels, pitch);
+    hl_node_draw_blocks(node->sw, x, y + half, ctx, blocks, level, pixels, pitch);
+    hl_node_draw_blocks(node->se, x + half, y + half, ctx, blocks, level, pixels, pitch);
+}
+
+/**
+ * @brief Create a node store holding an empty universe
+ * @param step_log Initial log2 of generations per RESULT
+ * @param mem_mb Memory budget of jumps in MiB
+ * @return New HashLife state, or NULL on allocation failure
+ */
+static gol_hashlife_t *hl_create(const gol_rule_t *rule, unsigned int step_log,
+                                 unsigned int mem_mb) {
+    gol_hashlife_t *hl = calloc(1, sizeof(*hl));
+    if (!hl) {
+        return NULL;
+    }
+    
+    hl->bucket_count = HASHLIFE_INITIAL_BUCKETS;
+    hl->buckets = calloc(hl->bucket_count, sizeof(*hl->buckets));
+    if (!hl->buckets) {
+        free(hl);
+        return NULL;
+    }
+    hl->memory = hl->bucket_count * sizeof(*hl->buckets);
+    hl->memory_budget = (size_t)mem_mb * 1024 * 1024;
+    
+    hl->leaf[CELL_ALIVE].population = 1;
+    hl->empty[0] = &hl->leaf[CELL_DEAD];
+    for (unsigned int level = 1; level <= HASHLIFE_MAX_LEVEL; level++) {
+        hl_node_t *child = hl->empty[level - 1];
+        hl->empty[level] = hl_find(hl, child, child, child, child);
+    }
+    for (unsigned int code = 0; code < 16; code++) {
+        hl->level1[code] = hl_find(hl, &hl->leaf[code & 1], &hl->leaf[(code >> 1) & 1],
+                                   &hl->leaf[(code >> 2) & 1], &hl->leaf[(code >> 3) & 1]);
+    }
+    
+    /* Next state of the centre 2x2 of every 4x4 square */
+    for (unsigned int index = 0; index < (1u << 16); index++) {
+        unsigned int code = 0;
+        for (unsigned int k = 0; k < 4; k++) {
+            unsigned int cx = 1 + (k & 1), cy = 1 + (k >> 1);
+            unsigned int neighbors = 0;
+            for (unsigned int y = cy - 1; y <= cy + 1; y++) {
+                for (unsigned int x = cx - 1; x <= cx + 1; x++) {
+                    if (x != cx || y != cy) {
+                        neighbors += (index >> (y * 4 + x)) & 1;
+                    }
+                }
+            }
+            unsigned int alive = (index >> (cy * 4 + cx)) & 1;
+            code |= (unsigned int)rule->next[alive][neighbors] << k;
+        }
+        hl->lut[index] = (uint8_t)code;
+    }
+    
+    hl->root = hl->empty[HASHLIFE_MIN_LEVEL];
+    hl->step_log = step_log;
+    return hl;
+}
+
+/**
+ * @brief Free a node store and everything in it
+ * @param hl HashLife state, may be NULL
+ */
+static void hl_destroy(gol_hashlife_t *hl) {
+    if (!hl) {
+        return;
+    }
+    
+    for (size_t i = 0; i < hl->block_count; i++) {
+        free(hl->blocks[i]);
+    }
+    free(hl->blocks);
+    free(hl->buckets);
+    free(hl);
+}
+
+/**
+ * @brief Allocate the HashLife node store and an empty universe
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t hashlife_allocate(gol_context_t *ctx) {
+    ctx->hashlife = hl_create(&ctx->config.rule, ctx->config.hashlife_step,
+                              ctx->config.hashlife_mem_mb);
+    if (!ctx->hashlife) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    ctx->step_generations = UINT64_C(1) << ctx->hashlife->step_log;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Free the HashLife node store
+ * @param ctx Game context
+ */
+static void hashlife_deallocate(gol_context_t *ctx) {
+    hl_destroy(ctx->hashlife);
+    ctx->hashlife = NULL;
+}
+
+/**
+ * @brief Advance the universe by 2^@hashlife_step generations
+ * @param ctx Game context
+ */
+static void hashlife_step(gol_context_t *ctx) {
+    hl_jump(ctx->hashlife);
+    ctx->stats.population = ctx->hashlife->root->population;
+}
+
+/**
+ * @brief Advance the universe by an exact number of generations
+ * 
+ * The count is split into powers of two, largest first, each taken as a
+ * single jump; the configured step size is restored afterwards.
+ * 
+ * @param ctx Game context
+ * @param generations Generations to advance
+ */
+static void hashlife_advance(gol_context_t *ctx, uint64_t generations) {
+    gol_hashlife_t *hl = ctx->hashlife;
+    const unsigned int max_step = HASHLIFE_MAX_LEVEL - 3;
+    
+    for (unsigned int bit = 64; bit-- > 0;) {
+        if (!((generations >> bit) & 1)) {
+            continue;
+        }
+        
+        /* Powers beyond the largest jump are taken as repeated largest jumps */
+        unsigned int step_log = bit < max_step ? bit : max_step;
+        hl_set_step(hl, step_log);
+        for (uint64_t i = 0; i < (UINT64_C(1) << (bit - step_log)); i++) {
+            hl_jump(hl);
+        }
+    }
+    
+    hl_set_step(hl, ctx->config.hashlife_step);
+    ctx->stats.population = hl->root->population;
+}
+
+/**
+ * @brief Get the state of a cell of the board window
+ * @param ctx Game context
+ * @param row Row index
+ * @param col Column index
+ * @return true if alive, false if dead
+ */
+static bool hashlife_get_cell(const gol_context_t *ctx, size_t row, size_t col) {
+    const gol_hashlife_t *hl = ctx->hashlife;
+    uint64_t half = hl_root_half(hl);
+    if (row >= half || col >= half) {
+        return false;
+    }
+    
+    const hl_node_t *node = hl->root;
+    uint64_t x = col + half, y = row + half;
+    while (node->level > 0) {
+        half = UINT64_C(1) << (node->level - 1);
+        if (y < half) {
+            node = x < half ? node->nw : node->ne;
+        } else {
+            node = x < half ? node->sw : node->se;
+            y -= half;
+        }
+        if (x >= half) x -= half;
+    }
+    return node->population != 0;
+}
+
+/**
+ * @brief Set the state of a cell of the board window
+ * @param ctx Game context
+ * @param row Row index
+ * @param col Column index
+ * @param alive New cell state
+ */
+static void hashlife_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive) {
+    gol_hashlife_t *hl = ctx->hashlife;
+    if (hashlife_get_cell(ctx, row, col) == alive) {
+        return;
+    }
+    
+    while (row >= hl_root_half(hl) || col >= hl_root_half(hl)) {
+        hl->root = hl_expand(hl, hl->root);
+    }
+    
+    uint64_t half = hl_root_half(hl);
+    hl->root = hl_node_set(hl, hl->root, col + half, row + half, alive);
+}
+
+/**
+ * @brief Count the live cells inside the board window
+ * @param ctx Game context
+ * @return Number of alive cells
+ */
+static uint64_t hashlife_count_alive(const gol_context_t *ctx) {
+    const gol_hashlife_t *hl = ctx->hashlife;
+    int64_t origin = -(int64_t)hl_root_half(hl);
+    
+    return hl_node_count(hl->root, origin, origin, (int64_t)ctx->rows, (int64_t)ctx->cols);
+}
+
+/**
+ * @brief Empty the whole universe, including cells outside the board
+ * @param ctx Game context
+ */
+static void hashlife_clear(gol_context_t *ctx) {
+    gol_hashlife_t *hl = ctx->hashlife;
+    
+    hl->root = hl->empty[HASHLIFE_MIN_LEVEL];
+    hl_collect(hl, false);
+}
+
+/**
+ * @brief Draw a region of the board window as ARGB8888 pixels
+ * @param ctx Game context
+ * @param region Region of cells to draw
+ * @param pixels Output pixels for the region's top-left cell
+ * @param pitch Pixels per output row
+ */
+static void hashlife_draw(const gol_context_t *ctx, const gol_region_t *region,
+                          uint32_t *pixels, size_t pitch) {
+    const gol_hashlife_t *hl = ctx->hashlife;
+    
+    for (size_t i = 0; i < region->rows; i++) {
+        for (size_t j = 0; j < region->cols; j++) {
+            pixels[i * pitch + j] = DEAD_COLOR;
+        }
+    }
+    
+    /* Only populated nodes are visited, so sparse boards draw quickly */
+    int64_t origin = -(int64_t)hl_root_half(hl);
+    hl_node_draw(hl->root, origin - (int64_t)region->col, origin - (int64_t)region->row,
+                 region, pixels, pitch);
+}
+
+/**
+ * @brief Draw blocks of cells, one pixel per block, alive if any of its cells is
+ * @param ctx Game context
+ * @param blocks Region of blocks to draw
+ * @param level log2 of cells per block side
+ * @param pixels Destination for the region's top-left block
+ * @param pitch Distance between destination rows, in pixels
+ * @return true
+ */
+static bool hashlife_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                                 unsigned int level, uint32_t *pixels, size_t pitch) {
+    const gol_hashlife_t *hl = ctx->hashlife;
+    
+    for (size_t i = 0; i < blocks->rows; i++) {
+        for (size_t j = 0; j < blocks->cols; j++) {
+            pixels[i * pitch + j] = DEAD_COLOR;
+        }
+    }
+    
+    int64_t origin = -(int64_t)hl_root_half(hl);
+    hl_node_draw_blocks(hl->root, origin, origin, ctx, blocks, level, pixels, pitch);
+    return true;
+}
+
+/**
+ * @brief Replace the universe with the board given as packed rows
+ * 
+ * The quadtree is built bottom-up in one pass instead of one set_cell()
+ * per live cell. The board becomes the south-east quarter of the new root.
+ * 
+ * @param ctx Game context
+ * @param rows Input, laid out as in write_board_rows()
+ * @param words_per_row Words between input rows
+ */
+static void hashlife_write_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row) {
+    gol_hashlife_t *hl = ctx->hashlife;
+    size_t side = ctx->rows > ctx->cols ? ctx->rows : ctx->cols;
+    unsigned int level = HASHLIFE_MIN_LEVEL - 1;
+    while (((size_t)1 << level) < side) {
+        level++;
+    }
+    
+    hl_node_t *board = hl_build_rows(hl, ctx, rows, words_per_row, 0, 0, level);
+    hl_node_t *empty = hl->empty[level];
+    hl->root = hl_find(hl, empty, empty, empty, board);
+}
+
+/*
+ * Sparse engine: the universe is unbounded and only tiles near live cells
+ * are stored, in a hash map keyed on tile coordinates. Each generation
+ * visits the live tiles and the neighbors their edge cells can reach, so
+ * its cost follows the population. Tiles use the packed row layout and
+ * share packed_next_word(). As with HashLife, the board is the window
+ * [0, cols) x [0, rows) onto the universe.
+ */
+
+/**
+ * @brief Hash tile coordinates
+ * @param x Tile column
+ * @param y Tile row
+ * @return Hash value, masked by the caller to the slot count
+ */
+static inline size_t sparse_hash(int64_t x, int64_t y) {
+    uint64_t h = (uint64_t)x * UINT64_C(0x9E3779B97F4A7C15) ^
+                 (uint64_t)y * UINT64_C(0xC2B2AE3D27D4EB4F);
+    return (size_t)(h ^ (h >> 32));
+}
+
+/**
+ * @brief Find the slot of a tile, or the empty slot where it would go
+ * @param map Tile map
+ * @param x Tile column
+ * @param y Tile row
+ * @return Slot index
+ */
+static size_t sparse_map_slot(const gol_sparse_map_t *map, int64_t x, int64_t y) {
+    size_t mask = map->slot_count - 1;
+    size_t slot = sparse_hash(x, y) & mask;
+    
+    while (map->slots[slot]) {
+        const gol_sparse_tile_t *tile = &map->tiles[map->slots[slot] - 1];
+        if (tile->x == x && tile->y == y) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+/**
+ * @brief Look up a tile
+ * @param map Tile map
+ * @param x Tile column
+ * @param y Tile row
+ * @return Tile, or NULL if it is not stored
+ */
+static gol_sparse_tile_t *sparse_map_find(const gol_sparse_map_t *map, int64_t x, int64_t y) {
+    size_t index = map->slots[sparse_map_slot(map, x, y)];
+    return index ? &map->tiles[index - 1] : NULL;
+}
+
+/**
+ * @brief Double the slot array and reinsert every tile
+ * @param map Tile map
+ */
+static void sparse_map_grow(gol_sparse_map_t *map) {
+    size_t count = 2 * map->slot_count;
+    size_t *slots = calloc(count, sizeof(*slots));
+    if (!slots) {
+        engine_out_of_memory(ENGINE_SPARSE);
+    }
+    
+    free(map->slots);
+    map->slots = slots;
+    map->slot_count = count;
+    for (size_t i = 0; i < map->count; i++) {
+        map->slots[sparse_map_slot(map, map->tiles[i].x, map->tiles[i].y)] = i + 1;
+    }
+}
+
+/**
+ * @brief Insert a tile that is not stored yet
+ * 
+ * Inserting may move the tile array, so pointers to tiles of this map
+ * are invalidated.
+ * 
+ * @param map Tile map
+ * @param tile Tile contents to copy in
+ * @return Stored tile
+ */
+static gol_sparse_tile_t *sparse_map_insert(gol_sparse_map_t *map, const gol_sparse_tile_t *tile) {
+    if (map->count == map->capacity) {
+        size_t capacity = map->capacity ? 2 * map->capacity : SPARSE_INITIAL_SLOTS / 2;
+        gol_sparse_tile_t *tiles = realloc(map->tiles, capacity * sizeof(*tiles));
+        if (!tiles) {
+            engine_out_of_memory(ENGINE_SPARSE);
+        }
+        map->tiles = tiles;
+        map->capacity = capacity;
+    }
+    if (2 * (map->count + 1) > map->slot_count) {
+        sparse_map_grow(map);
+    }
+    
+    map->tiles[map->count] = *tile;
+    map->slots[sparse_map_slot(map, tile->x, tile->y)] = ++map->count;
+    return &map->tiles[map->count - 1];
+}
+
+/**
+ * @brief Remove every tile, keeping the storage
+ * @param map Tile map
+ */
+static void sparse_map_reset(gol_sparse_map_t *map) {
+    memset(map->slots, 0, map->slot_count * sizeof(*map->slots));
+    map->count = 0;
+}
+
+/**
+ * @brief Compute the next generation of one tile from its 3x3 neighborhood
+ * @param map Map holding the current generation
+ * @param rule Rule to apply
+ * @param x Tile column
+ * @param y Tile row
+ * @param out Next generation of the tile
+ * @param births Incremented by the cells born in the tile
+ * @param deaths Incremented by the cells that died in the tile
+ */
+static void sparse_step_tile(const gol_sparse_map_t *map, const gol_rule_t *rule,
+                             int64_t x, int64_t y, gol_sparse_tile_t *out,
+                             uint64_t *births, uint64_t *deaths) {
+    static const gol_sparse_tile_t empty_tile;
+    const gol_sparse_tile_t *around[3][3];
+    
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            const gol_sparse_tile_t *tile = sparse_map_find(map, x + dx, y + dy);
+            around[dy + 1][dx + 1] = tile ? tile : &empty_tile;
+        }
+    }
+    
+    /* Rows -1..SPARSE_TILE_SIZE, each as west, centre and east words */
+    uint64_t rows[SPARSE_TILE_SIZE + 2][3];
+    for (int c = 0; c < 3; c++) {
+        rows[0][c] = around[0][c]->rows[SPARSE_TILE_SIZE - 1];
+        for (size_t r = 0; r < SPARSE_TILE_SIZE; r++) {
+            rows[r + 1][c] = around[1][c]->rows[r];
+        }
+        rows[SPARSE_TILE_SIZE + 1][c] = around[2][c]->rows[0];
+    }
+    
+    out->x = x;
+    out->y = y;
+    if (!rule->conway) {
+        for (size_t r = 0; r < SPARSE_TILE_SIZE; r++) {
+            rule->packed_row(&rows[r][1], &rows[r + 1][1], &rows[r + 2][1], &out->rows[r], 1,
+                             rule);
+        }
+    }
+    
+    out->population = 0;
+    for (size_t r = 0; r < SPARSE_TILE_SIZE; r++) {
+        uint64_t word = rule->conway
+                        ? packed_next_word(&rows[r][1], &rows[r + 1][1], &rows[r + 2][1])
+                        : out->rows[r];
+        out->rows[r] = word;
+        uint64_t changed = word ^ rows[r + 1][1];
+        out->population += (uint64_t)__builtin_popcountll(word);
+        *births += (uint64_t)__builtin_popcountll(changed & word);
+        *deaths += (uint64_t)__builtin_popcountll(changed & rows[r + 1][1]);
+    }
+}
+
+/**
+ * @brief Allocate the two tile maps of the sparse grid
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t sparse_allocate(gol_context_t *ctx) {
+    gol_sparse_grid_t *grid = &ctx->sparse;
+    
+    for (int i = 0; i < 2; i++) {
+        grid->maps[i].slot_count = SPARSE_INITIAL_SLOTS;
+        grid->maps[i].slots = calloc(SPARSE_INITIAL_SLOTS, sizeof(size_t));
+        if (!grid->maps[i].slots) {
+            sparse_deallocate(ctx);
+            return GOL_ERROR_MEMORY;
+        }
+    }
+    grid->current = 0;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Free the sparse grid
+ * @param ctx Game context
+ */
+static void sparse_deallocate(gol_context_t *ctx) {
+    for (int i = 0; i < 2; i++) {
+        free(ctx->sparse.maps[i].tiles);
+        free(ctx->sparse.maps[i].slots);
+    }
+    memset(&ctx->sparse, 0, sizeof(ctx->sparse));
+}
+
+/**
+ * @brief Simulate one generation of the sparse grid
+ * 
+ * Every live tile is computed, and so is each neighbor that one of its
+ * edge cells touches. Tiles computed empty are still stored for one
+ * generation, which keeps them from being computed twice; they are not
+ * expanded from, so they drop out of the next generation.
+ * 
+ * @param ctx Game context
+ */
+static void sparse_step(gol_context_t *ctx) {
+    gol_sparse_grid_t *grid = &ctx->sparse;
+    const gol_sparse_map_t *current = &grid->maps[grid->current];
+    gol_sparse_map_t *next = &grid->maps[!grid->current];
+    uint64_t births = 0, deaths = 0;
+    
+    sparse_map_reset(next);
+    for (size_t i = 0; i < current->count; i++) {
+        const gol_sparse_tile_t *tile = &current->tiles[i];
+        if (tile->population == 0) {
+            continue;
+        }
+        
+        /* Column 0 and column 63 of every row, as bit masks over rows */
+        uint64_t west = 0, east = 0;
+        for (size_t r = 0; r < SPARSE_TILE_SIZE; r++) {
+            west |= (tile->rows[r] & 1) << r;
+            east |= (tile->rows[r] >> (SPARSE_TILE_SIZE - 1)) << r;
+        }
+        uint64_t north = tile->rows[0];
+        uint64_t south = tile->rows[SPARSE_TILE_SIZE - 1];
+        const uint64_t last = UINT64_C(1) << (SPARSE_TILE_SIZE - 1);
+        
+        /* Neighbor (dx, dy) is reachable if the cells facing it are not all dead */
+        bool reach[3][3] = {
+            { (north & 1) != 0, north != 0, (north & last) != 0 },
+            { west != 0,        true,       east != 0 },
+            { (south & 1) != 0, south != 0, (south & last) != 0 }
+        };
+        
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int64_t x = tile->x + dx, y = tile->y + dy;
+                if (!reach[dy + 1][dx + 1] || sparse_map_find(next, x, y)) {
+                    continue;
+                }
+                
+                gol_sparse_tile_t out;
+                sparse_step_tile(current, &ctx->config.rule, x, y, &out, &births, &deaths);
+                sparse_map_insert(next, &out);
+            }
+        }
+    }
+    
+    grid->current = !grid->current;
+    stats_add_changes(ctx, births, deaths);
+}
+
+/**
+ * @brief Get the state of a cell of the board window
+ * @param ctx Game context
+ * @param row Row index
+ * @param col Column index
+ * @return true if alive, false if dead
+ */
+static bool sparse_get_cell(const gol_context_t *ctx, size_t row, size_t col) {
+    const gol_sparse_map_t *map = &ctx->sparse.maps[ctx->sparse.current];
+    const gol_sparse_tile_t *tile = sparse_map_find(map, (int64_t)(col / SPARSE_TILE_SIZE),
+                                                    (int64_t)(row / SPARSE_TILE_SIZE));
+    
+    return tile && ((tile->rows[row % SPARSE_TILE_SIZE] >> (col % SPARSE_TILE_SIZE)) & 1);
+}
+
+/**
+ * @brief Set the state of a cell of the board window
+ * @param ctx Game context
+ * @param row Row index
+ * @param col Column index
+ * @param alive New cell state
+ */
+static void sparse_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive) {
+    gol_sparse_map_t *map = &ctx->sparse.maps[ctx->sparse.current];
+    int64_t x = (int64_t)(col / SPARSE_TILE_SIZE), y = (int64_t)(row / SPARSE_TILE_SIZE);
+    gol_sparse_tile_t *tile = sparse_map_find(map, x, y);
+    
+    if (!tile) {
+        if (!alive) {
+            return;
+        }
+        gol_sparse_tile_t empty = { .x = x, .y = y };
+        tile = sparse_map_insert(map, &empty);
+    }
+    
+    uint64_t *word = &tile->rows[row % SPARSE_TILE_SIZE];
+    uint64_t bit = UINT64_C(1) << (col % SPARSE_TILE_SIZE);
+    if (((*word & bit) != 0) != alive) {
+        *word ^= bit;
+        tile->population += alive ? 1 : (uint64_t)-1;
+    }
+}
+
+/**
+ * @brief Get the columns of a tile row that fall inside [0, limit)
+ * @param origin First cell coordinate covered by the tile
+ * @param limit Board size along the same axis
+ * @return Bit mask of the covered cells, 0 if none
+ */
+static inline uint64_t sparse_window_mask(int64_t origin, int64_t limit) {
+    int64_t lo = origin < 0 ? -origin : 0;
+    int64_t hi = limit - origin < SPARSE_TILE_SIZE ? limit - origin : SPARSE_TILE_SIZE;
+    if (lo >= hi) {
+        return 0;
+    }
+    
+    uint64_t mask = ~UINT64_C(0) << lo;
+    return hi < SPARSE_TILE_SIZE ? mask & ((UINT64_C(1) << hi) - 1) : mask;
+}
+
+/**
+ * @brief Count the live cells inside the board window
+ * @param ctx Game context
+ * @return Number of alive cells
+ */
+static uint64_t sparse_count_alive(const gol_context_t *ctx) {
+    const gol_sparse_map_t *map = &ctx->sparse.maps[ctx->sparse.current];
+    uint64_t count = 0;
+    
+    for (size_t i = 0; i < map->count; i++) {
+        const gol_sparse_tile_t *tile = &map->tiles[i];
+        uint64_t cols = sparse_window_mask(tile->x * SPARSE_TILE_SIZE, (int64_t)ctx->cols);
+        uint64_t rows = sparse_window_mask(tile->y * SPARSE_TILE_SIZE, (int64_t)ctx->rows);
+        if (tile->population == 0 || !cols || !rows) {
+            continue;
+        }
+        
+        for (size_t r = 0; r < SPARSE_TILE_SIZE; r++) {
+            if ((rows >> r) & 1) {
+                count += (uint64_t)__builtin_popcountll(tile->rows[r] & cols);
+            }
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Empty the whole universe, including cells outside the board
+ * @param ctx Game context
+ */
+static void sparse_clear(gol_context_t *ctx) {
+    sparse_map_reset(&ctx->sparse.maps[ctx->sparse.current]);
+}
+
+/**
+ * @brief Draw a region of the board window as ARGB8888 pixels
+ * @param ctx Game context
+ * @param region Region of cells to draw
+ * @param pixels Output pixels for the region's top-left cell
+ * @param pitch Pixels per output row
+ */
+static void sparse_draw(const gol_context_t *ctx, const gol_region_t *region,
+                        uint32_t *pixels, size_t pitch) {
+    const gol_sparse_map_t *map = &ctx->sparse.maps[ctx->sparse.current];
+    
+    for (size_t i = 0; i < region->rows; i++) {
+        for (size_t j = 0; j < region->cols; j++) {
+            pixels[i * pitch + j] = DEAD_COLOR;
+        }
+    }
+    
+    /* Only stored tiles can hold live cells */
+    for (size_t i = 0; i < map->count; i++) {
+        const gol_sparse_tile_t *tile = &map->tiles[i];
+        int64_t x0 = tile->x * SPARSE_TILE_SIZE - (int64_t)region->col;
+        int64_t y0 = tile->y * SPARSE_TILE_SIZE - (int64_t)region->row;
+        uint64_t cols = sparse_window_mask(x0, (int64_t)region->cols);
+        uint64_t rows = sparse_window_mask(y0, (int64_t)region->rows);
+        if (tile->population == 0 || !cols || !rows) {
+            continue;
+        }
+        
+        for (size_t r = 0; r < SPARSE_TILE_SIZE; r++) {
+            if (!((rows >> r) & 1)) {
+                continue;
+            }
+            
+            uint64_t bits = tile->rows[r] & cols;
+            uint32_t *out = pixels + (size_t)(y0 + (int64_t)r) * pitch;
+            while (bits) {
+                int b = __builtin_ctzll(bits);
+                out[x0 + b] = ALIVE_COLOR;
+                bits &= bits - 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Draw blocks of cells, one pixel per block, alive if any of its cells is
+ * 
+ * Every stored tile is visited once and each of its rows touches one pixel
+ * per live block, so the cost follows the population, not the board area.
+ * 
+ * @param ctx Game context
+ * @param blocks Region of blocks to draw
+ * @param level log2 of cells per block side
+ * @param pixels Destination for the region's top-left block
+ * @param pitch Distance between destination rows, in pixels
+ * @return true
+ */
+static bool sparse_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                               unsigned int level, uint32_t *pixels, size_t pitch) {
+    const gol_sparse_map_t *map = &ctx->sparse.maps[ctx->sparse.current];
+    
+    for (size_t i = 0; i < blocks->rows; i++) {
+        for (size_t j = 0; j < blocks->cols; j++) {
+            pixels[i * pitch + j] = DEAD_COLOR;
+        }
+    }
+    
+    /* The cells covered by the region, clipped to the board */
+    int64_t col_begin = (int64_t)(blocks->col << level);
+    int64_t row_begin = (int64_t)(blocks->row << level);
+    int64_t col_end = (int64_t)((blocks->col + blocks->cols) << level);
+    int64_t row_end = (int64_t)((blocks->row + blocks->rows) << level);
+    if (col_end > (int64_t)ctx->cols) col_end = (int64_t)ctx->cols;
+    if (row_end > (int64_t)ctx->rows) row_end = (int64_t)ctx->rows;
+    
+    for (size_t i = 0; i < map->count; i++) {
+        const gol_sparse_tile_t *tile = &map->tiles[i];
+        int64_t x0 = tile->x * SPARSE_TILE_SIZE - col_begin;
+        int64_t y0 = tile->y * SPARSE_TILE_SIZE - row_begin;
+        uint64_t cols = sparse_window_mask(x0, col_end - col_begin);
+        uint64_t rows = sparse_window_mask(y0, row_end - row_begin);
+        if (tile->population == 0 || !cols || !rows) {
+            continue;
+        }
+        
+        for (size_t r = 0; r < SPARSE_TILE_SIZE; r++) {
+            if (!((rows >> r) & 1)) {
+                continue;
+            }
+            
+            uint64_t bits = tile->rows[r] & cols;
+            uint32_t *out = pixels + ((size_t)(y0 + (int64_t)r) >> level) * pitch;
+            while (bits) {
+                size_t x = (size_t)(x0 + __builtin_ctzll(bits));
+                out[x >> level] = ALIVE_COLOR;
+                
+                /* The rest of the block is already drawn */
+                int64_t next = (int64_t)(((x >> level) + 1) << level) - x0;
+                bits = next < SPARSE_TILE_SIZE ? bits & (~UINT64_C(0) << next) : 0;
+            }
+        }
+    }
+    return true;
+}
+
+/*
+ * GPU engine (built with GOL_OPENCL). Both generations live in device
+ * memory in the packed engine's layout, and each step is one compute
+ * kernel over all words of the board plus, for a boundary other than
+ * dead, two small kernels that fill the halo. The packed grid on the
+ * host is a mirror that is only brought up to date when the host needs
+ * cells: drawing, editing, snapshots and exports. Births and deaths are
+ * summed on the device, so statistics cost one 8-byte read per step.
+ */
+#if GOL_OPENCL
+
+/* Device code; GPU_GROUP_SIZE and the boundary values come from the build options */
+static const char gpu_program_source[] =
+    "ulong reverse_bits(ulong x) {\n"
+    "    x = ((x >> 1) & 0x5555555555555555UL) | ((x & 0x5555555555555555UL) << 1);\n"
+    "    x = ((x >> 2) & 0x3333333333333333UL) | ((x & 0x3333333333333333UL) << 2);\n"
+    "    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FUL) | ((x & 0x0F0F0F0F0F0F0F0FUL) << 4);\n"
+    "    x = ((x >> 8) & 0x00FF00FF00FF00FFUL) | ((x & 0x00FF00FF00FF00FFUL) << 8);\n"
+    "    x = ((x >> 16) & 0x0000FFFF0000FFFFUL) | ((x & 0x0000FFFF0000FFFFUL) << 16);\n"
+    "    return (x >> 32) | (x << 32);\n"
+    "}\n"
+    "\n"
+    "ulong select_bits(ulong select, ulong if_set, ulong if_clear) {\n"
+    "    return if_clear ^ (select & (if_set ^ if_clear));\n"
+    "}\n"
+    "\n"
+    "ulong rule_leaf(uint mask, uint count) {\n"
+    "    return (ulong)0 - (ulong)((mask >> count) & 1u);\n"
+    "}\n"
+    "\n"
+    "void full_add(ulong a, ulong b, ulong c, ulong *sum, ulong *carry) {\n"
+    "    ulong t = a ^ b;\n"
+    "    *sum = t ^ c;\n"
+    "    *carry = (a & b) | (t & c);\n"
+    "}\n"
+    "\n"
+    "/* One word of 64 cells per work-item, as packed_rule_word() */\n"
+    "__kernel void gol_step(__global const ulong *front, __global ulong *back, uint offset,\n"
+    "                       uint words, uint stride, uint rows, ulong last_mask,\n"
+    "                       uint birth, uint survive, __global uint *changes) {\n"
+    "    __local uint born[GPU_GROUP_SIZE];\n"
+    "    __local uint died[GPU_GROUP_SIZE];\n"
+    "    size_t id = get_global_id(0);\n"
+    "    size_t lid = get_local_id(0);\n"
+    "    uint b = 0, d = 0;\n"
+    "\n"
+    "    if (id < (size_t)words * rows) {\n"
+    "        size_t i = id / words, w = id % words;\n"
+    "        __global const ulong *m = front + offset + i * stride + w;\n"
+    "        __global const ulong *a = m - stride;\n"
+    "        __global const ulong *l = m + stride;\n"
+    "        ulong a_l = (a[0] << 1) | (a[-1] >> 63), a_r = (a[0] >> 1) | (a[1] << 63);\n"
+    "        ulong m_l = (m[0] << 1) | (m[-1] >> 63), m_r = (m[0] >> 1) | (m[1] << 63);\n"
+    "        ulong l_l = (l[0] << 1) | (l[-1] >> 63), l_r = (l[0] >> 1) | (l[1] << 63);\n"
+    "\n"
+    "        ulong s_a, c_a, s_l, c_l;\n"
+    "        full_add(a_l, a[0], a_r, &s_a, &c_a);\n"
+    "        full_add(l_l, l[0], l_r, &s_l, &c_l);\n"
+    "        ulong s_m = m_l ^ m_r, c_m = m_l & m_r;\n"
+    "        ulong ones, k, twos_lo, fours_lo;\n"
+    "        full_add(s_a, s_m, s_l, &ones, &k);\n"
+    "        full_add(c_a, c_m, c_l, &twos_lo, &fours_lo);\n"
+    "        ulong twos = twos_lo ^ k, carry = twos_lo & k;\n"
+    "        ulong fours = fours_lo ^ carry, eights = fours_lo & carry;\n"
+    "\n"
+    "        ulong next[2];\n"
+    "        for (uint alive = 0; alive < 2; alive++) {\n"
+    "            uint mask = alive ? survive : birth;\n"
+    "            ulong low = select_bits(twos,\n"
+    "                select_bits(ones, rule_leaf(mask, 3), rule_leaf(mask, 2)),\n"
+    "                select_bits(ones, rule_leaf(mask, 1), rule_leaf(mask, 0)));\n"
+    "            ulong high = select_bits(twos,\n"
+    "                select_bits(ones, rule_leaf(mask, 7), rule_leaf(mask, 6)),\n"
+    "                select_bits(ones, rule_leaf(mask, 5), rule_leaf(mask, 4)));\n"
+    "            next[alive] = select_bits(eights, rule_leaf(mask, 8),\n"
+    "                                      select_bits(fours, high, low));\n"
+    "        }\n"
+    "\n"
+    "        /* Padding bits may hold a halo neighbor; they are neither cells nor changes */\n"
+    "        ulong valid = w + 1 == words ? last_mask : ~(ulong)0;\n"
+    "        ulong current = m[0] & valid;\n"
+    "        ulong out = select_bits(m[0], next[1], next[0]) & valid;\n"
+    "        back[offset + i * stride + w] = out;\n"
+    "        b = (uint)popcount(out & ~current);\n"
+    "        d = (uint)popcount(current & ~out);\n"
+    "    }\n"
+    "\n"
+    "    born[lid] = b;\n"
+    "    died[lid] = d;\n"
+    "    barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    for (uint half = GPU_GROUP_SIZE / 2; half > 0; half /= 2) {\n"
+    "        if (lid < half) {\n"
+    "            born[lid] += born[lid + half];\n"
+    "            died[lid] += died[lid + half];\n"
+    "        }\n"
+    "        barrier(CLK_LOCAL_MEM_FENCE);\n"
+    "    }\n"
+    "    if (lid == 0) {\n"
+    "        atomic_add(&changes[0], born[0]);\n"
+    "        atomic_add(&changes[1], died[0]);\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "/* Halo words and padding of rows first + k * step, as packed_fill_row_halo() */\n"
+    "__kernel void gol_halo_cols(__global ulong *grid, uint offset, uint words, uint stride,\n"
+    "                            uint cols, ulong last_mask, int first, int step, uint count,\n"
+    "                            uint mirror) {\n"
+    "    size_t k = get_global_id(0);\n"
+    "    if (k >= count) return;\n"
+    "\n"
+    "    __global ulong *row = grid + offset + (long)(first + (int)k * step) * (long)stride;\n"
+    "    uint tail = cols % 64;\n"
+    "    ulong first_cell = row[0] & 1;\n"
+    "    ulong last_cell = (row[(cols - 1) / 64] >> ((cols - 1) % 64)) & 1;\n"
+    "    row[-1] = (mirror ? first_cell : last_cell) << 63;\n"
+    "    ulong right = mirror ? last_cell : first_cell;\n"
+    "    if (tail == 0) {\n"
+    "        row[words] = right;\n"
+    "    } else {\n"
+    "        row[words - 1] = (row[words - 1] & last_mask) | (right << tail);\n"
+    "    }\n"
+    "}\n"
+    "\n"
+    "/* Halo rows from the edge rows, halo words included; flipped for a Klein board */\n"
+    "__kernel void gol_halo_rows(__global ulong *grid, uint offset, uint words, uint stride,\n"
+    "                            uint rows, uint cols, uint boundary) {\n"
+    "    size_t k = get_global_id(0);\n"
+    "    if (k >= words + 2) return;\n"
+    "\n"
+    "    __global ulong *top = grid + offset - stride;\n"
+    "    __global ulong *bottom = grid + offset + (size_t)rows * stride;\n"
+    "    __global const ulong *first = grid + offset;\n"
+    "    __global const ulong *last = grid + offset + (size_t)(rows - 1) * stride;\n"
+    "    if (boundary == BOUNDARY_KLEIN) {\n"
+    "        if (k >= words) return;\n"
+    "        uint shift = words * 64 - cols;\n"
+    "        ulong top_low = reverse_bits(last[words - 1 - k]);\n"
+    "        ulong top_high = k + 1 < words ? reverse_bits(last[words - 2 - k]) : 0;\n"
+    "        ulong bottom_low = reverse_bits(first[words - 1 - k]);\n"
+    "        ulong bottom_high = k + 1 < words ? reverse_bits(first[words - 2 - k]) : 0;\n"
+    "        top[k] = shift ? (top_low >> shift) | (top_high << (64 - shift)) : top_low;\n"
+    "        bottom[k] = shift ? (bottom_low >> shift) | (bottom_high << (64 - shift)) : bottom_low;\n"
+    "    } else {\n"
+    "        long w = (long)k - 1;\n"
+    "        bool mirror = boundary == BOUNDARY_MIRROR;\n"
+    "        top[w] = mirror ? first[w] : last[w];\n"
+    "        bottom[w] = mirror ? last[w] : first[w];\n"
+    "    }\n"
+    "}\n";
+
+/* GPU engine state */
+typedef struct gol_gpu {
+    cl_context context;
+    cl_command_queue queue;
+    cl_program program;
+    cl_kernel step;
+    cl_kernel halo_cols;
+    cl_kernel halo_rows;
+    cl_mem front;             /* Current generation, same layout as a packed host buffer */
+    cl_mem back;              /* Next generation */
+    cl_mem changes;           /* Births and deaths of the step being computed */
+    size_t buffer_bytes;      /* Bytes of one buffer, leading line and halo rows included */
+    cl_uint offset;           /* Words from the start of a buffer to row 0 word 0 */
+    bool host_valid;          /* The host mirror holds the current generation */
+    bool device_valid;        /* The device front buffer holds the current generation */
+} gol_gpu_t;
+
+/**
+ * @brief Report a failed OpenCL call
+ * @param call Name of the call
+ * @param status OpenCL status code
+ * @return GOL_ERROR_MEMORY, the result of a failed allocate()
+ */
+static gol_result_t gpu_error(const char *call, cl_int status) {
+    fprintf(stderr, "Error: %s failed with OpenCL status %d\n", call, (int)status);
+    return GOL_ERROR_MEMORY;
+}
+
+/**
+ * @brief Abort when the device fails during a step, which cannot report it
+ * @param call Name of the call
+ * @param status OpenCL status code
+ */
+static void gpu_check(const char *call, cl_int status) {
+    if (status != CL_SUCCESS) {
+        gpu_error(call, status);
+        exit(GOL_ERROR_MEMORY);
+    }
+}
+
+/**
+ * @brief Pick a device, preferring a GPU on any platform
+ * @param platform_out Receives the platform of the device
+ * @param device_out Receives the device
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY if there is no device
+ */
+static gol_result_t gpu_find_device(cl_platform_id *platform_out, cl_device_id *device_out) {
+    cl_platform_id platforms[GPU_MAX_PLATFORMS];
+    cl_uint count = 0;
+    if (clGetPlatformIDs(GPU_MAX_PLATFORMS, platforms, &count) != CL_SUCCESS) {
+        count = 0;
+    }
+    if (count > GPU_MAX_PLATFORMS) count = GPU_MAX_PLATFORMS;
+    
+    /* A GPU anywhere beats any other device, e.g. a CPU implementation */
+    const cl_device_type types[] = { CL_DEVICE_TYPE_GPU, CL_DEVICE_TYPE_ALL };
+    for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        for (cl_uint p = 0; p < count; p++) {
+            if (clGetDeviceIDs(platforms[p], types[t], 1, device_out, NULL) == CL_SUCCESS) {
+                *platform_out = platforms[p];
+                return GOL_SUCCESS;
+            }
+        }
+    }
+    
+    fprintf(stderr, "Error: No OpenCL device found for the %s engine\n", ENGINE_GPU);
+    return GOL_ERROR_MEMORY;
+}
+
+/**
+ * @brief Compile the device program and create its kernels
+ * @param gpu GPU engine state with a context
+ * @param device Device to build for
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t gpu_build(gol_gpu_t *gpu, cl_device_id device) {
+    const char *source = gpu_program_source;
+    cl_int status;
+    gpu->program = clCreateProgramWithSource(gpu->context, 1, &source, NULL, &status);
+    if (status != CL_SUCCESS) {
+        return gpu_error("clCreateProgramWithSource", status);
+    }
+    
+    char options[BUFFER_SIZE];
+    snprintf(options, sizeof(options), "-DGPU_GROUP_SIZE=%d -DBOUNDARY_KLEIN=%d -DBOUNDARY_MIRROR=%d",
+             GPU_GROUP_SIZE, BOUNDARY_KLEIN, BOUNDARY_MIRROR);
+    status = clBuildProgram(gpu->program, 1, &device, options, NULL, NULL);
+    if (status != CL_SUCCESS) {
+        char log[BUFFER_SIZE];
+        size_t length = 0;
+        if (clGetProgramBuildInfo(gpu->program, device, CL_PROGRAM_BUILD_LOG, sizeof(log) - 1,
+                                  log, &length) != CL_SUCCESS) {
+            length = 0;
+        }
+        log[length < sizeof(log) ? length : sizeof(log) - 1] = '\0';
+        fprintf(stderr, "Error: OpenCL program build failed:\n%s\n", log);
+        return GOL_ERROR_MEMORY;
+    }
+    
+    gpu->step = clCreateKernel(gpu->program, "gol_step", &status);
+    if (status == CL_SUCCESS) {
+        gpu->halo_cols = clCreateKernel(gpu->program, "gol_halo_cols", &status);
+    }
+    if (status == CL_SUCCESS) {
+        gpu->halo_rows = clCreateKernel(gpu->program, "gol_halo_rows", &status);
+    }
+    return status == CL_SUCCESS ? GOL_SUCCESS : gpu_error("clCreateKernel", status);
+}
+
+/**
+ * @brief Locate the start of the host mirror's front buffer
+ * @param ctx Game context
+ * @return First word of the buffer, laid out as a device buffer
+ */
+static uint64_t *gpu_host_buffer(const gol_context_t *ctx) {
+    return ctx->packed.front - ctx->gpu->offset;
+}
+
+/**
+ * @brief Allocate the host mirror, the device buffers and the kernels
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t gpu_allocate(gol_context_t *ctx) {
+    gol_result_t result = packed_allocate(ctx);
+    if (result != GOL_SUCCESS) {
+        return result;
+    }
+    
+    gol_gpu_t *gpu = calloc(1, sizeof(*gpu));
+    if (!gpu) {
+        packed_deallocate(ctx);
+        return GOL_ERROR_MEMORY;
+    }
+    ctx->gpu = gpu;
+    
+    /* Device buffers mirror a packed host buffer word for word */
+    const gol_packed_grid_t *grid = &ctx->packed;
+    size_t line_words = ARENA_ALIGNMENT / sizeof(uint64_t);
+    gpu->offset = (cl_uint)(line_words + grid->stride);
+    gpu->buffer_bytes = (line_words + (ctx->rows + 2) * grid->stride) * sizeof(uint64_t);
+    
+    cl_platform_id platform;
+    cl_device_id device;
+    result = gpu_find_device(&platform, &device);
+    
+    cl_int status = CL_SUCCESS;
+    if (result == GOL_SUCCESS) {
+        cl_context_properties properties[] = {
+            CL_CONTEXT_PLATFORM, (cl_context_properties)platform, 0
+        };
+        gpu->context = clCreateContext(properties, 1, &device, NULL, NULL, &status);
+        if (status != CL_SUCCESS) result = gpu_error("clCreateContext", status);
+    }
+    if (result == GOL_SUCCESS) {
+        gpu->queue = clCreateCommandQueue(gpu->context, device, 0, &status);
+        if (status != CL_SUCCESS) result = gpu_error("clCreateCommandQueue", status);
+    }
+    if (result == GOL_SUCCESS) {
+        result = gpu_build(gpu, device);
+    }
+    if (result == GOL_SUCCESS) {
+        /* Uploading the zeroed host mirror clears both buffers, halos included */
+        cl_mem_flags flags = CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR;
+        gpu->front = clCreateBuffer(gpu->context, flags, gpu->buffer_bytes,
+                                    gpu_host_buffer(ctx), &status);
+        if (status == CL_SUCCESS) {
+            gpu->back = clCreateBuffer(gpu->context, flags, gpu->buffer_bytes,
+                                       gpu_host_buffer(ctx), &status);
+        }
+        if (status == CL_SUCCESS) {
+            gpu->changes = clCreateBuffer(gpu->context, CL_MEM_READ_WRITE,
+                                          2 * sizeof(cl_uint), NULL, &status);
+        }
+        if (status != CL_SUCCESS) result = gpu_error("clCreateBuffer", status);
+    }
+    
+    if (result != GOL_SUCCESS) {
+        gpu_deallocate(ctx);
+        return result;
+    }
+    gpu->host_valid = true;
+    gpu->device_valid = true;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Release the device objects and the host mirror
+ * @param ctx Game context
+ */
+static void gpu_deallocate(gol_context_t *ctx) {
+    gol_gpu_t *gpu = ctx->gpu;
+    if (gpu) {
+        if (gpu->changes) clReleaseMemObject(gpu->changes);
+        if (gpu->back) clReleaseMemObject(gpu->back);
+        if (gpu->front) clReleaseMemObject(gpu->front);
+        if (gpu->halo_rows) clReleaseKernel(gpu->halo_rows);
+        if (gpu->halo_cols) clReleaseKernel(gpu->halo_cols);
+        if (gpu->step) clReleaseKernel(gpu->step);
+        if (gpu->program) clReleaseProgram(gpu->program);
+        if (gpu->queue) clReleaseCommandQueue(gpu->queue);
+        if (gpu->context) clReleaseContext(gpu->context);
+        free(gpu);
+        ctx->gpu = NULL;
+    }
+    packed_deallocate(ctx);
+}
+
+/**
+ * @brief Bring the host mirror up to date with the device
+ * @param ctx Game context
+ */
+static void gpu_sync_host(const gol_context_t *ctx) {
+    gol_gpu_t *gpu = ctx->gpu;
+    if (gpu->host_valid) {
+        return;
+    }
+    
+    gpu_check("clEnqueueReadBuffer",
+              clEnqueueReadBuffer(gpu->queue, gpu->front, CL_TRUE, 0, gpu->buffer_bytes,
+                                  gpu_host_buffer(ctx), 0, NULL, NULL));
+    gpu->host_valid = true;
+}
+
+/**
+ * @brief Bring the device up to date with edits made on the host
+ * @param ctx Game context
+ */
+static void gpu_sync_device(gol_context_t *ctx) {
+    gol_gpu_t *gpu = ctx->gpu;
+    if (gpu->device_valid) {
+        return;
+    }
+    
+    gpu_check("clEnqueueWriteBuffer",
+              clEnqueueWriteBuffer(gpu->queue, gpu->front, CL_TRUE, 0, gpu->buffer_bytes,
+                                   gpu_host_buffer(ctx), 0, NULL, NULL));
+    gpu->device_valid = true;
+}
+
+/**
+ * @brief Copy the board edges into the halo of the device front buffer
+ * @param ctx Game context
+ */
+static void gpu_fill_halo(gol_context_t *ctx) {
+    gol_gpu_t *gpu = ctx->gpu;
+    const gol_packed_grid_t *grid = &ctx->packed;
+    cl_uint words = (cl_uint)grid->words, stride = (cl_uint)grid->stride;
+    cl_uint rows = (cl_uint)ctx->rows, cols = (cl_uint)ctx->cols;
+    cl_uint boundary = (cl_uint)ctx->config.boundary;
+    cl_uint mirror = ctx->config.boundary == BOUNDARY_MIRROR;
+    cl_ulong last_mask = grid->last_mask;
+    
+    gpu_sync_device(ctx);
+    
+    /* Row halos first, so copying whole rows takes the corners along */
+    cl_int first = 0, step = 1;
+    cl_uint count = rows;
+    clSetKernelArg(gpu->halo_cols, 0, sizeof(cl_mem), &gpu->front);
+    clSetKernelArg(gpu->halo_cols, 1, sizeof(cl_uint), &gpu->offset);
+    clSetKernelArg(gpu->halo_cols, 2, sizeof(cl_uint), &words);
+    clSetKernelArg(gpu->halo_cols, 3, sizeof(cl_uint), &stride);
+    clSetKernelArg(gpu->halo_cols, 4, sizeof(cl_uint), &cols);
+    clSetKernelArg(gpu->halo_cols, 5, sizeof(cl_ulong), &last_mask);
+    clSetKernelArg(gpu->halo_cols, 6, sizeof(cl_int), &first);
+    clSetKernelArg(gpu->halo_cols, 7, sizeof(cl_int), &step);
+    clSetKernelArg(gpu->halo_cols, 8, sizeof(cl_uint), &count);
+    clSetKernelArg(gpu->halo_cols, 9, sizeof(cl_uint), &mirror);
+    size_t global = (size_t)count;
+    gpu_check("clEnqueueNDRangeKernel",
+              clEnqueueNDRangeKernel(gpu->queue, gpu->halo_cols, 1, NULL, &global, NULL,
+                                     0, NULL, NULL));
+    
+    clSetKernelArg(gpu->halo_rows, 0, sizeof(cl_mem), &gpu->front);
+    clSetKernelArg(gpu->halo_rows, 1, sizeof(cl_uint), &gpu->offset);
+    clSetKernelArg(gpu->halo_rows, 2, sizeof(cl_uint), &words);
+    clSetKernelArg(gpu->halo_rows, 3, sizeof(cl_uint), &stride);
+    clSetKernelArg(gpu->halo_rows, 4, sizeof(cl_uint), &rows);
+    clSetKernelArg(gpu->halo_rows, 5, sizeof(cl_uint), &cols);
+    clSetKernelArg(gpu->halo_rows, 6, sizeof(cl_uint), &boundary);
+    global = (size_t)words + 2;
+    gpu_check("clEnqueueNDRangeKernel",
+              clEnqueueNDRangeKernel(gpu->queue, gpu->halo_rows, 1, NULL, &global, NULL,
+                                     0, NULL, NULL));
+    
+    /* Reversed halo rows get their own halo words, joined left to right */
+    if (ctx->config.boundary == BOUNDARY_KLEIN) {
+        first = -1;
+        step = (cl_int)rows + 1;
+        count = 2;
+        mirror = 0;
+        clSetKernelArg(gpu->halo_cols, 6, sizeof(cl_int), &first);
+        clSetKernelArg(gpu->halo_cols, 7, sizeof(cl_int), &step);
+        clSetKernelArg(gpu->halo_cols, 8, sizeof(cl_uint), &count);
+        clSetKernelArg(gpu->halo_cols, 9, sizeof(cl_uint), &mirror);
+        global = (size_t)count;
+        gpu_check("clEnqueueNDRangeKernel",
+                  clEnqueueNDRangeKernel(gpu->queue, gpu->halo_cols, 1, NULL, &global, NULL,
+                                         0, NULL, NULL));
+    }
+}
+
+/**
+ * @brief Simulate one generation on the device
+ * @param ctx Game context
+ */
+static void gpu_step(gol_context_t *ctx) {
+    gol_gpu_t *gpu = ctx->gpu;
+    const gol_packed_grid_t *grid = &ctx->packed;
+    const gol_rule_t *rule = &ctx->config.rule;
+    cl_uint words = (cl_uint)grid->words, stride = (cl_uint)grid->stride;
+    cl_uint rows = (cl_uint)ctx->rows;
+    cl_uint birth = rule->birth, survive = rule->survive;
+    cl_ulong last_mask = grid->last_mask;
+    cl_uint changes[2] = { 0, 0 };
+    
+    gpu_sync_device(ctx);
+    gpu_check("clEnqueueWriteBuffer",
+              clEnqueueWriteBuffer(gpu->queue, gpu->changes, CL_FALSE, 0, sizeof(changes),
+                                   changes, 0, NULL, NULL));
+    
+    clSetKernelArg(gpu->step, 0, sizeof(cl_mem), &gpu->front);
+    clSetKernelArg(gpu->step, 1, sizeof(cl_mem), &gpu->back);
+    clSetKernelArg(gpu->step, 2, sizeof(cl_uint), &gpu->offset);
+    clSetKernelArg(gpu->step, 3, sizeof(cl_uint), &words);
+    clSetKernelArg(gpu->step, 4, sizeof(cl_uint), &stride);
+    clSetKernelArg(gpu->step, 5, sizeof(cl_uint), &rows);
+    clSetKernelArg(gpu->step, 6, sizeof(cl_ulong), &last_mask);
+    clSetKernelArg(gpu->step, 7, sizeof(cl_uint), &birth);
+    clSetKernelArg(gpu->step, 8, sizeof(cl_uint), &survive);
+    clSetKernelArg(gpu->step, 9, sizeof(cl_mem), &gpu->changes);
+    
+    size_t local = GPU_GROUP_SIZE;
+    size_t global = (grid->words * ctx->rows + local - 1) / local * local;
+    gpu_check("clEnqueueNDRangeKernel",
+              clEnqueueNDRangeKernel(gpu->queue, gpu->step, 1, NULL, &global, &local,
+                                     0, NULL, NULL));
+    
+    /* The in-order queue makes the read wait for the step */
+    gpu_check("clEnqueueReadBuffer",
+              clEnqueueReadBuffer(gpu->queue, gpu->changes, CL_TRUE, 0, sizeof(changes),
+                                  changes, 0, NULL, NULL));
+    stats_add_changes(ctx, changes[0], changes[1]);
+    
+    cl_mem swap = gpu->front;
+    gpu->front = gpu->back;
+    gpu->back = swap;
+    gpu->host_valid = false;
+}
+
+/**
+ * @brief Read a cell, fetching the board from the device if needed
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @return true if the cell is alive
+ */
+static bool gpu_get_cell(const gol_context_t *ctx, size_t row, size_t col) {
+    gpu_sync_host(ctx);
+    return packed_get_cell(ctx, row, col);
+}
+
+/**
+ * @brief Write a cell on the host; the device is updated before the next step
+ * @param ctx Game context
+ * @param row Cell row
+ * @param col Cell column
+ * @param alive New cell state
+ */
+static void gpu_set_cell(gol_context_t *ctx, size_t row, size_t col, bool alive) {
+    gpu_sync_host(ctx);
+    packed_set_cell(ctx, row, col, alive);
+    ctx->gpu->device_valid = false;
+}
+
+/**
+ * @brief Count living cells, without touching the device
+ * @param ctx Game context
+ * @return Number of living cells
+ */
+static uint64_t gpu_count_alive(const gol_context_t *ctx) {
+    /* Kept up to date by set_cell() and the step, the board is the universe */
+    return ctx->stats.population;
+}
+
+/**
+ * @brief Kill every cell; the device is updated before the next step
+ * @param ctx Game context
+ */
+static void gpu_clear(gol_context_t *ctx) {
+    packed_clear(ctx);
+    ctx->gpu->host_valid = true;
+    ctx->gpu->device_valid = false;
+}
+
+/**
+ * @brief Write a region of the board as pixels, fetching it from the device if needed
+ * @param ctx Game context
+ * @param region Cells to draw
+ * @param pixels Destination for the region's top-left cell
+ * @param pitch Distance between destination rows, in pixels
+ */
+static void gpu_draw(const gol_context_t *ctx, const gol_region_t *region,
+                     uint32_t *pixels, size_t pitch) {
+    gpu_sync_host(ctx);
+    packed_draw(ctx, region, pixels, pitch);
+}
+
+/**
+ * @brief Draw blocks of cells from the LOD levels, fetching the board if needed
+ * 
+ * The host mirror carries no record of what the device changed, so a
+ * fetched board invalidates every level.
+ * 
+ * @param ctx Game context
+ * @param blocks Region of blocks to draw
+ * @param level log2 of cells per block side
+ * @param pixels Destination for the region's top-left block
+ * @param pitch Distance between destination rows, in pixels
+ * @return false if the levels could not be allocated
+ */
+static bool gpu_draw_blocks(gol_context_t *ctx, const gol_region_t *blocks,
+                            unsigned int level, uint32_t *pixels, size_t pitch) {
+    gol_packed_grid_t *grid = &ctx->packed;
+    if (!ctx->gpu->host_valid) {
+        gpu_sync_host(ctx);
+        for (size_t ty = 0; ty < grid->tiles_y; ty++) {
+            memset(packed_tile(grid, grid->lod_dirty, (ptrdiff_t)ty, 0), 1, grid->tiles_x);
+        }
+    }
+    return packed_draw_blocks(ctx, blocks, level, pixels, pitch);
+}
+
+/**
+ * @brief Copy the board out as packed rows, fetching it from the device if needed
+ * @param ctx Game context
+ * @param rows Output, rows * words_per_row words
+ * @param words_per_row Words per output row
+ */
+static void gpu_read_rows(const gol_context_t *ctx, uint64_t *rows, size_t words_per_row) {
+    gpu_sync_host(ctx);
+    packed_read_rows(ctx, rows, words_per_row);
+}
+
+/**
+ * @brief Overwrite the board with packed rows; the device is updated before the next step
+ * @param ctx Game context
+ * @param rows Input, rows * words_per_row words
+ * @param words_per_row Words per input row
+ */
+static void gpu_write_rows(gol_context_t *ctx, const uint64_t *rows, size_t words_per_row) {
+    packed_write_rows(ctx, rows, words_per_row);
+    ctx->gpu->host_valid = true;
+    ctx->gpu->device_valid = false;
+}
+
+#endif /* GOL_OPENCL */
+
+#if GOL_MPI
+/*
+ * Distributed runs. Under mpirun with more than one rank, the board is
+ * split into a grid of blocks, one per rank, and every rank runs the
+ * packed engine on its own block with its own worker threads, so no
+ * process ever holds more than its block. Block columns start on word
+ * boundaries, which keeps every block's rows whole words and lets random
+ * fills, snapshots and patterns address cells by board position.
+ *
+ * Every generation each rank sends its edge rows, edge columns and
+ * corner cells to its eight neighbors with non-blocking calls, steps the
+ * inside of its block, which reads no halo cell, while the messages are
+ * in flight, then fills the halo from what arrived and steps the rim.
+ * The boundary is the board's: torus makes the process grid periodic,
+ * and a dead or mirror edge has no neighbor and is filled locally.
+ * Statistics stay per rank and are summed only when they are reported.
+ */
+
+/* Neighbor of a block; a halo message sent toward side d is tagged d */
+typedef enum {
+    DIST_UP,
+    DIST_DOWN,
+    DIST_LEFT,
+    DIST_RIGHT,
+    DIST_UP_LEFT,
+    DIST_UP_RIGHT,
+    DIST_DOWN_LEFT,
+    DIST_DOWN_RIGHT,
+    DIST_NEIGHBORS
+} gol_dist_side_t;
+
+/* Row and column offsets of the neighbors, and the side each one sees us on */
+static const struct {
+    int row;
+    int col;
+    gol_dist_side_t opposite;
+} dist_sides[DIST_NEIGHBORS] = {
+    [DIST_UP] = { -1, 0, DIST_DOWN },
+    [DIST_DOWN] = { 1, 0, DIST_UP },
+    [DIST_LEFT] = { 0, -1, DIST_RIGHT },
+    [DIST_RIGHT] = { 0, 1, DIST_LEFT },
+    [DIST_UP_LEFT] = { -1, -1, DIST_DOWN_RIGHT },
+    [DIST_UP_RIGHT] = { -1, 1, DIST_DOWN_LEFT },
+    [DIST_DOWN_LEFT] = { 1, -1, DIST_UP_RIGHT },
+    [DIST_DOWN_RIGHT] = { 1, 1, DIST_UP_LEFT }
+};
+
+/* Distributed run state of one rank */
+typedef struct gol_dist {
+    MPI_Comm comm;                       /* Cartesian communicator of the block grid */
+    int rank;
+    int size;
+    int dims[2];                         /* Block rows and block columns */
+    int coords[2];                       /* Block row and column of this rank */
+    int neighbors[DIST_NEIGHBORS];       /* MPI_PROC_NULL past a dead or mirror edge */
+    int counts[DIST_NEIGHBORS];          /* Words per halo message */
+    uint64_t *buffers;                   /* Every send and receive buffer */
+    uint64_t *send[DIST_NEIGHBORS];      /* Our edges, cut out of the current generation */
+    uint64_t *recv[DIST_NEIGHBORS];      /* The neighbors' edges */
+    MPI_Request requests[2 * DIST_NEIGHBORS];
+} gol_dist_t;
+
+/* Region of packed tiles stepped by the worker pool */
+typedef struct {
+    gol_context_t *ctx;
+    size_t row_begin;
+    size_t row_end;
+    size_t word_begin;
+    size_t word_end;
+} gol_dist_region_t;
+
+/**
+ * @brief Split the board between the ranks of an MPI run
+ * 
+ * With a single rank nothing changes. Otherwise the process grid with
+ * the least halo per block is chosen, and ctx->rows, ctx->cols and the
+ * origin are set to this rank's block, before the grid is allocated.
+ * 
+ * @param ctx Game context with the parsed configuration
+ * @return GOL_SUCCESS on success, GOL_ERROR_CONFIG or GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t dist_create(gol_context_t *ctx) {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (size == 1) {
+        return GOL_SUCCESS;
+    }
+    
+    /* Every rank parsed the same file, so rank 0 speaks for all of them */
+    const gol_config_t *config = &ctx->config;
+    const char *problem = NULL;
+    if (ctx->engine != &packed_engine) {
+        problem = "need the packed engine";
+    } else if (config->temporal_block > 1) {
+        problem = "do not support @temporal_block";
+    } else if (config->boundary == BOUNDARY_KLEIN) {
+        problem = "do not support @boundary klein";
+    } else if (config->export_path[0] != '\0') {
+        problem = "cannot @export, the board is never on one rank; use @checkpoint";
+    } else if (config->cycle_period > 0) {
+        problem = "do not support @detect_cycles";
+    } else if (config->frames_path[0] != '\0') {
+        problem = "cannot export @frames, the board is never on one rank";
+    }
+    
+    /* Fewest halo cells per block, with at least one row and one word per block */
+    size_t rows = config->rows, cols = config->cols;
+    size_t words = (cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    int dims[2] = { 0, 0 };
+    size_t best = SIZE_MAX;
+    for (int block_rows = 1; block_rows <= size && !problem; block_rows++) {
+        int block_cols = size / block_rows;
+        if (block_rows * block_cols != size || (size_t)block_rows > rows ||
+            (size_t)block_cols > words) {
+            continue;
+        }
+        size_t halo = (rows + block_rows - 1) / block_rows +
+                      (words + block_cols - 1) / block_cols * CELLS_PER_WORD;
+        if (halo < best) {
+            best = halo;
+            dims[0] = block_rows;
+            dims[1] = block_cols;
+        }
+    }
+    if (!problem && best == SIZE_MAX) {
+        problem = "need at least one row and 64 columns per rank";
+    }
+    if (problem) {
+        if (rank == 0) {
+            fprintf(stderr, "Error: Distributed runs %s\n", problem);
+        }
+        return GOL_ERROR_CONFIG;
+    }
+    
+    gol_dist_t *dist = calloc(1, sizeof(*dist));
+    if (!dist) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    /* Torus joins opposite blocks; dead and mirror edges have no neighbor */
+    int periods[2] = { config->boundary == BOUNDARY_TORUS, config->boundary == BOUNDARY_TORUS };
+    MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 1, &dist->comm);
+    MPI_Comm_rank(dist->comm, &dist->rank);
+    dist->size = size;
+    dist->dims[0] = dims[0];
+    dist->dims[1] = dims[1];
+    MPI_Cart_coords(dist->comm, dist->rank, 2, dist->coords);
+    
+    for (int side = 0; side < DIST_NEIGHBORS; side++) {
+        int coords[2] = { dist->coords[0] + dist_sides[side].row,
+                          dist->coords[1] + dist_sides[side].col };
+        bool outside = false;
+        for (int d = 0; d < 2; d++) {
+            if (coords[d] < 0 || coords[d] >= dims[d]) {
+                outside |= !periods[d];
+                coords[d] = (coords[d] + dims[d]) % dims[d];
+            }
+        }
+        dist->neighbors[side] = MPI_PROC_NULL;
+        if (!outside) {
+            MPI_Cart_rank(dist->comm, coords, &dist->neighbors[side]);
+        }
+    }
+    
+    /* A time-based seed has to be the same on every rank */
+    if (ctx->config.seed == 0) {
+        unsigned int seed = (unsigned int)time(NULL);
+        MPI_Bcast(&seed, 1, MPI_UNSIGNED, 0, dist->comm);
+        ctx->config.seed = seed ? seed : 1;
+    }
+    
+    /* This rank's block */
+    size_t row_begin = rows * (size_t)dist->coords[0] / (size_t)dims[0];
+    size_t row_end = rows * (size_t)(dist->coords[0] + 1) / (size_t)dims[0];
+    size_t word_begin = words * (size_t)dist->coords[1] / (size_t)dims[1];
+    size_t word_end = words * (size_t)(dist->coords[1] + 1) / (size_t)dims[1];
+    size_t col_end = word_end * CELLS_PER_WORD < cols ? word_end * CELLS_PER_WORD : cols;
+    ctx->origin_row = row_begin;
+    ctx->origin_col = word_begin * CELLS_PER_WORD;
+    ctx->rows = row_end - row_begin;
+    ctx->cols = col_end - ctx->origin_col;
+    
+    /* Edge rows are whole words, edge columns one bit per row, corners one bit */
+    int row_words = (int)(word_end - word_begin);
+    int column_words = (int)((ctx->rows + CELLS_PER_WORD - 1) / CELLS_PER_WORD);
+    int counts[DIST_NEIGHBORS] = {
+        [DIST_UP] = row_words, [DIST_DOWN] = row_words,
+        [DIST_LEFT] = column_words, [DIST_RIGHT] = column_words,
+        [DIST_UP_LEFT] = 1, [DIST_UP_RIGHT] = 1, [DIST_DOWN_LEFT] = 1, [DIST_DOWN_RIGHT] = 1
+    };
+    size_t total = 0;
+    for (int side = 0; side < DIST_NEIGHBORS; side++) {
+        dist->counts[side] = counts[side];
+        total += 2 * (size_t)counts[side];
+    }
+    dist->buffers = calloc(total, sizeof(uint64_t));
+    if (!dist->buffers) {
+        MPI_Comm_free(&dist->comm);
+        free(dist);
+        return GOL_ERROR_MEMORY;
+    }
+    uint64_t *next = dist->buffers;
+    for (int side = 0; side < DIST_NEIGHBORS; side++) {
+        dist->send[side] = next;
+        dist->recv[side] = next + counts[side];
+        next += 2 * (size_t)counts[side];
+    }
+    
+    ctx->dist = dist;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Release the distributed run state
+ * @param ctx Game context; nothing happens for a single-process run
+ */
+static void dist_destroy(gol_context_t *ctx) {
+    gol_dist_t *dist = ctx->dist;
+    if (!dist) return;
+    
+    MPI_Comm_free(&dist->comm);
+    free(dist->buffers);
+    free(dist);
+    ctx->dist = NULL;
+}
+
+/**
+ * @brief Combine the results of a step that may fail on some ranks only
+ * @param ctx Game context
+ * @param result This rank's result
+ * @return The worst result of all ranks, the same on every rank
+ */
+static gol_result_t dist_agree(const gol_context_t *ctx, gol_result_t result) {
+    if (!ctx->dist) {
+        return result;
+    }
+    
+    int local = (int)result, worst;
+    MPI_Allreduce(&local, &worst, 1, MPI_INT, MPI_MAX, ctx->dist->comm);
+    return (gol_result_t)worst;
+}
+
+/**
+ * @brief Read one column of the current generation as one bit per row
+ * @param ctx Game context
+ * @param out Output, ceil(rows / 64) words
+ * @param col Local column
+ */
+static void dist_pack_column(const gol_context_t *ctx, uint64_t *out, size_t col) {
+    const gol_packed_grid_t *grid = &ctx->packed;
+    size_t word = col / CELLS_PER_WORD;
+    unsigned int bit = (unsigned int)(col % CELLS_PER_WORD);
+    
+    memset(out, 0, (ctx->rows + CELLS_PER_WORD - 1) / CELLS_PER_WORD * sizeof(uint64_t));
+    for (size_t i = 0; i < ctx->rows; i++) {
+        uint64_t cell = (packed_row(grid, grid->front, (ptrdiff_t)i)[word] >> bit) & 1u;
+        out[i / CELLS_PER_WORD] |= cell << (i % CELLS_PER_WORD);
+    }
+}
+
+/**
+ * @brief Read a cell of the current generation as 0 or 1
+ * @param ctx Game context
+ * @param row Local row
+ * @param col Local column
+ * @return Cell state
+ */
+static inline uint64_t dist_cell(const gol_context_t *ctx, size_t row, size_t col) {
+    return packed_get_cell(ctx, row, col) ? 1u : 0u;
+}
+
+/**
+ * @brief Send this block's edges to the neighbors and post the receives
+ * @param ctx Game context
+ */
+static void dist_post_halos(gol_context_t *ctx) {
+    gol_dist_t *dist = ctx->dist;
+    const gol_packed_grid_t *grid = &ctx->packed;
+    size_t rows = ctx->rows, cols = ctx->cols;
+    size_t row_bytes = grid->words * sizeof(uint64_t);
+    
+    /* The step writes the other buffer, so the edges are copied out first */
+    memcpy(dist->send[DIST_UP], packed_row(grid, grid->front, 0), row_bytes);
+    memcpy(dist->send[DIST_DOWN], packed_row(grid, grid->front, (ptrdiff_t)rows - 1), row_bytes);
+    dist->send[DIST_UP][grid->words - 1] &= grid->last_mask;
+    dist->send[DIST_DOWN][grid->words - 1] &= grid->last_mask;
+    if (dist->neighbors[DIST_LEFT] != MPI_PROC_NULL) {
+        dist_pack_column(ctx, dist->send[DIST_LEFT], 0);
+    }
+    if (dist->neighbors[DIST_RIGHT] != MPI_PROC_NULL) {
+        dist_pack_column(ctx, dist->send[DIST_RIGHT], cols - 1);
+    }
+    dist->send[DIST_UP_LEFT][0] = dist_cell(ctx, 0, 0);
+    dist->send[DIST_UP_RIGHT][0] = dist_cell(ctx, 0, cols - 1);
+    dist->send[DIST_DOWN_LEFT][0] = dist_cell(ctx, rows - 1, 0);
+    dist->send[DIST_DOWN_RIGHT][0] = dist_cell(ctx, rows - 1, cols - 1);
+    
+    /* Messages to and from MPI_PROC_NULL complete at once */
+    for (int side = 0; side < DIST_NEIGHBORS; side++) {
+        MPI_Irecv(dist->recv[side], dist->counts[side], MPI_UINT64_T, dist->neighbors[side],
+                  (int)dist_sides[side].opposite, dist->comm, &dist->requests[side]);
+    }
+    for (int side = 0; side < DIST_NEIGHBORS; side++) {
+        MPI_Isend(dist->send[side], dist->counts[side], MPI_UINT64_T, dist->neighbors[side],
+                  side, dist->comm, &dist->requests[DIST_NEIGHBORS + side]);
+    }
+}
+
+/**
+ * @brief Fill the halo of the current generation from the received edges
+ * 
+ * Edges without a neighbor stay dead or reflect the block's own cells.
+ * The neighbors' tile changes are not sent, so the halo ring of the tile
+ * flags marks every tile along an open side as changed and those tiles
+ * are always recomputed.
+ * 
+ * @param ctx Game context, after every request of dist_post_halos() completed
+ */
+static void dist_fill_halo(gol_context_t *ctx) {
+    const gol_dist_t *dist = ctx->dist;
+    gol_packed_grid_t *grid = &ctx->packed;
+    bool mirror = ctx->config.boundary == BOUNDARY_MIRROR;
+    ptrdiff_t rows = (ptrdiff_t)ctx->rows;
+    size_t cols = ctx->cols;
+    bool open[DIST_NEIGHBORS];
+    for (int side = 0; side < DIST_NEIGHBORS; side++) {
+        open[side] = dist->neighbors[side] != MPI_PROC_NULL;
+    }
+    
+    /* Columns first, so the reflected halo rows take the corners along */
+    const uint64_t *left = dist->recv[DIST_LEFT], *right = dist->recv[DIST_RIGHT];
+    for (ptrdiff_t i = 0; i < rows; i++) {
+        uint64_t *row = packed_row(grid, grid->front, i);
+        uint64_t first = row[0] & 1u;
+        uint64_t last = (row[(cols - 1) / CELLS_PER_WORD] >> ((cols - 1) % CELLS_PER_WORD)) & 1u;
+        uint64_t west = open[DIST_LEFT] ? (left[i / CELLS_PER_WORD] >> (i % CELLS_PER_WORD)) & 1u
+                                        : mirror ? first : 0;
+        uint64_t east = open[DIST_RIGHT] ? (right[i / CELLS_PER_WORD] >> (i % CELLS_PER_WORD)) & 1u
+                                         : mirror ? last : 0;
+        packed_set_row_halo(grid, row, cols, west, east);
+    }
+    
+    static const gol_dist_side_t vertical[2][3] = {
+        { DIST_UP, DIST_UP_LEFT, DIST_UP_RIGHT },
+        { DIST_DOWN, DIST_DOWN_LEFT, DIST_DOWN_RIGHT }
+    };
+    for (int v = 0; v < 2; v++) {
+        gol_dist_side_t side = vertical[v][0];
+        uint64_t *halo = packed_row(grid, grid->front, v == 0 ? -1 : rows);
+        const uint64_t *edge = packed_row(grid, grid->front, v == 0 ? 0 : rows - 1);
+        if (open[side]) {
+            /* A reflected corner is the far block's own edge cell */
+            memcpy(halo, dist->recv[side], grid->words * sizeof(uint64_t));
+            gol_dist_side_t west = vertical[v][1], east = vertical[v][2];
+            uint64_t first = halo[0] & 1u;
+            uint64_t last = (halo[(cols - 1) / CELLS_PER_WORD] >> ((cols - 1) % CELLS_PER_WORD)) & 1u;
+            packed_set_row_halo(grid, halo, cols,
+                                open[west] ? dist->recv[west][0] : mirror ? first : 0,
+                                open[east] ? dist->recv[east][0] : mirror ? last : 0);
+        } else if (mirror) {
+            memcpy(halo - 1, edge - 1, (grid->words + 2) * sizeof(uint64_t));
+        }
+    }
+    
+    /* Tile flags along every side with cells beyond it */
+    ptrdiff_t tiles_x = (ptrdiff_t)grid->tiles_x, tiles_y = (ptrdiff_t)grid->tiles_y;
+    for (ptrdiff_t ty = -1; ty <= tiles_y; ty++) {
+        uint8_t *flags = packed_tile(grid, grid->changed, ty, 0);
+        if (open[DIST_LEFT] || mirror) flags[-1] = 1;
+        if (open[DIST_RIGHT] || mirror) flags[tiles_x] = 1;
+    }
+    if (open[DIST_UP] || mirror) {
+        memset(packed_tile(grid, grid->changed, -1, -1), 1, grid->tile_stride);
+    }
+    if (open[DIST_DOWN] || mirror) {
+        memset(packed_tile(grid, grid->changed, tiles_y, -1), 1, grid->tile_stride);
+    }
+}
+
+/**
+ * @brief Pool task: step one band of a tile region
+ * 
+ * Regions several tile rows high are split by tile rows, a single tile
+ * row by words.
+ * 
+ * @param arg Region to step
+ * @param index Band index
+ * @param count Number of bands
+ */
+static void dist_region_task(void *arg, size_t index, size_t count) {
+    const gol_dist_region_t *region = arg;
+    size_t row_begin = region->row_begin, row_end = region->row_end;
+    size_t word_begin = region->word_begin, word_end = region->word_end;
+    size_t tiles = (row_end - row_begin + TILE_ROWS - 1) / TILE_ROWS;
+    
+    if (tiles > 1) {
+        row_begin = region->row_begin + tiles * index / count * TILE_ROWS;
+        row_end = region->row_begin + tiles * (index + 1) / count * TILE_ROWS;
+        if (row_end > region->row_end) row_end = region->row_end;
+    } else {
+        size_t words = region->word_end - region->word_begin;
+        word_begin = region->word_begin + words * index / count;
+        word_end = region->word_begin + words * (index + 1) / count;
+    }
+    if (row_begin < row_end && word_begin < word_end) {
+        packed_step_region(region->ctx, row_begin, row_end, word_begin, word_end);
+    }
+}
+
+/**
+ * @brief Step a rectangle of tiles, on the worker pool if there is one
+ * @param ctx Game context
+ * @param row_begin First row, a multiple of TILE_ROWS
+ * @param row_end One past the last row, a multiple of TILE_ROWS or the row count
+ * @param word_begin First word
+ * @param word_end One past the last word
+ */
+static void dist_step_region(gol_context_t *ctx, size_t row_begin, size_t row_end,
+                             size_t word_begin, size_t word_end) {
+    gol_dist_region_t region = { ctx, row_begin, row_end, word_begin, word_end };
+    
+    if (ctx->pool) {
+        thread_pool_run(ctx->pool, dist_region_task, &region);
+    } else {
+        dist_region_task(&region, 0, 1);
+    }
+}
+
+/**
+ * @brief Simulate one generation of this rank's block
+ * 
+ * The inside of the block, every tile but the first and last tile rows
+ * and words, is stepped while the halo messages travel; the rim follows
+ * once they have arrived.
+ * 
+ * @param ctx Game context
+ */
+static void dist_step(gol_context_t *ctx) {
+    gol_dist_t *dist = ctx->dist;
+    size_t rows = ctx->rows;
+    size_t words = ctx->packed.words;
+    size_t tiles_y = ctx->packed.tiles_y;
+    size_t last_tile_row = (tiles_y - 1) * TILE_ROWS;
+    
+    dist_post_halos(ctx);
+    if (tiles_y > 2 && words > 2) {
+        dist_step_region(ctx, TILE_ROWS, last_tile_row, 1, words - 1);
+    }
+    
+    MPI_Waitall(2 * DIST_NEIGHBORS, dist->requests, MPI_STATUSES_IGNORE);
+    dist_fill_halo(ctx);
+    
+    dist_step_region(ctx, 0, rows < TILE_ROWS ? rows : TILE_ROWS, 0, words);
+    if (tiles_y > 1) {
+        dist_step_region(ctx, last_tile_row, rows, 0, words);
+    }
+    if (tiles_y > 2) {
+        dist_step_region(ctx, TILE_ROWS, last_tile_row, 0, 1);
+        if (words > 1) {
+            dist_step_region(ctx, TILE_ROWS, last_tile_row, words - 1, words);
+        }
+    }
+    packed_swap_buffers(ctx);
+}
+
+/**
+ * @brief Sum the statistics of every rank's block
+ * @param ctx Game context
+ * @return Statistics of the whole board, on every rank
+ */
+static gol_stats_t dist_total_stats(const gol_context_t *ctx) {
+    uint64_t local[3] = { ctx->stats.population, ctx->stats.births, ctx->stats.deaths };
+    uint64_t total[3];
+    MPI_Allreduce(local, total, 3, MPI_UINT64_T, MPI_SUM, ctx->dist->comm);
+    
+    gol_stats_t stats = { total[0], total[1], total[2] };
+    return stats;
+}
+
+/**
+ * @brief Save the board to a snapshot file, every rank writing its block
+ * 
+ * The file has the same format as a single-process snapshot. Rank 0
+ * writes the header, and one collective MPI-IO write places every
+ * block's rows; as there, the file is renamed into place once complete.
+ * 
+ * @param ctx Game context
+ * @param filename Snapshot path, on a file system every rank can reach
+ * @return GOL_SUCCESS on success, GOL_ERROR_FILE on failure
+ */
+static gol_result_t dist_snapshot_save(const gol_context_t *ctx, const char *filename) {
+    const gol_dist_t *dist = ctx->dist;
+    const gol_packed_grid_t *grid = &ctx->packed;
+    size_t words = (ctx->config.cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    
+    gol_snapshot_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byte_order = SNAPSHOT_BYTE_ORDER;
+    header.rows = ctx->config.rows;
+    header.cols = ctx->config.cols;
+    header.generation = ctx->generation;
+    header.words_per_row = words;
+    snprintf(header.rule, sizeof(header.rule), "%s", ctx->config.rule.name);
+    snprintf(header.engine, sizeof(header.engine), "%s", ctx->engine->name);
+    
+    /* The block goes out through the scratch rows of random fills */
+    packed_read_rows(ctx, ctx->board_rows, grid->words);
+    
+    /* The file view selects this block's words of every row it covers */
+    MPI_Datatype row, block;
+    int sizes[2] = { (int)ctx->config.rows, (int)words };
+    int subsizes[2] = { (int)ctx->rows, (int)grid->words };
+    int starts[2] = { (int)ctx->origin_row, (int)(ctx->origin_col / CELLS_PER_WORD) };
+    MPI_Type_contiguous((int)grid->words, MPI_UINT64_T, &row);
+    MPI_Type_create_subarray(2, sizes, subsizes, starts, MPI_ORDER_C, MPI_UINT64_T, &block);
+    MPI_Type_commit(&row);
+    MPI_Type_commit(&block);
+    
+    char temp[MAX_CONFIG_LENGTH + 8];
+    snprintf(temp, sizeof(temp), "%s.tmp", filename);
+    MPI_File file;
+    int status = MPI_File_open(dist->comm, temp, MPI_MODE_CREATE | MPI_MODE_WRONLY,
+                               MPI_INFO_NULL, &file);
+    if (status == MPI_SUCCESS) {
+        MPI_Offset size = (MPI_Offset)(sizeof(header) + header.rows * words * sizeof(uint64_t));
+        status = MPI_File_set_size(file, size);
+        if (status == MPI_SUCCESS && dist->rank == 0) {
+            status = MPI_File_write_at(file, 0, &header, (int)sizeof(header), MPI_BYTE,
+                                       MPI_STATUS_IGNORE);
+        }
+        if (status == MPI_SUCCESS) {
+            status = MPI_File_set_view(file, (MPI_Offset)sizeof(header), MPI_UINT64_T, block,
+                                       "native", MPI_INFO_NULL);
+        }
+        if (status == MPI_SUCCESS) {
+            status = MPI_File_write_all(file, ctx->board_rows, (int)ctx->rows, row,
+                                        MPI_STATUS_IGNORE);
+        }
+        MPI_File_close(&file);
+    }
+    MPI_Type_free(&row);
+    MPI_Type_free(&block);
+    
+    gol_result_t result = dist_agree(ctx, status == MPI_SUCCESS ? GOL_SUCCESS : GOL_ERROR_FILE);
+    if (dist->rank == 0) {
+        if (result == GOL_SUCCESS && rename(temp, filename) != 0) {
+            result = GOL_ERROR_FILE;
+        }
+        if (result != GOL_SUCCESS) {
+            fprintf(stderr, "Error: Cannot write snapshot '%s'\n", filename);
+            unlink(temp);
+        }
+    }
+    int shared = (int)result;
+    MPI_Bcast(&shared, 1, MPI_INT, 0, dist->comm);
+    return (gol_result_t)shared;
+}
+
+/**
+ * @brief Print the results of a distributed headless run on rank 0
+ * 
+ * The board is never on one rank, so only the statistics are printed;
+ * @checkpoint saves the board itself.
+ * 
+ * @param ctx Game context
+ * @param steps Generations run
+ * @param elapsed Seconds taken by this rank
+ * @return GOL_SUCCESS
+ */
+static gol_result_t dist_report(const gol_context_t *ctx, uint64_t steps, double elapsed) {
+    const gol_dist_t *dist = ctx->dist;
+    gol_stats_t stats = dist_total_stats(ctx);
+    double slowest;
+    MPI_Reduce(&elapsed, &slowest, 1, MPI_DOUBLE, MPI_MAX, 0, dist->comm);
+    if (dist->rank != 0) {
+        return GOL_SUCCESS;
+    }
+    
+    double cell_updates = (double)steps * (double)ctx->config.rows * (double)ctx->config.cols;
+    printf("Engine: %s (kernel %s, %u thread%s on each of %d ranks, %dx%d blocks)\n",
+           ctx->engine->name, ctx->kernel->name,
+           ctx->pool ? (unsigned int)ctx->pool->count : 1, ctx->pool ? "s" : "",
+           dist->size, dist->dims[0], dist->dims[1]);
+    printf("Generations: %" PRIu64 "\n", ctx->generation);
+    printf("Elapsed: %.6f s (%.1f generations/s, %.3e cell updates/s)\n", slowest,
+           slowest > 0 ? steps / slowest : 0.0, slowest > 0 ? cell_updates / slowest : 0.0);
+    printf("Living cells: %" PRIu64 "\n", stats.population);
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Check whether any cell of a packed row is alive in a column range
+ * @param row Packed row
+ * @param col_begin First column
+ * @param col_end One past the last column, greater than col_begin
+ * @return true if a cell in the range is alive
+ */
+static bool dist_row_any(const uint64_t *row, size_t col_begin, size_t col_end) {
+    size_t first = col_begin / CELLS_PER_WORD, last = (col_end - 1) / CELLS_PER_WORD;
+    uint64_t low = ~UINT64_C(0) << (col_begin % CELLS_PER_WORD);
+    uint64_t high = ~UINT64_C(0) >> (CELLS_PER_WORD - 1 - (col_end - 1) % CELLS_PER_WORD);
+    
+    if (first == last) {
+        return (row[first] & low & high) != 0;
+    }
+    if (row[first] & low) return true;
+    for (size_t w = first + 1; w < last; w++) {
+        if (row[w]) return true;
+    }
+    return (row[last] & high) != 0;
+}
+
+/**
+ * @brief Build the downsampled board on rank 0
+ * 
+ * A view pixel covers scale x scale cells and is lit if any of them is
+ * alive. Every rank lights the pixels of its block, and a bitwise OR
+ * reduction combines them on rank 0.
+ * 
+ * @param ctx Game context
+ * @param view View pixels, rows * cols bytes; the whole view on rank 0
+ * @param rows View rows
+ * @param cols View columns
+ * @param scale Cells per view pixel along each side
+ */
+static void dist_gather_view(const gol_context_t *ctx, uint8_t *view, size_t rows, size_t cols,
+                             size_t scale) {
+    const gol_dist_t *dist = ctx->dist;
+    const gol_packed_grid_t *grid = &ctx->packed;
+    size_t col_begin = ctx->origin_col, col_end = ctx->origin_col + ctx->cols;
+    
+    memset(view, 0, rows * cols);
+    for (size_t i = 0; i < ctx->rows; i++) {
+        const uint64_t *row = packed_row(grid, grid->front, (ptrdiff_t)i);
+        uint8_t *pixels = view + (ctx->origin_row + i) / scale * cols;
+        for (size_t x = col_begin / scale; x * scale < col_end; x++) {
+            size_t begin = x * scale > col_begin ? x * scale : col_begin;
+            size_t end = (x + 1) * scale < col_end ? (x + 1) * scale : col_end;
+            if (!pixels[x] && dist_row_any(row, begin - col_begin, end - col_begin)) {
+                pixels[x] = 1;
+            }
+        }
+    }
+    
+    if (dist->rank == 0) {
+        MPI_Reduce(MPI_IN_PLACE, view, (int)(rows * cols), MPI_UNSIGNED_CHAR, MPI_BOR, 0,
+                   dist->comm);
+    } else {
+        MPI_Reduce(view, NULL, (int)(rows * cols), MPI_UNSIGNED_CHAR, MPI_BOR, 0, dist->comm);
+    }
+}
+
+/**
+ * @brief Draw the downsampled board on rank 0
+ * @param ctx Game context
+ * @param view Lit view pixels
+ * @param rows View rows
+ * @param cols View columns
+ * @param zoom Window pixels per view pixel
+ */
+static void dist_draw_view(gol_context_t *ctx, const uint8_t *view, size_t rows, size_t cols,
+                           int zoom) {
+    void *pixels;
+    int pitch;
+    
+    if (ctx->texture && SDL_LockTexture(ctx->texture, NULL, &pixels, &pitch) == 0) {
+        for (size_t i = 0; i < rows; i++) {
+            uint32_t *out = (uint32_t *)((uint8_t *)pixels + i * (size_t)pitch);
+            for (size_t j = 0; j < cols; j++) {
+                out[j] = view[i * cols + j] ? ALIVE_COLOR : DEAD_COLOR;
+            }
+        }
+        SDL_UnlockTexture(ctx->texture);
+        SDL_RenderCopy(ctx->renderer, ctx->texture, NULL, NULL);
+        return;
+    }
+    
+    SDL_SetRenderDrawColor(ctx->renderer, 0, 0, 0, 255);
+    SDL_RenderClear(ctx->renderer);
+    SDL_SetRenderDrawColor(ctx->renderer, 0, 255, 0, 255);
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            if (view[i * cols + j]) {
+                SDL_Rect cell = { (int)j * zoom, (int)i * zoom, zoom, zoom };
+                SDL_RenderFillRect(ctx->renderer, &cell);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Run a distributed simulation with a window on rank 0
+ * 
+ * Rank 0 handles the events and broadcasts whether to go on and how many
+ * generations to run per frame; every rank runs exactly that many, so the
+ * ranks stay in step. The window shows the whole board downsampled to at
+ * most DIST_VIEW_SIZE pixels per side; cells cannot be edited in it.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_SDL or GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t dist_run_simulation(gol_context_t *ctx) {
+    const gol_dist_t *dist = ctx->dist;
+    bool root = dist->rank == 0;
+    size_t board_rows = ctx->config.rows, board_cols = ctx->config.cols;
+    size_t longest = board_rows > board_cols ? board_rows : board_cols;
+    size_t scale = (longest + DIST_VIEW_SIZE - 1) / DIST_VIEW_SIZE;
+    size_t rows = (board_rows + scale - 1) / scale, cols = (board_cols + scale - 1) / scale;
+    size_t view_longest = rows > cols ? rows : cols;
+    int zoom = view_longest * CELL_SIZE <= DIST_VIEW_SIZE ? CELL_SIZE
+                                                         : (int)(DIST_VIEW_SIZE / view_longest);
+    if (zoom < 1) zoom = 1;
+    
+    uint8_t *view = malloc(rows * cols);
+    gol_result_t result = view ? GOL_SUCCESS : GOL_ERROR_MEMORY;
+    bool window = false;
+    if (result == GOL_SUCCESS && root) {
+        result = initialize_sdl_view(ctx, rows, cols, zoom);
+        window = result == GOL_SUCCESS;
+    }
+    result = dist_agree(ctx, result);
+    if (result != GOL_SUCCESS) {
+        if (window) cleanup_sdl(ctx);
+        free(view);
+        return result;
+    }
+    
+    /* Broadcast every frame: keep running, generations per frame */
+    unsigned int control[2] = { 1, ctx->config.gens_per_frame };
+    gol_controls_t controls = { .gens_per_frame = control[1] };
+    if (root) update_window_title(ctx, &controls, ctx->generation);
+    
+    while (control[0]) {
+        Uint32 frame_start = root ? SDL_GetTicks() : 0;
+        SDL_Event event;
+        while (root && SDL_PollEvent(&event)) {
+            if (event.type == SDL_QUIT) {
+                control[0] = 0;
+            } else if (event.type == SDL_KEYDOWN) {
+                SDL_Keycode key = event.key.keysym.sym;
+                if ((key == SDLK_PLUS || key == SDLK_EQUALS || key == SDLK_KP_PLUS) &&
+                    control[1] < MAX_GENS_PER_FRAME) {
+                    controls.gens_per_frame = control[1] *= 2;
+                    update_window_title(ctx, &controls, ctx->generation);
+                } else if ((key == SDLK_MINUS || key == SDLK_KP_MINUS) && control[1] > 1) {
+                    controls.gens_per_frame = control[1] /= 2;
+                    update_window_title(ctx, &controls, ctx->generation);
+                }
+            }
+        }
+        MPI_Bcast(control, 2, MPI_UNSIGNED, 0, dist->comm);
+        if (!control[0]) break;
+        
+        dist_gather_view(ctx, view, rows, cols, scale);
+        if (root) {
+            dist_draw_view(ctx, view, rows, cols, zoom);
+            SDL_RenderPresent(ctx->renderer);
+        }
+        
+        for (unsigned int i = 0; i < control[1]; i++) {
+            simulate_step(ctx);
+            if (ctx->config.steps > 0 && ctx->generation >= ctx->config.steps) {
+                control[0] = 0;
+                break;
+            }
+        }
+        
+        Uint32 frame_time = root ? SDL_GetTicks() - frame_start : FRAME_DELAY_MS;
+        if (frame_time < FRAME_DELAY_MS) {
+            SDL_Delay(FRAME_DELAY_MS - frame_time);
+        }
+    }
+    
+    if (root) cleanup_sdl(ctx);
+    free(view);
+    return GOL_SUCCESS;
+}
+#endif
+
+/*
+ * Pattern files. RLE is decoded and encoded one character at a time, so
+ * neither side ever holds the whole pattern. Macrocell files describe a
+ * HashLife quadtree directly; with the HashLife engine their nodes become
+ * canonical nodes of the running universe without visiting single cells.
+ * A pattern placed at (x, y) has its RLE top-left corner, or its Macrocell
+ * root centre, at board cell (x, y).
+ */
+
+/**
+ * @brief Check a rule string from a pattern file against the configured rule
+ * @param ctx Game context
+ * @param filename Pattern path, for the error message
+ * @param rule Rule in B/S or S/B notation
+ * @return true if the pattern was made for the rule the board runs
+ */
+static bool pattern_rule_supported(const gol_context_t *ctx, const char *filename,
+                                   const char *rule) {
+    gol_rule_t pattern_rule;
+    if (!rule_parse(rule, &pattern_rule)) {
+        fprintf(stderr, "Error: Pattern '%s' uses the unknown rule '%s'\n", filename, rule);
+        return false;
+    }
+    if (pattern_rule.birth != ctx->config.rule.birth ||
+        pattern_rule.survive != ctx->config.rule.survive) {
+        fprintf(stderr, "Error: Pattern '%s' is for rule %s, but the board runs %s\n",
+                filename, pattern_rule.name, ctx->config.rule.name);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Merge the live cells of two nodes of the same level
+ * @param hl HashLife state
+ * @param a First node
+ * @param b Second node
+ * @return Canonical node alive wherever either input is
+ */
+static hl_node_t *hl_or(gol_hashlife_t *hl, hl_node_t *a, hl_node_t *b) {
+    if (a->population == 0 || a == b) {
+        return b;
+    }
+    if (b->population == 0) {
+        return a;
+    }
+    if (a->level == 0) {
+        return &hl->leaf[CELL_ALIVE];
+    }
+    
+    return hl_find(hl, hl_or(hl, a->nw, b->nw), hl_or(hl, a->ne, b->ne),
+                   hl_or(hl, a->sw, b->sw), hl_or(hl, a->se, b->se));
+}
+
+/**
+ * @brief Merge a node into an aligned square of a larger node
+ * @param hl HashLife state
+ * @param node Node to merge into
+ * @param x Column of the square relative to the node, a multiple of its size
+ * @param y Row of the square relative to the node, a multiple of its size
+ * @param sub Node to merge, at most as large as the node
+ * @return Canonical node with the square merged
+ */
+static hl_node_t *hl_paste(gol_hashlife_t *hl, hl_node_t *node, uint64_t x, uint64_t y,
+                           hl_node_t *sub) {
+    if (node->level == sub->level) {
+        return hl_or(hl, node, sub);
+    }
+    
+    uint64_t half = UINT64_C(1) << (node->level - 1);
+    hl_node_t *nw = node->nw, *ne = node->ne, *sw = node->sw, *se = node->se;
+    if (y < half) {
+        if (x < half) nw = hl_paste(hl, nw, x, y, sub);
+        else ne = hl_paste(hl, ne, x - half, y, sub);
+    } else {
+        if (x < half) sw = hl_paste(hl, sw, x, y - half, sub);
+        else se = hl_paste(hl, se, x - half, y - half, sub);
+    }
+    return hl_find(hl, nw, ne, sw, se);
+}
+
+/**
+ * @brief Merge a node into the universe at any position
+ * 
+ * Squares aligned to their own size are merged whole; others are split
+ * into their children, so offsets that are multiples of a large power of
+ * two keep the import at node granularity.
+ * 
+ * @param hl HashLife state
+ * @param sub Node to merge, from the same node store
+ * @param x Universe column of the node's top-left corner
+ * @param y Universe row of the node's top-left corner
+ */
+static void hl_place(gol_hashlife_t *hl, hl_node_t *sub, int64_t x, int64_t y) {
+    if (sub->population == 0) {
+        return;
+    }
+    
+    int64_t size = INT64_C(1) << sub->level;
+    if (((uint64_t)x | (uint64_t)y) & (uint64_t)(size - 1)) {
+        int64_t half = size / 2;
+        hl_place(hl, sub->nw, x, y);
+        hl_place(hl, sub->ne, x + half, y);
+        hl_place(hl, sub->sw, x, y + half);
+        hl_place(hl, sub->se, x + half, y + half);
+        return;
+    }
+    
+    for (;;) {
+        int64_t half = (int64_t)hl_root_half(hl);
+        if (hl->root->level > sub->level && x >= -half && y >= -half &&
+            x <= half - size && y <= half - size) {
+            break;
+        }
+        hl->root = hl_expand(hl, hl->root);
+    }
+    
+    uint64_t half = hl_root_half(hl);
+    hl->root = hl_paste(hl, hl->root, (uint64_t)x + half, (uint64_t)y + half, sub);
+}
+
+/**
+ * @brief Bring a pattern cell to life
+ * @param ctx Game context
+ * @param x Board column, may lie outside the board
+ * @param y Board row, may lie outside the board
+ */
+static void pattern_set_cell(gol_context_t *ctx, int64_t x, int64_t y) {
+    if (ctx->engine == &hashlife_engine) {
+        /* The HashLife universe is unbounded, so nothing is clipped */
+        gol_hashlife_t *hl = ctx->hashlife;
+        hl_place(hl, &hl->leaf[CELL_ALIVE], x, y);
+        return;
+    }
+    
+    /* Cells outside the local block belong to other ranks, or to no board at all */
+    x -= (int64_t)ctx->origin_col;
+    y -= (int64_t)ctx->origin_row;
+    if (x >= 0 && y >= 0 && (uint64_t)x < ctx->cols && (uint64_t)y < ctx->rows) {
+        set_cell(ctx, (size_t)y, (size_t)x, true);
+    }
+}
+
+/**
+ * @brief Bring the live cells of a node to life on the board
+ * @param ctx Game context
+ * @param node Node to paint
+ * @param x Local column of the node's top-left corner
+ * @param y Local row of the node's top-left corner
+ */
+static void pattern_paint_node(gol_context_t *ctx, const hl_node_t *node, int64_t x, int64_t y) {
+    int64_t size = INT64_C(1) << node->level;
+    if (node->population == 0 || x >= (int64_t)ctx->cols || y >= (int64_t)ctx->rows ||
+        x + size <= 0 || y + size <= 0) {
+        return;
+    }
+    if (node->level == 0) {
+        set_cell(ctx, (size_t)y, (size_t)x, true);
+        return;
+    }
+    
+    int64_t half = size / 2;
+    pattern_paint_node(ctx, node->nw, x, y);
+    pattern_paint_node(ctx, node->ne, x + half, y);
+    pattern_paint_node(ctx, node->sw, x, y + half);
+    pattern_paint_node(ctx, node->se, x + half, y + half);
+}
+
+/**
+ * @brief Read the rest of a line, keeping as much as fits
+ * @param file Input file
+ * @param buffer Output buffer, always terminated
+ * @param size Buffer size
+ */
+static void pattern_read_line(FILE *file, char *buffer, size_t size) {
+    size_t length = 0;
+    int c;
+    while ((c = getc(file)) != EOF && c != '\n') {
+        if (length + 1 < size) {
+            buffer[length++] = (char)c;
+        }
+    }
+    buffer[length] = '\0';
+}
+
+/**
+ * @brief Decode an RLE pattern onto the board
+ * @param ctx Game context
+ * @param file Input file, positioned at the start
+ * @param filename File name for messages
+ * @param x Board column of the pattern's top-left corner
+ * @param y Board row of the pattern's top-left corner
+ * @return GOL_SUCCESS on success, GOL_ERROR_CONFIG on a malformed file
+ */
+static gol_result_t pattern_read_rle(gol_context_t *ctx, FILE *file, const char *filename,
+                                     int64_t x, int64_t y) {
+    char buffer[BUFFER_SIZE];
+    int64_t col = 0, row = 0;
+    uint64_t count = 0;
+    bool line_start = true, started = false;
+    int c;
+    
+    while ((c = getc(file)) != EOF) {
+        if (line_start && (c == '#' || (c == 'x' && !started))) {
+            pattern_read_line(file, buffer, sizeof(buffer));
+            
+            /* Header: x = <width>, y = <height>[, rule = <rule>] */
+            const char *rule = c == 'x' ? strstr(buffer, "rule") : NULL;
+            if (rule) {
+                char name[MAX_CONFIG_LENGTH];
+                if (sscanf(rule, "rule = %199[^, \t\r]", name) != 1) {
+                    fprintf(stderr, "Error: Pattern '%s' has a malformed rule\n", filename);
+                    return GOL_ERROR_CONFIG;
+                }
+                if (!pattern_rule_supported(ctx, filename, name)) {
+                    return GOL_ERROR_CONFIG;
+                }
+            }
+            continue;
+        }
+        line_start = c == '\n';
+        
+        if (c >= '0' && c <= '9') {
+            if (count > (UINT64_MAX - 9) / 10) {
+                fprintf(stderr, "Error: Run length too large in pattern '%s'\n", filename);
+                return GOL_ERROR_CONFIG;
+            }
+            count = count * 10 + (uint64_t)(c - '0');
+            continue;
+        }
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            continue;
+        }
+        
+        int64_t run = count ? (int64_t)count : 1;
+        count = 0;
+        started = true;
+        if (c == '!') {
+            break;
+        } else if (c == 'b' || c == '.') {
+            col += run;
+        } else if (c == '$') {
+            row += run;
+            col = 0;
+        } else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+            /* 'o' is alive; other states of multi-state files count as alive too */
+            for (int64_t i = 0; i < run; i++) {
+                pattern_set_cell(ctx, x + col + i, y + row);
+            }
+            col += run;
+        } else {
+            fprintf(stderr, "Error: Unexpected '%c' in pattern '%s'\n", c, filename);
+            return GOL_ERROR_CONFIG;
+        }
+    }
+    
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Build a level 3 node from an 8x8 bitmap
+ * @param hl HashLife state
+ * @param bits Row y, column x is bit y * 8 + x
+ * @return Canonical node
+ */
+static hl_node_t *hl_from_bitmap(gol_hashlife_t *hl, uint64_t bits) {
+    hl_node_t *quads[4];
+    for (unsigned int q = 0; q < 4; q++) {
+        hl_node_t *cells[4];
+        for (unsigned int c = 0; c < 4; c++) {
+            unsigned int x = (q & 1) * 4 + (c & 1) * 2, y = (q >> 1) * 4 + (c >> 1) * 2;
+            unsigned int top = (unsigned int)(bits >> (y * 8 + x)) & 3u;
+            unsigned int bottom = (unsigned int)(bits >> (y * 8 + 8 + x)) & 3u;
+            cells[c] = hl->level1[top | bottom << 2];
+        }
+        quads[q] = hl_find(hl, cells[0], cells[1], cells[2], cells[3]);
+    }
+    return hl_find(hl, quads[0], quads[1], quads[2], quads[3]);
+}
+
+/**
+ * @brief Decode a Macrocell pattern onto the board
+ * 
+ * Leaf lines ('.', '*' and '$') are 8x8 squares; node lines "k a b c d"
+ * give a level k node by the 1-based line numbers of its children, 0
+ * meaning empty. The last node is the root.
+ * 
+ * @param ctx Game context
+ * @param file Input file, positioned after the [M2] line
+ * @param filename File name for messages
+ * @param x Board column of the root's centre
+ * @param y Board row of the root's centre
+ * @return GOL_SUCCESS on success, an error code otherwise
+ */
+static gol_result_t pattern_read_macrocell(gol_context_t *ctx, FILE *file, const char *filename,
+                                           int64_t x, int64_t y) {
+    /* Other engines decode into a scratch store and paint its cells */
+    bool direct = ctx->engine == &hashlife_engine;
+    gol_hashlife_t *hl = direct ? ctx->hashlife
+                                : hl_create(&ctx->config.rule, 0, ctx->config.hashlife_mem_mb);
+    if (!hl) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    char buffer[BUFFER_SIZE];
+    hl_node_t **nodes = NULL;
+    size_t count = 0, capacity = 0;
+    gol_result_t result = GOL_SUCCESS;
+    
+    while (result == GOL_SUCCESS && fgets(buffer, sizeof(buffer), file)) {
+        hl_node_t *node;
+        unsigned int level;
+        size_t child[4];
+        
+        if (buffer[0] == '#') {
+            char rule[MAX_CONFIG_LENGTH];
+            if (sscanf(buffer, "#R %199s", rule) == 1 &&
+                !pattern_rule_supported(ctx, filename, rule)) {
+                result = GOL_ERROR_CONFIG;
+            }
+            continue;
+        } else if (buffer[0] == '.' || buffer[0] == '*' || buffer[0] == '$') {
+            uint64_t bits = 0;
+            unsigned int col = 0, row = 0;
+            for (const char *p = buffer; *p && *p != '\n' && row < 8; p++) {
+                if (*p == '$') {
+                    row++;
+                    col = 0;
+                } else if (col < 8) {
+                    if (*p == '*') bits |= UINT64_C(1) << (row * 8 + col);
+                    col++;
+                }
+            }
+            node = hl_from_bitmap(hl, bits);
+        } else if (sscanf(buffer, "%u %zu %zu %zu %zu", &level,
+                          &child[0], &child[1], &child[2], &child[3]) == 5) {
+            if (level == 0 || level > HASHLIFE_MAX_LEVEL) {
+                fprintf(stderr, "Error: Bad node level in pattern '%s'\n", filename);
+                result = GOL_ERROR_CONFIG;
+                continue;
+            }
+            
+            hl_node_t *quads[4];
+            for (unsigned int q = 0; q < 4; q++) {
+                if (level == 1) {
+                    quads[q] = &hl->leaf[child[q] != 0];
+                } else if (child[q] == 0) {
+                    quads[q] = hl->empty[level - 1];
+                } else if (child[q] <= count && nodes[child[q] - 1]->level == level - 1) {
+                    quads[q] = nodes[child[q] - 1];
+                } else {
+                    fprintf(stderr, "Error: Bad child reference in pattern '%s'\n", filename);
+                    result = GOL_ERROR_CONFIG;
+                    break;
+                }
+            }
+            if (result != GOL_SUCCESS) {
+                continue;
+            }
+            node = hl_find(hl, quads[0], quads[1], quads[2], quads[3]);
+        } else {
+            continue;
+        }
+        
+        if (count == capacity) {
+            size_t grown = capacity ? capacity * 2 : 1024;
+            hl_node_t **resized = realloc(nodes, grown * sizeof(*nodes));
+            if (!resized) {
+                result = GOL_ERROR_MEMORY;
+                continue;
+            }
+            nodes = resized;
+            capacity = grown;
+        }
+        nodes[count++] = node;
+    }
+    
+    if (result == GOL_SUCCESS && count > 0) {
+        hl_node_t *root = nodes[count - 1];
+        int64_t half = INT64_C(1) << (root->level - 1);
+        int64_t left, top;
+        if (__builtin_sub_overflow(x, half, &left) || __builtin_sub_overflow(y, half, &top)) {
+            fprintf(stderr, "Error: Pattern '%s' does not fit in the universe\n", filename);
+            result = GOL_ERROR_CONFIG;
+        } else if (direct) {
+            hl_place(hl, root, left, top);
+        } else {
+            pattern_paint_node(ctx, root, left - (int64_t)ctx->origin_col,
+                               top - (int64_t)ctx->origin_row);
+        }
+    }
+    
+    free(nodes);
+    if (direct) {
+        /* Only now is every imported node reachable from the root */
+        hl_collect(hl, false);
+    } else {
+        hl_destroy(hl);
+    }
+    return result;
+}
+
+/**
+ * @brief Place every @pattern of the configuration on the board
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, an error code otherwise
+ */
+static gol_result_t place_patterns(gol_context_t *ctx) {
+    for (size_t i = 0; i < ctx->config.pattern_count; i++) {
+        const gol_pattern_t *pattern = &ctx->config.patterns[i];
+        FILE *file = fopen(pattern->path, "r");
+        if (!file) {
+            fprintf(stderr, "Error: Cannot open pattern '%s': %s\n",
+                    pattern->path, strerror(errno));
+            return GOL_ERROR_FILE;
+        }
+        
+        /* The format is told by content, not by file name */
+        char header[sizeof(MACROCELL_HEADER)];
+        bool macrocell = fgets(header, sizeof(header), file) &&
+                         strcmp(header, MACROCELL_HEADER) == 0;
+        gol_result_t result;
+        if (macrocell) {
+            pattern_read_line(file, header, sizeof(header));
+            result = pattern_read_macrocell(ctx, file, pattern->path, pattern->x, pattern->y);
+        } else {
+            rewind(file);
+            result = pattern_read_rle(ctx, file, pattern->path, pattern->x, pattern->y);
+        }
+        fclose(file);
+        
+        if (result != GOL_SUCCESS) {
+            return result;
+        }
+    }
+    
+    if (ctx->engine == &hashlife_engine) {
+        /* Loads collect only once, here, after every cell is in place */
+        gol_hashlife_t *hl = ctx->hashlife;
+        if (!hl_fits(hl)) {
+            fprintf(stderr, "Error: The HashLife board needs more than @hashlife_mem "
+                    "(%zu MiB)\n", hl->memory_budget >> 20);
+            return GOL_ERROR_MEMORY;
+        }
+        ctx->stats.population = hl->root->population;
+    }
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Write one RLE run, wrapping lines before they get too long
+ * @param file Output file
+ * @param run Run length
+ * @param tag Run tag: 'b', 'o', '$' or '!'
+ * @param line_length Characters on the current line, updated
+ */
+static void rle_write_run(FILE *file, uint64_t run, char tag, size_t *line_length) {
+    char token[24];
+    int length = run > 1 ? snprintf(token, sizeof(token), "%" PRIu64 "%c", run, tag)
+                         : snprintf(token, sizeof(token), "%c", tag);
+    if (*line_length + (size_t)length > RLE_LINE_LENGTH) {
+        putc('\n', file);
+        *line_length = 0;
+    }
+    fputs(token, file);
+    *line_length += (size_t)length;
+}
+
+/**
+ * @brief Encode the board as RLE
+ * @param ctx Game context
+ * @param file Output file
+ */
+static void pattern_write_rle(const gol_context_t *ctx, FILE *file) {
+    fprintf(file, "#C Generation %" PRIu64 "\n", ctx->generation);
+    fprintf(file, "x = %zu, y = %zu, rule = %s\n", ctx->cols, ctx->rows, ctx->config.rule.name);
+    
+    size_t line_length = 0;
+    uint64_t pending_rows = 0;
+    for (size_t i = 0; i < ctx->rows; i++) {
+        uint64_t dead = 0;
+        for (size_t j = 0; j < ctx->cols;) {
+            /* Measure the run starting here */
+            bool alive = get_cell(ctx, i, j);
+            size_t end = j + 1;
+            while (end < ctx->cols && get_cell(ctx, i, end) == alive) {
+                end++;
+            }
+            if (!alive) {
+                dead = end - j;
+            } else {
+                /* Rows and dead runs are only written once something follows them */
+                if (pending_rows > 0) {
+                    rle_write_run(file, pending_rows, '$', &line_length);
+                    pending_rows = 0;
+                }
+                if (dead > 0) {
+                    rle_write_run(file, dead, 'b', &line_length);
+                    dead = 0;
+                }
+                rle_write_run(file, end - j, 'o', &line_length);
+            }
+            j = end;
+        }
+        pending_rows++;
+    }
+    rle_write_run(file, 1, '!', &line_length);
+    putc('\n', file);
+}
+
+/**
+ * @brief Build a node from the board cells it covers
+ * @param hl HashLife state
+ * @param ctx Game context
+ * @param level Node level
+ * @param x Board column of the node's top-left corner
+ * @param y Board row of the node's top-left corner
+ * @return Canonical node
+ */
+static hl_node_t *hl_build(gol_hashlife_t *hl, const gol_context_t *ctx, unsigned int level,
+                           int64_t x, int64_t y) {
+    int64_t size = INT64_C(1) << level;
+    if (x >= (int64_t)ctx->cols || y >= (int64_t)ctx->rows || x + size <= 0 || y + size <= 0) {
+        return hl->empty[level];
+    }
+    if (level == 0) {
+        return &hl->leaf[get_cell(ctx, (size_t)y, (size_t)x)];
+    }
+    
+    int64_t half = size / 2;
+    return hl_find(hl, hl_build(hl, ctx, level - 1, x, y),
+                   hl_build(hl, ctx, level - 1, x + half, y),
+                   hl_build(hl, ctx, level - 1, x, y + half),
+                   hl_build(hl, ctx, level - 1, x + half, y + half));
+}
+
+/**
+ * @brief Get a cell of a node
+ * @param node Node of any level
+ * @param x Column relative to the node's top-left corner
+ * @param y Row relative to the node's top-left corner
+ * @return true if alive
+ */
+static bool hl_node_cell(const hl_node_t *node, unsigned int x, unsigned int y) {
+    while (node->level > 0) {
+        unsigned int half = 1u << (node->level - 1);
+        if (y < half) {
+            node = x < half ? node->nw : node->ne;
+        } else {
+            node = x < half ? node->sw : node->se;
+            y -= half;
+        }
+        if (x >= half) x -= half;
+    }
+    return node->population != 0;
+}
+
+/* Line numbers already given to written Macrocell nodes */
+typedef struct {
+    const hl_node_t **keys;
+    size_t *values;
+    size_t capacity;   /* Power of two */
+    size_t count;
+    bool failed;       /* An allocation failed, the output is incomplete */
+} gol_macrocell_index_t;
+
+/**
+ * @brief Find the slot of a node in the index
+ * @param index Node index
+ * @param node Node to look up
+ * @return Slot holding the node, or the empty slot where it would go
+ */
+static size_t macrocell_slot(const gol_macrocell_index_t *index, const hl_node_t *node) {
+    size_t slot = ((uintptr_t)node / sizeof(hl_node_t)) * 0x9E3779B97F4A7C15u;
+    for (slot &= index->capacity - 1; index->keys[slot] && index->keys[slot] != node;
+         slot = (slot + 1) & (index->capacity - 1)) {
+    }
+    return slot;
+}
+
+/**
+ * @brief Write a node and its children, each only once
+ * @param index Node index, grown as needed
+ * @param node Node of level >= 3
+ * @param file Output file
+ * @return Line number of the node, 0 for an empty node
+ */
+static size_t macrocell_write_node(gol_macrocell_index_t *index, const hl_node_t *node,
+                                   FILE *file) {
+    if (node->population == 0) {
+        return 0;
+    }
+    size_t slot = macrocell_slot(index, node);
+    if (index->keys[slot]) {
+        return index->values[slot];
+    }
+    
+    if (node->level == HASHLIFE_MIN_LEVEL) {
+        for (unsigned int y = 0; y < 8; y++) {
+            char row[9];
+            int length = 0;
+            for (unsigned int x = 0; x < 8; x++) {
+                row[x] = hl_node_cell(node, x, y) ? '*' : '.';
+                if (row[x] == '*') length = (int)x + 1;
+            }
+            fprintf(file, "%.*s$", length, row);
+        }
+        putc('\n', file);
+    } else {
+        size_t nw = macrocell_write_node(index, node->nw, file);
+        size_t ne = macrocell_write_node(index, node->ne, file);
+        size_t sw = macrocell_write_node(index, node->sw, file);
+        size_t se = macrocell_write_node(index, node->se, file);
+        fprintf(file, "%u %zu %zu %zu %zu\n", node->level, nw, ne, sw, se);
+    }
+    
+    /* Children may have grown the index, so the slot is looked up again */
+    if (2 * (index->count + 1) > index->capacity) {
+        size_t capacity = index->capacity * 2;
+        const hl_node_t **keys = calloc(capacity, sizeof(*keys));
+        size_t *values = calloc(capacity, sizeof(*values));
+        if (!keys || !values) {
+            free(keys);
+            free(values);
+            index->failed = true;
+            return 0;
+        }
+        gol_macrocell_index_t grown = {keys, values, capacity, index->count, false};
+        for (size_t i = 0; i < index->capacity; i++) {
+            if (index->keys[i]) {
+                size_t moved = macrocell_slot(&grown, index->keys[i]);
+                keys[moved] = index->keys[i];
+                values[moved] = index->values[i];
+            }
+        }
+        free(index->keys);
+        free(index->values);
+        *index = grown;
+    }
+    slot = macrocell_slot(index, node);
+    index->keys[slot] = node;
+    index->values[slot] = ++index->count;
+    return index->count;
+}
+
+/**
+ * @brief Encode the universe as Macrocell
+ * 
+ * HashLife writes its own tree, including cells outside the board; other
+ * engines build one from the board, whose cell (0, 0) becomes the root centre.
+ * 
+ * @param ctx Game context
+ * @param file Output file
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t pattern_write_macrocell(const gol_context_t *ctx, FILE *file) {
+    gol_hashlife_t *hl = ctx->hashlife;
+    gol_hashlife_t *scratch = NULL;
+    const hl_node_t *root;
+    if (ctx->engine == &hashlife_engine) {
+        root = hl->root;
+    } else {
+        scratch = hl_create(&ctx->config.rule, 0, ctx->config.hashlife_mem_mb);
+        if (!scratch) {
+            return GOL_ERROR_MEMORY;
+        }
+        unsigned int level = HASHLIFE_MIN_LEVEL;
+        while ((UINT64_C(1) << (level - 1)) < ctx->rows ||
+               (UINT64_C(1) << (level - 1)) < ctx->cols) {
+            level++;
+        }
+        int64_t origin = -(INT64_C(1) << (level - 1));
+        root = hl_build(scratch, ctx, level, origin, origin);
+    }
+    
+    fprintf(file, "%s (game_of_life)\n", MACROCELL_HEADER);
+    fprintf(file, "#R %s\n", ctx->config.rule.name);
+    fprintf(file, "#C Generation %" PRIu64 "\n", ctx->generation);
+    
+    gol_result_t result = GOL_SUCCESS;
+    gol_macrocell_index_t index = {0};
+    index.capacity = 1024;
+    index.keys = calloc(index.capacity, sizeof(*index.keys));
+    index.values = calloc(index.capacity, sizeof(*index.values));
+    if (index.keys && index.values) {
+        macrocell_write_node(&index, root, file);
+    }
+    if (!index.keys || !index.values || index.failed) {
+        result = GOL_ERROR_MEMORY;
+    }
+    
+    free(index.keys);
+    free(index.values);
+    hl_destroy(scratch);
+    return result;
+}
+
+/**
+ * @brief Save the pattern, as Macrocell if the name ends in .mc and RLE otherwise
+ * @param ctx Game context
+ * @param filename Output file
+ * @return GOL_SUCCESS on success, an error code otherwise
+ */
+static gol_result_t pattern_export(const gol_context_t *ctx, const char *filename) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create pattern '%s': %s\n", filename, strerror(errno));
+        return GOL_ERROR_FILE;
+    }
+    
+    size_t length = strlen(filename);
+    gol_result_t result = GOL_SUCCESS;
+    if (length >= 3 && strcmp(filename + length - 3, ".mc") == 0) {
+        result = pattern_write_macrocell(ctx, file);
+    } else {
+        pattern_write_rle(ctx, file);
+    }
+    
+    if ((ferror(file) | fclose(file)) != 0 && result == GOL_SUCCESS) {
+        fprintf(stderr, "Error: Cannot write pattern '%s': %s\n", filename, strerror(errno));
+        result = GOL_ERROR_FILE;
+    }
+    return result;
+}
+
+/*
+ * Frame export. Every @frame_every generations, the simulating thread
+ * copies the board as bit-packed rows into a free slot of a small ring
+ * and returns; an encoder thread turns the slots into images. When the
+ * encoder falls behind and every slot is taken, the frame is dropped
+ * rather than waiting, so a slow disk or encoder never delays a step.
+ */
+
+/* How exported frames are written */
+typedef enum {
+    FRAME_STREAM,     /* PPM images back to back, to a file or a |command */
+    FRAME_PPM_FILES,  /* One PPM file per frame */
+    FRAME_PNG_FILES   /* One PNG file per frame */
+} gol_frame_format_t;
+
+/* Frame export state, shared by the simulating thread and the encoder */
+typedef struct gol_frames {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;           /* Signals a filled slot or shutdown */
+    gol_frame_format_t format;
+    const char *target;            /* File name pattern or |command, from the config */
+    FILE *stream;                  /* FRAME_STREAM output, NULL otherwise */
+    bool pipe;                     /* stream was opened with popen() */
+    uint64_t *slots;               /* capacity boards of rows * words words */
+    size_t capacity;               /* Slots in the ring, @frame_buffers */
+    size_t rows;
+    size_t cols;
+    size_t words;                  /* Words per board row */
+    size_t scale;                  /* Pixels per cell side */
+    uint8_t *pixels;               /* Encoder scratch for one image */
+    size_t head;                   /* Slot the next frame is copied into */
+    size_t count;                  /* Slots filled and not yet encoded */
+    bool shutdown;                 /* Encode what is left, then stop */
+    bool failed;                   /* A write failed; later frames are discarded */
+    uint64_t written;              /* Frames encoded, also the next file number */
+    uint64_t dropped;              /* Frames lost to a full ring */
+} gol_frames_t;
+
+/**
+ * @brief Build the file name of a frame
+ * 
+ * The pattern holds at most one counter, %d with an optional zero flag
+ * and width as in printf; other % signs are not allowed.
+ * 
+ * @param pattern File name pattern, e.g. "frames/%06d.png"
+ * @param number Frame number
+ * @param out Output buffer
+ * @param size Size of out
+ * @return true if the pattern is valid and the name fits
+ */
+static bool frames_file_name(const char *pattern, uint64_t number, char *out, size_t size) {
+    const char *percent = strchr(pattern, '%');
+    if (!percent) {
+        return (size_t)snprintf(out, size, "%s", pattern) < size;
+    }
+    
+    const char *spec = percent + 1;
+    bool zero = *spec == '0';
+    if (zero) spec++;
+    int width = 0;
+    while (*spec >= '0' && *spec <= '9' && width < 100) {
+        width = width * 10 + (*spec++ - '0');
+    }
+    if (*spec != 'd' || width >= 100 || strchr(spec, '%')) {
+        return false;
+    }
+    
+    int prefix = (int)(percent - pattern);
+    int length = zero ? snprintf(out, size, "%.*s%0*" PRIu64 "%s", prefix, pattern, width,
+                                 number, spec + 1)
+                      : snprintf(out, size, "%.*s%*" PRIu64 "%s", prefix, pattern, width,
+                                 number, spec + 1);
+    return length >= 0 && (size_t)length < size;
+}
+
+/**
+ * @brief Check whether a path ends in a suffix
+ * @param path Path
+ * @param suffix Suffix, e.g. ".png"
+ * @return true if it does
+ */
+static bool path_has_suffix(const char *path, const char *suffix) {
+    size_t length = strlen(path), suffix_length = strlen(suffix);
+    return length >= suffix_length && strcmp(path + length - suffix_length, suffix) == 0;
+}
+
+/**
+ * @brief Get the CRC-32 table used by PNG chunks, built on first use
+ * @return Pointer to 256 entries
+ */
+static const uint32_t *png_crc_table(void) {
+    static uint32_t table[256];
+    static bool built = false;
+    
+    if (!built) {
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? UINT32_C(0xEDB88320) ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        built = true;
+    }
+    return table;
+}
+
+/**
+ * @brief Write bytes of a PNG chunk and add them to its CRC
+ * @param file Output file
+ * @param crc Running CRC, before the final inversion
+ * @param data Bytes to write
+ * @param size Number of bytes
+ */
+static void png_write(FILE *file, uint32_t *crc, const void *data, size_t size) {
+    const uint32_t *table = png_crc_table();
+    const uint8_t *bytes = data;
+    uint32_t c = *crc;
+    
+    for (size_t i = 0; i < size; i++) {
+        c = table[(c ^ bytes[i]) & 0xFF] ^ (c >> 8);
+    }
+    *crc = c;
+    fwrite(data, 1, size, file);
+}
+
+/**
+ * @brief Store a 32-bit value in network byte order
+ * @param out Four output bytes
+ * @param value Value
+ */
+static inline void png_put_u32(uint8_t *out, uint32_t value) {
+    out[0] = (uint8_t)(value >> 24);
+    out[1] = (uint8_t)(value >> 16);
+    out[2] = (uint8_t)(value >> 8);
+    out[3] = (uint8_t)value;
+}
+
+/**
+ * @brief Write a whole PNG chunk: length, type, payload and CRC
+ * @param file Output file
+ * @param type Four-letter chunk type
+ * @param data Payload, may be NULL if size is 0
+ * @param size Payload bytes
+ */
+static void png_write_chunk(FILE *file, const char *type, const void *data, size_t size) {
+    uint8_t word[4];
+    uint32_t crc = ~UINT32_C(0);
+    
+    png_put_u32(word, (uint32_t)size);
+    fwrite(word, 1, sizeof(word), file);
+    png_write(file, &crc, type, 4);
+    png_write(file, &crc, data, size);
+    png_put_u32(word, ~crc);
+    fwrite(word, 1, sizeof(word), file);
+}
+
+/**
+ * @brief Encode one frame as a PNG image
+ * 
+ * The image has one bit per pixel with a two-color palette. Frames are
+ * written as fast as they come, so the image data is stored in
+ * uncompressed deflate blocks rather than compressed; at one bit per
+ * pixel a 4K frame is still only about 1 MiB.
+ * 
+ * @param frames Frame export state
+ * @param file Output file
+ * @param rows Board of the frame, packed like snapshot rows
+ */
+static void frames_write_png(gol_frames_t *frames, FILE *file, const uint64_t *rows) {
+    size_t width = frames->cols * frames->scale, height = frames->rows * frames->scale;
+    size_t line = 1 + (width + 7) / 8;   /* Filter type byte 0, then the pixels */
+    uint8_t *raw = frames->pixels;
+    
+    for (size_t i = 0; i < frames->rows; i++) {
+        const uint64_t *row = rows + i * frames->words;
+        uint8_t *out = raw + i * frames->scale * line;
+        memset(out, 0, line);
+        for (size_t w = 0; w < frames->words; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                size_t x = (w * CELLS_PER_WORD + (size_t)__builtin_ctzll(bits)) * frames->scale;
+                for (size_t end = x + frames->scale; x < end; x++) {
+                    out[1 + x / 8] |= (uint8_t)(0x80 >> (x % 8));
+                }
+            }
+        }
+        for (size_t copy = 1; copy < frames->scale; copy++) {
+            memcpy(out + copy * line, out, line);
+        }
+    }
+    
+    static const uint8_t signature[8] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    fwrite(signature, 1, sizeof(signature), file);
+    
+    uint8_t header[13] = { 0 };
+    png_put_u32(header, (uint32_t)width);
+    png_put_u32(header + 4, (uint32_t)height);
+    header[8] = 1;   /* Bit depth */
+    header[9] = 3;   /* Palette colors */
+    png_write_chunk(file, "IHDR", header, sizeof(header));
+    
+    const uint8_t palette[6] = {
+        (uint8_t)(DEAD_COLOR >> 16), (uint8_t)(DEAD_COLOR >> 8), (uint8_t)DEAD_COLOR,
+        (uint8_t)(ALIVE_COLOR >> 16), (uint8_t)(ALIVE_COLOR >> 8), (uint8_t)ALIVE_COLOR
+    };
+    png_write_chunk(file, "PLTE", palette, sizeof(palette));
+    
+    /* One IDAT chunk: zlib header, stored blocks, Adler-32 of the raw lines */
+    size_t raw_size = height * line;
+    size_t blocks = (raw_size + PNG_STORED_BLOCK - 1) / PNG_STORED_BLOCK;
+    uint8_t word[4];
+    uint32_t crc = ~UINT32_C(0);
+    png_put_u32(word, (uint32_t)(2 + 5 * blocks + raw_size + 4));
+    fwrite(word, 1, sizeof(word), file);
+    png_write(file, &crc, "IDAT", 4);
+    
+    static const uint8_t zlib_header[2] = { 0x78, 0x01 };
+    png_write(file, &crc, zlib_header, sizeof(zlib_header));
+    uint32_t adler_a = 1, adler_b = 0;
+    for (size_t done = 0; done < raw_size; done += PNG_STORED_BLOCK) {
+        size_t size = raw_size - done < PNG_STORED_BLOCK ? raw_size - done : PNG_STORED_BLOCK;
+        uint8_t block[5] = {
+            done + size == raw_size,   /* Final block flag, stored type */
+            (uint8_t)size, (uint8_t)(size >> 8),
+            (uint8_t)~size, (uint8_t)(~size >> 8)
+        };
+        png_write(file, &crc, block, sizeof(block));
+        png_write(file, &crc, raw + done, size);
+        
+        /* Reduced every 4096 bytes, well before the 32-bit sums could overflow */
+        for (size_t i = 0; i < size; i++) {
+            adler_a += raw[done + i];
+            adler_b += adler_a;
+            if ((i & 4095) == 4095) {
+                adler_a %= 65521;
+                adler_b %= 65521;
+            }
+        }
+        adler_a %= 65521;
+        adler_b %= 65521;
+    }
+    png_put_u32(word, adler_b << 16 | adler_a);
+    png_write(file, &crc, word, sizeof(word));
+    png_put_u32(word, ~crc);
+    fwrite(word, 1, sizeof(word), file);
+    
+    png_write_chunk(file, "IEND", NULL, 0);
+}
+
+/**
+ * @brief Encode one frame as a binary PPM image
+ * @param frames Frame export state
+ * @param file Output file
+ * @param rows Board of the frame, packed like snapshot rows
+ */
+static void frames_write_ppm(gol_frames_t *frames, FILE *file, const uint64_t *rows) {
+    size_t width = frames->cols * frames->scale, height = frames->rows * frames->scale;
+    uint8_t *out = frames->pixels;
+    
+    fprintf(file, "P6\n%zu %zu\n255\n", width, height);
+    for (size_t i = 0; i < frames->rows; i++) {
+        const uint64_t *row = rows + i * frames->words;
+        for (size_t x = 0; x < width; x++) {
+            out[3 * x] = (uint8_t)(DEAD_COLOR >> 16);
+            out[3 * x + 1] = (uint8_t)(DEAD_COLOR >> 8);
+            out[3 * x + 2] = (uint8_t)DEAD_COLOR;
+        }
+        for (size_t w = 0; w < frames->words; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                size_t x = (w * CELLS_PER_WORD + (size_t)__builtin_ctzll(bits)) * frames->scale;
+                for (size_t end = x + frames->scale; x < end; x++) {
+                    out[3 * x] = (uint8_t)(ALIVE_COLOR >> 16);
+                    out[3 * x + 1] = (uint8_t)(ALIVE_COLOR >> 8);
+                    out[3 * x + 2] = (uint8_t)ALIVE_COLOR;
+                }
+            }
+        }
+        for (size_t copy = 0; copy < frames->scale; copy++) {
+            fwrite(out, 1, 3 * width, file);
+        }
+    }
+}
+
+/**
+ * @brief Encode the frame in one slot
+ * @param frames Frame export state
+ * @param slot Ring slot holding the frame
+ * @return true on success
+ */
+static bool frames_encode(gol_frames_t *frames, size_t slot) {
+    const uint64_t *rows = frames->slots + slot * frames->rows * frames->words;
+    
+    if (frames->format == FRAME_STREAM) {
+        frames_write_ppm(frames, frames->stream, rows);
+        if (fflush(frames->stream) != 0 || ferror(frames->stream)) {
+            fprintf(stderr, "Error: Cannot write frames to '%s': %s\n", frames->target,
+                    strerror(errno));
+            return false;
+        }
+        return true;
+    }
+    
+    char name[MAX_CONFIG_LENGTH + 32];
+    frames_file_name(frames->target, frames->written, name, sizeof(name));
+    FILE *file = fopen(name, "wb");
+    if (!file) {
+        fprintf(stderr, "Error: Cannot create frame '%s': %s\n", name, strerror(errno));
+        return false;
+    }
+    if (frames->format == FRAME_PNG_FILES) {
+        frames_write_png(frames, file, rows);
+    } else {
+        frames_write_ppm(frames, file, rows);
+    }
+    if ((ferror(file) | fclose(file)) != 0) {
+        fprintf(stderr, "Error: Cannot write frame '%s': %s\n", name, strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Encoder thread body: encode filled slots, oldest first, until shutdown
+ * @param arg Frame export state
+ * @return NULL
+ */
+static void *frames_encoder(void *arg) {
+    gol_frames_t *frames = arg;
+    
+    pthread_mutex_lock(&frames->mutex);
+    for (;;) {
+        while (frames->count == 0 && !frames->shutdown) {
+            pthread_cond_wait(&frames->cond, &frames->mutex);
+        }
+        if (frames->count == 0) break;
+        
+        /* The slot stays counted while it is encoded, so it is not refilled */
+        size_t slot = (frames->head + frames->capacity - frames->count) % frames->capacity;
+        bool failed = frames->failed;
+        pthread_mutex_unlock(&frames->mutex);
+        bool ok = !failed && frames_encode(frames, slot);
+        pthread_mutex_lock(&frames->mutex);
+        
+        if (ok) {
+            frames->written++;
+        } else {
+            frames->failed = true;
+        }
+        frames->count--;
+    }
+    pthread_mutex_unlock(&frames->mutex);
+    return NULL;
+}
+
+/**
+ * @brief Start exporting frames to @frames
+ * 
+ * The current board is exported first if its generation is a multiple
+ * of @frame_every.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, error code otherwise
+ */
+static gol_result_t frames_create(gol_context_t *ctx) {
+    const gol_config_t *config = &ctx->config;
+    size_t scale = config->frame_scale;
+    if (ctx->rows > MAX_FRAME_SIZE / scale || ctx->cols > MAX_FRAME_SIZE / scale) {
+        fprintf(stderr, "Error: Frames of %zux%zu cells at scale %zu exceed %d pixels per side\n",
+                ctx->cols, ctx->rows, scale, MAX_FRAME_SIZE);
+        return GOL_ERROR_CONFIG;
+    }
+    
+    gol_frames_t *frames = calloc(1, sizeof(*frames));
+    if (!frames) {
+        return GOL_ERROR_MEMORY;
+    }
+    frames->target = config->frames_path;
+    frames->rows = ctx->rows;
+    frames->cols = ctx->cols;
+    frames->words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    frames->scale = scale;
+    frames->capacity = config->frame_buffers;
+    if (strchr(frames->target, '%') && frames->target[0] != '|') {
+        frames->format = path_has_suffix(frames->target, ".png") ? FRAME_PNG_FILES
+                                                                 : FRAME_PPM_FILES;
+    } else {
+        frames->format = FRAME_STREAM;
+    }
+    
+    /* The PNG scratch holds a whole image, the PPM one a single line */
+    size_t width = ctx->cols * scale, height = ctx->rows * scale;
+    size_t pixel_bytes = frames->format == FRAME_PNG_FILES ? height * (1 + (width + 7) / 8)
+                                                           : 3 * width;
+    frames->slots = malloc(frames->capacity * ctx->rows * frames->words * sizeof(uint64_t));
+    frames->pixels = malloc(pixel_bytes);
+    if (!frames->slots || !frames->pixels) {
+        free(frames->slots);
+        free(frames->pixels);
+        free(frames);
+        return GOL_ERROR_MEMORY;
+    }
+    
+    if (frames->format == FRAME_STREAM) {
+        if (frames->target[0] == '|') {
+            /* An encoder that exits must not kill the run; writes then fail instead */
+            signal(SIGPIPE, SIG_IGN);
+            frames->stream = popen(frames->target + 1, "w");
+            frames->pipe = true;
+        } else {
+            frames->stream = fopen(frames->target, "wb");
+        }
+        if (!frames->stream) {
+            fprintf(stderr, "Error: Cannot open frame output '%s': %s\n", frames->target,
+                    strerror(errno));
+            free(frames->slots);
+            free(frames->pixels);
+            free(frames);
+            return GOL_ERROR_FILE;
+        }
+    }
+    
+    if (pthread_mutex_init(&frames->mutex, NULL) != 0 ||
+        pthread_cond_init(&frames->cond, NULL) != 0 ||
+        pthread_create(&frames->thread, NULL, frames_encoder, frames) != 0) {
+        fprintf(stderr, "Error: Failed to start the frame encoder thread\n");
+        if (frames->stream) {
+            frames->pipe ? pclose(frames->stream) : fclose(frames->stream);
+        }
+        free(frames->slots);
+        free(frames->pixels);
+        free(frames);
+        return GOL_ERROR_THREAD;
+    }
+    
+    ctx->frames = frames;
+    if (ctx->generation % config->frame_every == 0) {
+        frames_capture(ctx);
+    }
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Finish encoding the frames still queued, then stop the encoder
+ * @param ctx Game context
+ * @return GOL_SUCCESS, or GOL_ERROR_FILE if a frame could not be written
+ */
+static gol_result_t frames_destroy(gol_context_t *ctx) {
+    gol_frames_t *frames = ctx->frames;
+    if (!frames) return GOL_SUCCESS;
+    
+    pthread_mutex_lock(&frames->mutex);
+    frames->shutdown = true;
+    pthread_cond_signal(&frames->cond);
+    pthread_mutex_unlock(&frames->mutex);
+    pthread_join(frames->thread, NULL);
+    
+    bool failed = frames->failed;
+    if (frames->stream) {
+        int status = frames->pipe ? pclose(frames->stream) : fclose(frames->stream);
+        if (status != 0 && !failed) {
+            fprintf(stderr, "Error: Frame output '%s' failed%s\n", frames->target,
+                    frames->pipe ? " (the command exited with an error)" : "");
+            failed = true;
+        }
+    }
+    if (frames->dropped > 0 && !failed) {
+        fprintf(stderr, "Warning: %" PRIu64 " of %" PRIu64 " frames were dropped because the "
+                "encoder fell behind; raise @frame_every or @frame_buffers\n",
+                frames->dropped, frames->dropped + frames->written);
+    }
+    
+    pthread_cond_destroy(&frames->cond);
+    pthread_mutex_destroy(&frames->mutex);
+    free(frames->slots);
+    free(frames->pixels);
+    free(frames);
+    ctx->frames = NULL;
+    return failed ? GOL_ERROR_FILE : GOL_SUCCESS;
+}
+
+/**
+ * @brief Queue the current board as a frame, unless every slot is taken
+ * 
+ * Only the board's packed rows are copied here; the pixels are made by
+ * the encoder thread.
+ * 
+ * @param ctx Game context
+ */
+static void frames_capture(gol_context_t *ctx) {
+    gol_frames_t *frames = ctx->frames;
+    
+    pthread_mutex_lock(&frames->mutex);
+    bool full = frames->count == frames->capacity;
+    bool failed = frames->failed;
+    size_t slot = frames->head;
+    if (full && !failed) {
+        frames->dropped++;
+    }
+    pthread_mutex_unlock(&frames->mutex);
+    if (full || failed) return;
+    
+    /* The encoder never touches the head slot, so it is filled unlocked */
+    read_board_rows(ctx, frames->slots + slot * frames->rows * frames->words, frames->words);
+    
+    pthread_mutex_lock(&frames->mutex);
+    frames->head = (slot + 1) % frames->capacity;
+    frames->count++;
+    pthread_cond_signal(&frames->cond);
+    pthread_mutex_unlock(&frames->mutex);
+}
+
+/**
+ * @brief Export a frame if the last advance reached a multiple of @frame_every
+ * @param ctx Game context
+ * @param generations Generations the board just advanced
+ */
+static void frames_advanced(gol_context_t *ctx, uint64_t generations) {
+    uint64_t every = ctx->config.frame_every;
+    if (ctx->generation / every != (ctx->generation - generations) / every) {
+        frames_capture(ctx);
+    }
+}
+
+/* Thread pool: persistent workers, one barrier round trip per generation */
+
+/**
+ * @brief Initialize a barrier
+ * @param barrier Barrier to initialize
+ * @param count Number of threads that must arrive before it opens
+ * @return true on success
+ */
+static bool barrier_init(gol_barrier_t *barrier, size_t count) {
+    barrier->count = count;
+    barrier->waiting = 0;
+    barrier->phase = 0;
+    
+    if (pthread_mutex_init(&barrier->mutex, NULL) != 0) {
+        return false;
+    }
+    if (pthread_cond_init(&barrier->cond, NULL) != 0) {
+        pthread_mutex_destroy(&barrier->mutex);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Destroy a barrier
+ * @param barrier Barrier to destroy
+ */
+static void barrier_destroy(gol_barrier_t *barrier) {
+    pthread_cond_destroy(&barrier->cond);
+    pthread_mutex_destroy(&barrier->mutex);
+}
+
+/**
+ * @brief Block until all threads of the barrier have arrived
+ * @param barrier Barrier to wait on
+ */
+static void barrier_wait(gol_barrier_t *barrier) {
+    pthread_mutex_lock(&barrier->mutex);
+    
+    unsigned long phase = barrier->phase;
+    if (++barrier->waiting == barrier->count) {
+        barrier->waiting = 0;
+        barrier->phase++;
+        pthread_cond_broadcast(&barrier->cond);
+    } else {
+        while (phase == barrier->phase) {
+            pthread_cond_wait(&barrier->cond, &barrier->mutex);
+        }
+    }
+    
+    pthread_mutex_unlock(&barrier->mutex);
+}
+
+/**
+ * @brief Worker thread body: run each published task until shutdown
+ * @param arg Pointer to a heap-allocated gol_worker_arg_t, freed here
+ * @return NULL
+ */
+static void *thread_pool_worker(void *arg) {
+    gol_worker_arg_t worker = *(gol_worker_arg_t *)arg;
+    gol_thread_pool_t *pool = worker.pool;
+    free(arg);
+    
+    for (;;) {
+        barrier_wait(&pool->start);
+        if (pool->shutdown) break;
+        
+        pool->task(pool->arg, worker.index, pool->count);
+        barrier_wait(&pool->done);
+    }
+    
+    return NULL;
+}
+
+/**
+ * @brief Count the online CPUs
+ * @return Online CPUs capped at MAX_THREADS, or 1 if the count is unknown
+ */
+static unsigned int online_cpus(void) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    if (cpus <= 0) {
+        return 1;
+    }
+    return cpus < MAX_THREADS ? (unsigned int)cpus : MAX_THREADS;
+}
+
+/**
+ * @brief Create a persistent worker pool
+ * @param pool Receives the pool, or NULL when a single thread is requested
+ * @param threads Total number of threads, 0 for one per online CPU
+ * @return GOL_SUCCESS on success, error code otherwise
+ */
+static gol_result_t thread_pool_create(gol_thread_pool_t **pool, unsigned int threads) {
+    *pool = NULL;
+    
+    if (threads == 0) {
+        threads = online_cpus();
+    }
+    if (threads <= 1) {
+        return GOL_SUCCESS;
+    }
+    
+    gol_thread_pool_t *p = calloc(1, sizeof(*p));
+    if (!p) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    p->count = threads;
+    p->threads = calloc(threads - 1, sizeof(pthread_t));
+    if (!p->threads) {
+        free(p);
+        return GOL_ERROR_MEMORY;
+    }
+    
+    if (!barrier_init(&p->start, threads)) {
+        free(p->threads);
+        free(p);
+        return GOL_ERROR_THREAD;
+    }
+    if (!barrier_init(&p->done, threads)) {
+        barrier_destroy(&p->start);
+        free(p->threads);
+        free(p);
+        return GOL_ERROR_THREAD;
+    }
+    
+    for (size_t i = 1; i < threads; i++) {
+        gol_worker_arg_t *arg = malloc(sizeof(*arg));
+        if (arg) {
+            arg->pool = p;
+            arg->index = i;
+        }
+        
+        if (!arg || pthread_create(&p->threads[i - 1], NULL, thread_pool_worker, arg) != 0) {
+            free(arg);
+            fprintf(stderr, "Error: Failed to create worker thread %zu\n", i);
+            
+            /* Shrink the barriers to the threads that exist and stop them */
+            p->count = i;
+            p->start.count = i;
+            p->done.count = i;
+            thread_pool_destroy(p);
+            return GOL_ERROR_THREAD;
+        }
+    }
+    
+    *pool = p;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Stop all workers and free the pool
+ * @param pool Pool to destroy, may be NULL
+ */
+static void thread_pool_destroy(gol_thread_pool_t *pool) {
+    if (!pool) return;
+    
+    pool->shutdown = true;
+    barrier_wait(&pool->start);
+    
+    for (size_t i = 1; i < pool->count; i++) {
+        pthread_join(pool->threads[i - 1], NULL);
+    }
+    
+    barrier_destroy(&pool->start);
+    barrier_destroy(&pool->done);
+    free(pool->threads);
+    free(pool);
+}
+
+/**
+ * @brief Run a task on every pool thread and wait for all of them
+ * @param pool Worker pool
+ * @param task Task to run, called once per thread with its band index
+ * @param arg Argument passed to the task
+ */
+static void thread_pool_run(gol_thread_pool_t *pool, gol_task_fn task, void *arg) {
+    pool->task = task;
+    pool->arg = arg;
+    
+    barrier_wait(&pool->start);
+    task(arg, 0, pool->count);
+    barrier_wait(&pool->done);
+}
+
+/**
+ * @brief Pool task: step one horizontal band of rows
+ * @param arg Game context
+ * @param index Band index
+ * @param count Number of bands
+ */
+static void step_band_task(void *arg, size_t index, size_t count) {
+    gol_context_t *ctx = arg;
+    size_t unit = ctx->engine->band_rows;
+    size_t units = (ctx->rows + unit - 1) / unit;
+    size_t row_begin = units * index / count * unit;
+    size_t row_end = units * (index + 1) / count * unit;
+    
+    if (row_end > ctx->rows) row_end = ctx->rows;
+    if (row_begin < row_end) {
+        ctx->engine->step_rows(ctx, row_begin, row_end);
+    }
+}
+
+/*
+ * Temporal blocking. A plain step streams the whole board through memory
+ * once per generation. A blocked step instead advances each block of rows
+ * all k generations of the step while its rows stay in cache: the block's
+ * rows plus the k rows on either side that reach it within k generations
+ * are copied into scratch rows, and every generation recomputes a range
+ * one row narrower on each side. The overlap is recomputed by both
+ * neighboring blocks, so blocks only read the current generation, write
+ * their own rows of the next one and run on the worker threads like bands.
+ * Rows past a wrapping or reflecting edge are read through the boundary;
+ * past a dead edge only the dead halo row is kept.
+ */
+typedef struct {
+    gol_context_t *ctx;
+    size_t generations;  /* Generations of the step */
+    size_t block_rows;   /* Board rows per block, a multiple of the engine's band rows */
+    size_t slot_bytes;   /* Scratch bytes per thread, two buffers */
+} gol_block_job_t;
+
+/**
+ * @brief Find the board row seen at a row index past the top or bottom edge
+ * @param ctx Game context, with a boundary other than dead
+ * @param row Row index, may be negative or past the last row
+ * @param flip Set if the row is seen reversed left to right
+ * @return Board row
+ */
+static size_t boundary_row(const gol_context_t *ctx, ptrdiff_t row, bool *flip) {
+    ptrdiff_t rows = (ptrdiff_t)ctx->rows;
+    ptrdiff_t turn = row >= 0 ? row / rows : -((rows - 1 - row) / rows);
+    ptrdiff_t offset = row - turn * rows;
+    
+    /* Each crossing of an edge flips a Klein board and reflects a mirrored one */
+    *flip = ctx->config.boundary == BOUNDARY_KLEIN && (turn & 1);
+    if (ctx->config.boundary == BOUNDARY_MIRROR && (turn & 1)) {
+        offset = rows - 1 - offset;
+    }
+    return (size_t)offset;
+}
+
+/**
+ * @brief Advance a band of rows by all generations of a blocked step
+ * @param job Blocked step
+ * @param row_begin First row of the band
+ * @param row_end One past the last row of the band
+ * @param scratch Scratch slot of the calling thread
+ */
+static void block_step_rows(const gol_block_job_t *job, size_t row_begin, size_t row_end,
+                            uint8_t *scratch) {
+    gol_context_t *ctx = job->ctx;
+    const gol_block_ops_t *ops = ctx->engine->block;
+    ptrdiff_t stride = (ptrdiff_t)ops->row_bytes(ctx);
+    ptrdiff_t reach = (ptrdiff_t)job->generations, rows = (ptrdiff_t)ctx->rows;
+    bool dead = ctx->config.boundary == BOUNDARY_DEAD;
+    uint8_t *buffers[2] = { scratch + ARENA_ALIGNMENT, scratch + job->slot_bytes / 2 + ARENA_ALIGNMENT };
+    uint64_t births = 0, deaths = 0;
+    
+    if (ops->begin) {
+        ops->begin(ctx, row_begin, row_end);
+    }
+    
+    for (ptrdiff_t block = (ptrdiff_t)row_begin; block < (ptrdiff_t)row_end;
+         block += (ptrdiff_t)job->block_rows) {
+        ptrdiff_t block_end = block + (ptrdiff_t)job->block_rows;
+        if (block_end > (ptrdiff_t)row_end) block_end = (ptrdiff_t)row_end;
+        ptrdiff_t low = block - reach, high = block_end + reach;
+        
+        /* Generation 0; scratch row s holds board row low + s */
+        ptrdiff_t load_begin = dead && low < -1 ? -1 : low;
+        ptrdiff_t load_end = dead && high > rows + 1 ? rows + 1 : high;
+        for (ptrdiff_t i = load_begin; i < load_end; i++) {
+            uint8_t *row = buffers[0] + (i - low) * stride;
+            if (dead && (i < 0 || i >= rows)) {
+                /* Never computed, so dead in both buffers */
+                ops->load_row(ctx, row, SIZE_MAX, false);
+                ops->load_row(ctx, buffers[1] + (i - low) * stride, SIZE_MAX, false);
+                continue;
+            }
+            
+            bool flip = false;
+            size_t source = dead ? (size_t)i : boundary_row(ctx, i, &flip);
+            ops->load_row(ctx, row, source, flip);
+            ops->fill_row_halo(ctx, row);
+        }
+        
+        /* Generation g is valid one row further in from each side than g - 1 */
+        for (ptrdiff_t g = 1; g <= reach; g++) {
+            const uint8_t *in = buffers[(g - 1) & 1];
+            uint8_t *out = buffers[g & 1];
+            ptrdiff_t first = low + g, end = high - g;
+            if (dead && first < 0) first = 0;
+            if (dead && end > rows) end = rows;
+            
+            for (ptrdiff_t i = first; i < end; i++) {
+                const uint8_t *middle = in + (i - low) * stride;
+                bool owned = i >= block && i < block_end;
+                
+                /* The last generation goes straight into the back buffer */
+                void *next = g == reach ? ops->back_row(ctx, (size_t)i) : out + (i - low) * stride;
+                ops->step_row(ctx, middle - stride, middle, middle + stride, next, (size_t)i,
+                              owned ? &births : NULL, owned ? &deaths : NULL);
+                if (g < reach) {
+                    ops->fill_row_halo(ctx, next);
+                }
+            }
+        }
+    }
+    
+    /* Each row is counted by its own block, once per generation */
+    stats_add_changes(ctx, births, deaths);
+}
+
+/**
+ * @brief Pool task: advance one horizontal band of rows by a blocked step
+ * @param arg Blocked step
+ * @param index Band index
+ * @param count Number of bands
+ */
+static void block_step_task(void *arg, size_t index, size_t count) {
+    const gol_block_job_t *job = arg;
+    gol_context_t *ctx = job->ctx;
+    size_t unit = ctx->engine->band_rows;
+    size_t units = (ctx->rows + unit - 1) / unit;
+    size_t row_begin = units * index / count * unit;
+    size_t row_end = units * (index + 1) / count * unit;
+    
+    if (row_end > ctx->rows) row_end = ctx->rows;
+    if (row_begin < row_end) {
+        block_step_rows(job, row_begin, row_end, ctx->block_arena.base + index * job->slot_bytes);
+    }
+}
+
+/**
+ * @brief Advance the board several generations in cache-sized blocks
+ * 
+ * Blocks are as tall as fits TEMPORAL_BLOCK_CACHE with their overlap, but
+ * at least as tall as the overlap, so no more than half the work is
+ * recomputed. The scratch grows with the thread count and is kept.
+ * 
+ * @param ctx Game context
+ * @param generations Generations to advance, at least 1
+ */
+static void block_step(gol_context_t *ctx, size_t generations) {
+    size_t stride = ctx->engine->block->row_bytes(ctx);
+    size_t unit = ctx->engine->band_rows;
+    size_t overlap = 2 * generations;
+    size_t fit = TEMPORAL_BLOCK_CACHE / (2 * stride);
+    
+    size_t block_rows = fit > 2 * overlap ? fit - overlap : overlap;
+    block_rows = block_rows / unit * unit;
+    if (block_rows == 0) block_rows = unit;
+    
+    gol_block_job_t job = { ctx, generations, block_rows, 0 };
+    job.slot_bytes = 2 * (ARENA_ALIGNMENT + (block_rows + overlap) * stride);
+    size_t slots = ctx->pool ? ctx->pool->count : 1;
+    if (ctx->block_arena.size < slots * job.slot_bytes) {
+        arena_destroy(&ctx->block_arena);
+        if (arena_create(&ctx->block_arena, slots * job.slot_bytes) != GOL_SUCCESS) {
+            engine_out_of_memory(ctx->engine->name);
+        }
+    }
+    
+    if (ctx->pool) {
+        thread_pool_run(ctx->pool, block_step_task, &job);
+    } else {
+        block_step_task(&job, 0, 1);
+    }
+    ctx->engine->swap_buffers(ctx);
+}
+
+/**
+ * @brief Simulate one step with the active engine
+ * 
+ * The boundary is copied into the halo first, so the row kernels never
+ * wrap an index. With a worker pool, row-banded engines step each band on
+ * its own thread and swap buffers once every band has finished. Bands only write their
+ * own rows of the back buffer, so the result is identical to the serial path.
+ * With @temporal_block, a step advances ctx->step_generations generations
+ * through block_step() instead. The births and deaths of the step are left
+ * in ctx->stats.
+ * 
+ * @param ctx Game context
+ */
+static void simulate_step(gol_context_t *ctx) {
+    ctx->stats.births = 0;
+    ctx->stats.deaths = 0;
+    
+#if GOL_MPI
+    if (ctx->dist) {
+        /* The halo comes from the neighboring ranks */
+        dist_step(ctx);
+    } else
+#endif
+    if (ctx->config.temporal_block > 1) {
+        /* Blocks read the rows past the edges through the boundary, no halo fill */
+        block_step(ctx, ctx->step_generations);
+    } else {
+        /* The halo is only ever written here, so a dead boundary costs nothing */
+        if (ctx->config.boundary != BOUNDARY_DEAD) {
+            ctx->engine->fill_halo(ctx);
+        }
+        
+        if (ctx->pool && ctx->engine->step_rows) {
+            thread_pool_run(ctx->pool, step_band_task, ctx);
+            ctx->engine->swap_buffers(ctx);
+        } else {
+            ctx->engine->step(ctx);
+        }
+    }
+    
+    if (ctx->engine->counts_changes) {
+        ctx->stats.population += ctx->stats.births - ctx->stats.deaths;
+    }
+    ctx->generation += ctx->step_generations;
+    
+    if (ctx->cycle) {
+        cycle_record(ctx);
+    }
+    if (ctx->frames) {
+        frames_advanced(ctx, ctx->step_generations);
+    }
+}
+
+/**
+ * @brief Advance the simulation by an exact number of generations
+ * 
+ * Engines that can jump ahead (HashLife) do so directly; the others step
+ * one generation, or one temporal block, at a time. Once a cycle has been
+ * found, whole periods are skipped without stepping.
+ * 
+ * @param ctx Game context
+ * @param generations Generations to advance
+ */
+static void advance_generations(gol_context_t *ctx, uint64_t generations) {
+    if (ctx->engine->advance) {
+        while (generations > 0) {
+            /* Jumps stop on every generation that exports a frame */
+            uint64_t jump = generations;
+            if (ctx->frames) {
+                uint64_t every = ctx->config.frame_every;
+                uint64_t next = every - ctx->generation % every;
+                if (next < jump) jump = next;
+            }
+            
+            ctx->stats.births = 0;
+            ctx->stats.deaths = 0;
+            ctx->engine->advance(ctx, jump);
+            ctx->generation += jump;
+            generations -= jump;
+            if (ctx->frames) {
+                frames_advanced(ctx, jump);
+            }
+        }
+        return;
+    }
+    
+    for (uint64_t done = 0; done < generations; done += ctx->step_generations) {
+        if (ctx->cycle) {
+            done += cycle_skip(ctx, generations - done);
+            if (done == generations) break;
+        }
+        
+        /* A blocked step can be shortened to land on the exact generation */
+        uint64_t step = ctx->step_generations;
+        if (ctx->config.temporal_block > 1 && generations - done < step) {
+            ctx->step_generations = generations - done;
+            simulate_step(ctx);
+            ctx->step_generations = step;
+            break;
+        }
+        simulate_step(ctx);
+    }
+}
+
+/*
+ * Simulation thread of windowed runs (@sim_thread 1). The thread steps
+ * the board at its own pace and hands finished generations to the window
+ * through a triple buffer, so a slow frame never holds up a step and a
+ * long step never holds up a frame. Input reaches the thread as commands
+ * on a single-producer, single-consumer ring, and while the thread runs
+ * it is the only one that touches the board.
+ */
+
+/* Input that changes the board or the controls, applied by control_apply() */
+typedef enum {
+    COMMAND_TOGGLE,   /* Toggle the cell at (row, col) */
+    COMMAND_PAUSE,    /* Pause or resume; a run to a generation is cancelled and pauses */
+    COMMAND_STEP,     /* Advance count generations, or one step for 0, then pause */
+    COMMAND_RUN_TO,   /* Run to generation count, then pause */
+    COMMAND_FASTER,   /* Double the generations per frame */
+    COMMAND_SLOWER,   /* Halve the generations per frame */
+    COMMAND_RESET,    /* Refill a random board and restart at generation 0 */
+    COMMAND_SAVE      /* Save a checkpoint of the current generation */
+} gol_command_type_t;
+
+typedef struct {
+    gol_command_type_t type;
+    size_t row;
+    size_t col;
+    uint64_t count;
+} gol_command_t;
+
+/* One generation handed from the simulation thread to the window */
+typedef struct {
+    uint64_t *rows;            /* The board as packed rows, as in the snapshot payload */
+    uint64_t generation;
+    gol_controls_t controls;   /* The simulation thread's controls at that generation */
+} gol_published_t;
+
+/*
+ * Triple buffer. The writer fills its own slot and exchanges it for the
+ * shared one; the reader exchanges its own for the shared one when that
+ * holds an unread generation. The exchange is the only operation the two
+ * sides share, so neither ever waits for the other, and the reader draws
+ * straight from the slot it holds.
+ */
+typedef struct {
+    gol_published_t slots[3];
+    unsigned int shared;       /* Slot of the newest generation, | PUBLISH_FRESH until read */
+    unsigned int writing;      /* Writer's slot */
+    unsigned int reading;      /* Reader's slot */
+    size_t words;              /* Words per board row */
+    uint64_t *reduce;          /* Reader's scratch row for drawing zoomed out */
+} gol_publish_t;
+
+/* Simulation thread state, shared by the window and the thread */
+typedef struct gol_sim {
+    pthread_t thread;
+    gol_publish_t publish;
+    gol_controls_t controls;   /* Owned by the thread once it runs */
+    gol_command_t commands[SIM_COMMANDS];
+    size_t head;               /* Commands posted by the window; atomic */
+    size_t tail;               /* Commands applied by the thread; atomic */
+    bool stop;                 /* The window asks the thread to return; atomic */
+    bool finished;             /* The run reached @steps; atomic */
+    pthread_mutex_t mutex;     /* Only for sleeping while paused */
+    pthread_cond_t wake;       /* Signals a posted command or stop */
+} gol_sim_t;
+
+/**
+ * @brief Free the slots of a triple buffer
+ * @param publish Triple buffer
+ */
+static void publish_destroy(gol_publish_t *publish) {
+    for (int i = 0; i < 3; i++) {
+        free(publish->slots[i].rows);
+        publish->slots[i].rows = NULL;
+    }
+    free(publish->reduce);
+    publish->reduce = NULL;
+}
+
+/**
+ * @brief Allocate the slots of a triple buffer
+ * @param publish Triple buffer to set up
+ * @param rows Board rows
+ * @param words Words per board row
+ * @return true on success
+ */
+static bool publish_create(gol_publish_t *publish, size_t rows, size_t words) {
+    memset(publish, 0, sizeof(*publish));
+    publish->writing = 0;
+    publish->shared = 1;
+    publish->reading = 2;
+    publish->words = words;
+    
+    bool ok = true;
+    for (int i = 0; i < 3; i++) {
+        publish->slots[i].rows = calloc(rows * words, sizeof(uint64_t));
+        ok = ok && publish->slots[i].rows;
+    }
+    publish->reduce = malloc(words * sizeof(uint64_t));
+    if (!ok || !publish->reduce) {
+        publish_destroy(publish);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writer: hand the filled slot to the reader and take another
+ * 
+ * The slot given back is the one the reader last let go of, or an unread
+ * generation that this one replaces.
+ * 
+ * @param publish Triple buffer
+ */
+static void publish_commit(gol_publish_t *publish) {
+    unsigned int previous = __atomic_exchange_n(&publish->shared,
+                                                publish->writing | PUBLISH_FRESH, __ATOMIC_ACQ_REL);
+    publish->writing = previous & ~PUBLISH_FRESH;
+}
+
+/**
+ * @brief Check whether the newest generation is still unread
+ * @param publish Triple buffer
+ * @return true if the reader has not taken it yet
+ */
+static bool publish_unread(const gol_publish_t *publish) {
+    return (__atomic_load_n(&publish->shared, __ATOMIC_RELAXED) & PUBLISH_FRESH) != 0;
+}
+
+/**
+ * @brief Reader: take the newest generation if it is unread
+ * 
+ * The slot taken stays the reader's, and is read in place, until the
+ * next successful call.
+ * 
+ * @param publish Triple buffer
+ * @return The generation, or NULL if nothing was published since the last call
+ */
+static const gol_published_t *publish_acquire(gol_publish_t *publish) {
+    if (!publish_unread(publish)) {
+        return NULL;
+    }
+    unsigned int previous = __atomic_exchange_n(&publish->shared, publish->reading,
+                                                __ATOMIC_ACQ_REL);
+    publish->reading = previous & ~PUBLISH_FRESH;
+    return &publish->slots[publish->reading];
+}
+
+/**
+ * @brief Apply one command to the board or the controls
+ * @param ctx Game context
+ * @param controls Controls of the thread that steps the board
+ * @param command Command to apply
+ */
+static void control_apply(gol_context_t *ctx, gol_controls_t *controls,
+                          const gol_command_t *command) {
+    switch (command->type) {
+        case COMMAND_TOGGLE:
+            set_cell(ctx, command->row, command->col,
+                     !get_cell(ctx, command->row, command->col));
+            break;
+            
+        case COMMAND_PAUSE:
+            controls->paused = controls->run_to ? true : !controls->paused;
+            controls->run_to = 0;
+            break;
+            
+        case COMMAND_STEP:
+            controls->paused = true;
+            controls->run_to = ctx->generation +
+                               (command->count ? command->count : ctx->step_generations);
+            break;
+            
+        case COMMAND_RUN_TO:
+            if (command->count > ctx->generation) {
+                controls->paused = true;
+                controls->run_to = command->count;
+            }
+            break;
+            
+        case COMMAND_FASTER:
+            if (controls->gens_per_frame < MAX_GENS_PER_FRAME) {
+                controls->gens_per_frame *= 2;
+            }
+            break;
+            
+        case COMMAND_SLOWER:
+            if (controls->gens_per_frame > 1) {
+                controls->gens_per_frame /= 2;
+            }
+            break;
+            
+        case COMMAND_RESET:
+            /* Out of memory keeps the current board and generation */
+            if (strcmp(ctx->config.config_type, CONFIG_RANDOM) == 0 &&
+                initialize_grid_random(ctx) != GOL_SUCCESS) {
+                break;
+            }
+            ctx->generation = 0;
+            controls->run_to = 0;
+            break;
+            
+        case COMMAND_SAVE:
+            snapshot_save(ctx, ctx->config.checkpoint_path);
+            break;
+    }
+}
+
+/**
+ * @brief Apply a command, on the simulation thread when there is one
+ * 
+ * A full ring drains within a frame of the thread, so posting waits for
+ * room, unless the thread has finished and nothing drains it any more.
+ * 
+ * @param ctx Game context
+ * @param controls Window's controls, used when the window steps the board
+ * @param command Command to apply
+ */
+static void control_issue(gol_context_t *ctx, gol_controls_t *controls,
+                          const gol_command_t *command) {
+    gol_sim_t *sim = ctx->sim;
+    if (!sim) {
+        control_apply(ctx, controls, command);
+        return;
+    }
+    
+    while (sim->head - __atomic_load_n(&sim->tail, __ATOMIC_ACQUIRE) == SIM_COMMANDS) {
+        if (__atomic_load_n(&sim->finished, __ATOMIC_ACQUIRE)) return;
+        SDL_Delay(1);
+    }
+    sim->commands[sim->head % SIM_COMMANDS] = *command;
+    __atomic_store_n(&sim->head, sim->head + 1, __ATOMIC_RELEASE);
+    
+    pthread_mutex_lock(&sim->mutex);
+    pthread_cond_signal(&sim->wake);
+    pthread_mutex_unlock(&sim->mutex);
+}
+
+/**
+ * @brief Step for one frame as the controls ask
+ * 
+ * At least one generation is stepped, then more within the frame budget;
+ * toward a target generation the whole budget is used, and a shorter
+ * last step lands on it exactly.
+ * 
+ * @param ctx Game context
+ * @param controls Controls; run_to is cleared on arrival
+ * @param frame_start SDL_GetTicks() at the start of the frame
+ * @return true if the run reached @steps
+ */
+static bool control_step(gol_context_t *ctx, gol_controls_t *controls, Uint32 frame_start) {
+    bool stepping = !controls->paused || controls->run_to;
+    
+    for (unsigned int i = 0; stepping && (i < controls->gens_per_frame || controls->run_to);
+         i++) {
+        if (controls->run_to) {
+            uint64_t left = controls->run_to - ctx->generation;
+            if (left < ctx->step_generations) {
+                advance_generations(ctx, left);
+            } else {
+                simulate_step(ctx);
+            }
+            if (ctx->generation >= controls->run_to) {
+                controls->run_to = 0;
+                stepping = false;
+            }
+        } else {
+            simulate_step(ctx);
+        }
+        
+        if (ctx->config.steps > 0 && ctx->generation >= ctx->config.steps) {
+            return true;
+        }
+        if (SDL_GetTicks() - frame_start >= FRAME_DELAY_MS) break;
+    }
+    return false;
+}
+
+/**
+ * @brief Publish the current generation and wake the window
+ * 
+ * This is the only copy of the board: the engines step from one buffer
+ * into the other, so the window cannot read either one in place.
+ * 
+ * @param ctx Game context
+ */
+static void sim_publish(gol_context_t *ctx) {
+    gol_sim_t *sim = ctx->sim;
+    gol_published_t *slot = &sim->publish.slots[sim->publish.writing];
+    read_board_rows(ctx, slot->rows, sim->publish.words);
+    slot->generation = ctx->generation;
+    slot->controls = sim->controls;
+    publish_commit(&sim->publish);
+    
+    /* The window may be asleep in SDL_WaitEvent() */
+    SDL_Event event = { .type = SDL_USEREVENT };
+    SDL_PushEvent(&event);
+}
+
+/**
+ * @brief Simulation thread: apply commands, step and publish, one frame at a time
+ * 
+ * A generation is published once the window has taken the last one, and
+ * always when the thread pauses, so that a paused window shows exactly
+ * the board being edited. Paused, the thread sleeps until a command.
+ * 
+ * @param arg Game context
+ * @return NULL
+ */
+static void *sim_thread_main(void *arg) {
+    gol_context_t *ctx = arg;
+    gol_sim_t *sim = ctx->sim;
+    bool stale = false;
+    
+    for (;;) {
+        Uint32 frame_start = SDL_GetTicks();
+        
+        size_t head = __atomic_load_n(&sim->head, __ATOMIC_ACQUIRE);
+        stale = stale || sim->tail != head;
+        while (sim->tail != head) {
+            control_apply(ctx, &sim->controls, &sim->commands[sim->tail % SIM_COMMANDS]);
+            __atomic_store_n(&sim->tail, sim->tail + 1, __ATOMIC_RELEASE);
+        }
+        if (__atomic_load_n(&sim->stop, __ATOMIC_ACQUIRE)) break;
+        
+        uint64_t generation = ctx->generation;
+        if (control_step(ctx, &sim->controls, frame_start)) {
+            __atomic_store_n(&sim->finished, true, __ATOMIC_RELEASE);
+            SDL_Event event = { .type = SDL_USEREVENT };
+            SDL_PushEvent(&event);
+            break;
+        }
+        stale = stale || ctx->generation != generation;
+        
+        bool idle = sim->controls.paused && !sim->controls.run_to;
+        if (stale && (idle || !publish_unread(&sim->publish))) {
+            sim_publish(ctx);
+            stale = false;
+        }
+        
+        if (idle) {
+            pthread_mutex_lock(&sim->mutex);
+            while (__atomic_load_n(&sim->head, __ATOMIC_ACQUIRE) == sim->tail &&
+                   !__atomic_load_n(&sim->stop, __ATOMIC_ACQUIRE)) {
+                pthread_cond_wait(&sim->wake, &sim->mutex);
+            }
+            pthread_mutex_unlock(&sim->mutex);
+        } else {
+            Uint32 frame_time = SDL_GetTicks() - frame_start;
+            if (frame_time < FRAME_DELAY_MS) {
+                SDL_Delay(FRAME_DELAY_MS - frame_time);
+            }
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Publish the current board and start the simulation thread
+ * @param ctx Game context
+ * @param controls Controls the thread starts with
+ * @return GOL_SUCCESS on success, error code otherwise
+ */
+static gol_result_t sim_create(gol_context_t *ctx, const gol_controls_t *controls) {
+    gol_sim_t *sim = calloc(1, sizeof(*sim));
+    if (!sim) {
+        return GOL_ERROR_MEMORY;
+    }
+    size_t words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    if (!publish_create(&sim->publish, ctx->rows, words)) {
+        free(sim);
+        return GOL_ERROR_MEMORY;
+    }
+    sim->controls = *controls;
+    
+    ctx->sim = sim;
+    sim_publish(ctx);
+    
+    if (pthread_mutex_init(&sim->mutex, NULL) != 0 ||
+        pthread_cond_init(&sim->wake, NULL) != 0 ||
+        pthread_create(&sim->thread, NULL, sim_thread_main, ctx) != 0) {
+        fprintf(stderr, "Error: Failed to start the simulation thread\n");
+        publish_destroy(&sim->publish);
+        free(sim);
+        ctx->sim = NULL;
+        return GOL_ERROR_THREAD;
+    }
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Stop the simulation thread; the board is the window's again
+ * @param ctx Game context
+ */
+static void sim_destroy(gol_context_t *ctx) {
+    gol_sim_t *sim = ctx->sim;
+    if (!sim) return;
+    
+    __atomic_store_n(&sim->stop, true, __ATOMIC_RELEASE);
+    pthread_mutex_lock(&sim->mutex);
+    pthread_cond_signal(&sim->wake);
+    pthread_mutex_unlock(&sim->mutex);
+    pthread_join(sim->thread, NULL);
+    
+    pthread_cond_destroy(&sim->wake);
+    pthread_mutex_destroy(&sim->mutex);
+    publish_destroy(&sim->publish);
+    free(sim);
+    ctx->sim = NULL;
+}
+
+/*
+ * Viewport. The window keeps a fixed size and shows part of the board,
+ * moved with the mouse and keys. Only the visible cells, or the visible
+ * blocks when zoomed out, are drawn into the texture, so a frame costs the
+ * window size rather than the board size.
+ */
+
+/**
+ * @brief Divide, rounding toward negative infinity
+ * @param a Dividend
+ * @param b Divisor, positive
+ * @return floor(a / b)
+ */
+static inline int64_t view_floor_div(int64_t a, int64_t b) {
+    return a >= 0 ? a / b : -((-a + b - 1) / b);
+}
+
+/**
+ * @brief Get the size of one window pixel
+ * @param view View
+ * @return Pixel side in 1/2^VIEW_MAX_ZOOM cells
+ */
+static inline int64_t view_pixel(const gol_view_t *view) {
+    return INT64_C(1) << (VIEW_MAX_ZOOM - view->zoom);
+}
+
+/**
+ * @brief Check whether the whole board fits in the window at a zoom
+ * @param ctx Game context
+ * @param zoom log2 of pixels per cell side
+ * @return true if it fits
+ */
+static bool view_fits(const gol_context_t *ctx, int zoom) {
+    const gol_view_t *view = &ctx->view;
+    if (zoom >= 0) {
+        return (ctx->cols << zoom) <= (size_t)view->width &&
+               (ctx->rows << zoom) <= (size_t)view->height;
+    }
+    return ((ctx->cols - 1) >> -zoom) + 1 <= (size_t)view->width &&
+           ((ctx->rows - 1) >> -zoom) + 1 <= (size_t)view->height;
+}
+
+/**
+ * @brief Keep the window centre on the board and the window edges on whole pixels
+ * @param ctx Game context
+ */
+static void view_clamp(gol_context_t *ctx) {
+    gol_view_t *view = &ctx->view;
+    int64_t pixel = view_pixel(view);
+    int64_t half_width = view->width * pixel / 2;
+    int64_t half_height = view->height * pixel / 2;
+    int64_t max_x = ((int64_t)ctx->cols << VIEW_MAX_ZOOM) - half_width;
+    int64_t max_y = ((int64_t)ctx->rows << VIEW_MAX_ZOOM) - half_height;
+    
+    if (view->x < -half_width) view->x = -half_width;
+    if (view->x > max_x) view->x = max_x;
+    if (view->y < -half_height) view->y = -half_height;
+    if (view->y > max_y) view->y = max_y;
+    
+    view->x = view_floor_div(view->x + pixel / 2, pixel) * pixel;
+    view->y = view_floor_div(view->y + pixel / 2, pixel) * pixel;
+}
+
+/**
+ * @brief Show the whole board, centred, as close as it fits
+ * @param ctx Game context
+ */
+static void view_reset(gol_context_t *ctx) {
+    gol_view_t *view = &ctx->view;
+    int zoom = VIEW_MAX_ZOOM;
+    while (zoom > -MAX_LOD_LEVEL && !view_fits(ctx, zoom)) {
+        zoom--;
+    }
+    
+    view->zoom = zoom;
+    view->min_zoom = zoom < 0 ? zoom : 0;
+    int64_t pixel = view_pixel(view);
+    view->x = ((int64_t)ctx->cols << VIEW_MAX_ZOOM) / 2 - view->width * pixel / 2;
+    view->y = ((int64_t)ctx->rows << VIEW_MAX_ZOOM) / 2 - view->height * pixel / 2;
+    view_clamp(ctx);
+}
+
+/**
+ * @brief Change the zoom, keeping the cell under a window pixel in place
+ * @param ctx Game context
+ * @param zoom New log2 of pixels per cell side, clamped to the allowed range
+ * @param x Window column of the fixed point
+ * @param y Window row of the fixed point
+ */
+static void view_zoom(gol_context_t *ctx, int zoom, int x, int y) {
+    gol_view_t *view = &ctx->view;
+    if (zoom > VIEW_MAX_ZOOM) zoom = VIEW_MAX_ZOOM;
+    if (zoom < view->min_zoom) zoom = view->min_zoom;
+    if (zoom == view->zoom) {
+        return;
+    }
+    
+    int64_t fixed_x = view->x + x * view_pixel(view);
+    int64_t fixed_y = view->y + y * view_pixel(view);
+    view->zoom = zoom;
+    view->x = fixed_x - x * view_pixel(view);
+    view->y = fixed_y - y * view_pixel(view);
+    view_clamp(ctx);
+}
+
+/**
+ * @brief Move the board with the window contents
+ * @param ctx Game context
+ * @param dx Pixels to move the board right
+ * @param dy Pixels to move the board down
+ */
+static void view_pan(gol_context_t *ctx, int dx, int dy) {
+    gol_view_t *view = &ctx->view;
+    view->x -= dx * view_pixel(view);
+    view->y -= dy * view_pixel(view);
+    view_clamp(ctx);
+}
+
+/**
+ * @brief Find the part of the board inside the window
+ * @param ctx Game context
+ * @param units Receives the visible cells, or blocks of 2^-zoom cells when zoomed out
+ * @param dest Receives the window rectangle they cover
+ * @return false if no part of the board is visible
+ */
+static bool view_visible(const gol_context_t *ctx, gol_region_t *units, SDL_Rect *dest) {
+    const gol_view_t *view = &ctx->view;
+    unsigned int level = view->zoom < 0 ? (unsigned int)-view->zoom : 0;
+    int64_t pixel = view_pixel(view);
+    int64_t unit = INT64_C(1) << (VIEW_MAX_ZOOM + level);
+    int64_t board_cols = (int64_t)((ctx->cols - 1) >> level) + 1;
+    int64_t board_rows = (int64_t)((ctx->rows - 1) >> level) + 1;
+    
+    int64_t col_begin = view_floor_div(view->x, unit);
+    int64_t row_begin = view_floor_div(view->y, unit);
+    int64_t col_end = view_floor_div(view->x + view->width * pixel + unit - 1, unit);
+    int64_t row_end = view_floor_div(view->y + view->height * pixel + unit - 1, unit);
+    if (col_begin < 0) col_begin = 0;
+    if (row_begin < 0) row_begin = 0;
+    if (col_end > board_cols) col_end = board_cols;
+    if (row_end > board_rows) row_end = board_rows;
+    if (col_begin >= col_end || row_begin >= row_end) {
+        return false;
+    }
+    
+    units->col = (size_t)col_begin;
+    units->row = (size_t)row_begin;
+    units->cols = (size_t)(col_end - col_begin);
+    units->rows = (size_t)(row_end - row_begin);
+    dest->x = (int)((col_begin * unit - view->x) / pixel);
+    dest->y = (int)((row_begin * unit - view->y) / pixel);
+    dest->w = (int)((col_end - col_begin) * unit / pixel);
+    dest->h = (int)((row_end - row_begin) * unit / pixel);
+    return true;
+}
+
+/**
+ * @brief Write one region of the grid into the grid texture
+ * 
+ * Only the locked rectangle is written, and it is written completely, so
+ * the rest of the texture keeps the previous frame's contents. Cells
+ * outside the ones the texture holds are skipped.
+ * 
+ * @param ctx Game context
+ * @param region Cells to update
+ * @param arg Unused
+ */
+static void draw_region(gol_context_t *ctx, const gol_region_t *region, void *arg) {
+    (void)arg;
+    const gol_view_t *view = &ctx->view;
+    if (!view->drawn_valid) {
+        return;
+    }
+    
+    gol_region_t clipped;
+    size_t row_end = region->row + region->rows, drawn_row_end = view->drawn.row + view->drawn.rows;
+    size_t col_end = region->col + region->cols, drawn_col_end = view->drawn.col + view->drawn.cols;
+    clipped.row = region->row > view->drawn.row ? region->row : view->drawn.row;
+    clipped.col = region->col > view->drawn.col ? region->col : view->drawn.col;
+    if (row_end > drawn_row_end) row_end = drawn_row_end;
+    if (col_end > drawn_col_end) col_end = drawn_col_end;
+    if (clipped.row >= row_end || clipped.col >= col_end) {
+        return;
+    }
+    clipped.rows = row_end - clipped.row;
+    clipped.cols = col_end - clipped.col;
+    
+    SDL_Rect rect = {
+        .x = (int)(clipped.col - view->drawn.col),
+        .y = (int)(clipped.row - view->drawn.row),
+        .w = (int)clipped.cols,
+        .h = (int)clipped.rows
+    };
+    void *pixels;
+    int pitch;
+    
+    if (SDL_LockTexture(ctx->texture, &rect, &pixels, &pitch) == 0) {
+        ctx->engine->draw(ctx, &clipped, pixels, (size_t)pitch / sizeof(uint32_t));
+        SDL_UnlockTexture(ctx->texture);
+    }
+}
+
+/**
+ * @brief Draw blocks of cells by reducing rows of pixels from draw()
+ * 
+ * Fallback for engines without draw_blocks(); it reads every visible cell.
+ * 
+ * @param ctx Game context
+ * @param blocks Region of blocks to draw
+ * @param level log2 of cells per block side
+ * @param pixels Destination for the region's top-left block
+ * @param pitch Distance between destination rows, in pixels
+ */
+static void draw_blocks_from_cells(gol_context_t *ctx, const gol_region_t *blocks,
+                                   unsigned int level, uint32_t *pixels, size_t pitch) {
+    gol_view_t *view = &ctx->view;
+    size_t row_end = (blocks->row + blocks->rows) << level;
+    size_t col_end = (blocks->col + blocks->cols) << level;
+    if (row_end > ctx->rows) row_end = ctx->rows;
+    if (col_end > ctx->cols) col_end = ctx->cols;
+    gol_region_t cells = { 0, blocks->col << level, 1, col_end - (blocks->col << level) };
+    
+    for (size_t i = 0; i < blocks->rows; i++) {
+        for (size_t j = 0; j < blocks->cols; j++) {
+            pixels[i * pitch + j] = DEAD_COLOR;
+        }
+    }
+    
+    if (view->scratch_size < cells.cols) {
+        uint32_t *scratch = realloc(view->scratch, cells.cols * sizeof(*scratch));
+        if (!scratch) {
+            return;
+        }
+        view->scratch = scratch;
+        view->scratch_size = cells.cols;
+    }
+    
+    for (size_t i = 0; i < blocks->rows; i++) {
+        uint32_t *out = pixels + i * pitch;
+        size_t row_begin = (blocks->row + i) << level;
+        for (cells.row = row_begin; cells.row < row_begin + ((size_t)1 << level) &&
+                                    cells.row < row_end; cells.row++) {
+            ctx->engine->draw(ctx, &cells, view->scratch, cells.cols);
+            for (size_t j = 0; j < cells.cols; j++) {
+                if (view->scratch[j] != DEAD_COLOR) {
+                    out[j >> level] = ALIVE_COLOR;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Draw from the generation the window took from the simulation thread
+ * 
+ * Zoomed out, the rows of each line of blocks are ORed together and the
+ * columns are then halved level times with lod_pairs(), as the packed
+ * engine builds its LOD levels.
+ * 
+ * @param ctx Game context
+ * @param units Region of cells, or of blocks when level > 0
+ * @param level log2 of cells per block side
+ * @param pixels Destination for the region's top-left cell or block
+ * @param pitch Distance between destination rows, in pixels
+ */
+static void published_draw(const gol_context_t *ctx, const gol_region_t *units,
+                           unsigned int level, uint32_t *pixels, size_t pitch) {
+    gol_publish_t *publish = &ctx->sim->publish;
+    const uint64_t *rows = publish->slots[publish->reading].rows;
+    size_t words = publish->words;
+    
+    if (level == 0) {
+        for (size_t i = 0; i < units->rows; i++) {
+            packed_draw_row(rows + (units->row + i) * words, units->col, units->cols,
+                            pixels + i * pitch);
+        }
+        return;
+    }
+    
+    /* Block word w covers the cell words from w << level up to (w + 1) << level */
+    size_t block_word = units->col / CELLS_PER_WORD;
+    size_t word_begin = block_word << level;
+    size_t word_end = ((units->col + units->cols - 1) / CELLS_PER_WORD + 1) << level;
+    if (word_end > words) word_end = words;
+    uint64_t *reduce = publish->reduce;
+    
+    for (size_t i = 0; i < units->rows; i++) {
+        size_t row_begin = (units->row + i) << level;
+        size_t row_end = row_begin + ((size_t)1 << level);
+        if (row_end > ctx->rows) row_end = ctx->rows;
+        
+        size_t count = word_end - word_begin;
+        memcpy(reduce, rows + row_begin * words + word_begin, count * sizeof(uint64_t));
+        for (size_t r = row_begin + 1; r < row_end; r++) {
+            const uint64_t *row = rows + r * words + word_begin;
+            for (size_t w = 0; w < count; w++) {
+                reduce[w] |= row[w];
+            }
+        }
+        for (unsigned int l = 0; l < level; l++) {
+            size_t half = (count + 1) / 2;
+            for (size_t w = 0; w < half; w++) {
+                uint64_t high = 2 * w + 1 < count ? reduce[2 * w + 1] : 0;
+                reduce[w] = lod_pairs(reduce[2 * w]) | (lod_pairs(high) << 32);
+            }
+            count = half;
+        }
+        packed_draw_row(reduce, units->col - block_word * CELLS_PER_WORD, units->cols,
+                        pixels + i * pitch);
+    }
+}
+
+/**
+ * @brief Render the grid using SDL, without presenting it
+ * 
+ * The visible part of the board goes into a streaming texture with one
+ * texel per cell, or per block of cells when zoomed out, and a single
+ * copy scales it into place. Anything outside the board is gray. With a
+ * simulation thread, the generation it published last is drawn whole.
+ * 
+ * @param ctx Game context
+ */
+static void render_grid(gol_context_t *ctx) {
+    gol_view_t *view = &ctx->view;
+    gol_region_t units = { 0, 0, 0, 0 };
+    SDL_Rect dest;
+    bool visible = view_visible(ctx, &units, &dest);
+    
+    SDL_SetRenderDrawColor(ctx->renderer, VIEW_BACKGROUND, VIEW_BACKGROUND, VIEW_BACKGROUND, 255);
+    SDL_RenderClear(ctx->renderer);
+    
+    if (!ctx->texture) {
+        render_grid_rects(ctx);
+        return;
+    }
+    
+    if (ctx->sim) {
+        /* The published board is new whenever this is called */
+        view->drawn_valid = false;
+        SDL_Rect rect = { 0, 0, (int)units.cols, (int)units.rows };
+        void *pixels;
+        int pitch;
+        if (visible && SDL_LockTexture(ctx->texture, &rect, &pixels, &pitch) == 0) {
+            published_draw(ctx, &units, view->zoom < 0 ? (unsigned int)-view->zoom : 0,
+                           pixels, (size_t)pitch / sizeof(uint32_t));
+            SDL_UnlockTexture(ctx->texture);
+        }
+    } else if (view->zoom < 0) {
+        /* Zoomed out: every visible block is drawn, at most one per window pixel */
+        view->drawn_valid = false;
+        SDL_Rect rect = { 0, 0, (int)units.cols, (int)units.rows };
+        void *pixels;
+        int pitch;
+        if (visible && SDL_LockTexture(ctx->texture, &rect, &pixels, &pitch) == 0) {
+            unsigned int level = (unsigned int)-view->zoom;
+            size_t texels = (size_t)pitch / sizeof(uint32_t);
+            if (!ctx->engine->draw_blocks ||
+                !ctx->engine->draw_blocks(ctx, &units, level, pixels, texels)) {
+                draw_blocks_from_cells(ctx, &units, level, pixels, texels);
+            }
+            SDL_UnlockTexture(ctx->texture);
+        }
+    } else {
+        /* After a move the texture is redrawn; otherwise only the regions changed since */
+        bool moved = !view->drawn_valid || memcmp(&view->drawn, &units, sizeof(units)) != 0;
+        if (moved) {
+            view->drawn_valid = false;
+        }
+        if (ctx->engine->flush_dirty) {
+            ctx->engine->flush_dirty(ctx, draw_region, NULL);
+        }
+        if (visible && (moved || !ctx->engine->flush_dirty)) {
+            view->drawn = units;
+            view->drawn_valid = true;
+            draw_region(ctx, &units, NULL);
+        }
+    }
+    
+    if (visible) {
+        SDL_Rect source = { 0, 0, (int)units.cols, (int)units.rows };
+        SDL_RenderCopy(ctx->renderer, ctx->texture, &source, &dest);
+    }
+}
+
+/**
+ * @brief Render the visible grid with one filled rectangle per living cell
+ * 
+ * Fallback for when the grid texture is unavailable. Zoomed out, each
+ * block shows its top-left cell. With a simulation thread the cells come
+ * from the generation it published last.
+ * 
+ * @param ctx Game context
+ */
+static void render_grid_rects(const gol_context_t *ctx) {
+    const gol_view_t *view = &ctx->view;
+    gol_region_t units;
+    SDL_Rect dest;
+    if (!view_visible(ctx, &units, &dest)) {
+        return;
+    }
+    unsigned int level = view->zoom < 0 ? (unsigned int)-view->zoom : 0;
+    int size = view->zoom < 0 ? 1 : 1 << view->zoom;
+    
+    /* Black board, living cells in green */
+    SDL_SetRenderDrawColor(ctx->renderer, 0, 0, 0, 255);
+    SDL_RenderFillRect(ctx->renderer, &dest);
+    SDL_SetRenderDrawColor(ctx->renderer, 0, 255, 0, 255);
+    
+    const gol_publish_t *publish = ctx->sim ? &ctx->sim->publish : NULL;
+    for (size_t i = 0; i < units.rows; i++) {
+        for (size_t j = 0; j < units.cols; j++) {
+            size_t row = (units.row + i) << level, col = (units.col + j) << level;
+            bool alive = publish ? (publish->slots[publish->reading].rows[row * publish->words +
+                                    col / CELLS_PER_WORD] >> (col % CELLS_PER_WORD)) & 1
+                                 : get_cell(ctx, row, col);
+            if (alive) {
+                SDL_Rect cell = {
+                    .x = dest.x + (int)j * size,
+                    .y = dest.y + (int)i * size,
+                    .w = size,
+                    .h = size
+                };
+                SDL_RenderFillRect(ctx->renderer, &cell);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Handle mouse click to toggle cell state
+ * 
+ * The click goes through the view transform. Zoomed out, a pixel covers
+ * several cells, so clicks are ignored.
+ * 
+ * @param ctx Game context
+ * @param controls Window's controls
+ * @param x Mouse x coordinate
+ * @param y Mouse y coordinate
+ */
+static void handle_mouse_click(gol_context_t *ctx, gol_controls_t *controls, int x, int y) {
+    const gol_view_t *view = &ctx->view;
+    if (view->zoom < 0) {
+        return;
+    }
+    
+    int64_t cell = INT64_C(1) << VIEW_MAX_ZOOM;
+    int64_t col = view_floor_div(view->x + x * view_pixel(view), cell);
+    int64_t row = view_floor_div(view->y + y * view_pixel(view), cell);
+    
+    if (row >= 0 && col >= 0 && (size_t)row < ctx->rows && (size_t)col < ctx->cols) {
+        gol_command_t toggle = { .type = COMMAND_TOGGLE, .row = (size_t)row, .col = (size_t)col };
+        control_issue(ctx, controls, &toggle);
+    }
+}
+
+
+/**
+ * @brief Count total number of living cells
+ * @param ctx Game context
+ * @return Number of living cells
+ */
+static uint64_t count_alive_cells(const gol_context_t *ctx) {
+    return ctx->engine->count_alive(ctx);
+}
+
+/**
+ * @brief Print grid to console for debugging
+ * @param ctx Game context
+ */
+static void print_grid_console(const gol_context_t *ctx) {
+    printf("Living cells: %" PRIu64 "\n", count_alive_cells(ctx));
+    
+    for (size_t i = 0; i < ctx->rows; i++) {
+        for (size_t j = 0; j < ctx->cols; j++) {
+            printf("%c ", get_cell(ctx, i, j) ? '#' : '.');
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+/**
+ * @brief Show the simulation speed and state in the window title
+ * 
+ * The title is only set when it changes, so this can run every frame.
+ * 
+ * @param ctx Game context
+ * @param controls Windowed run controls
+ * @param generation Generation on screen
+ */
+static void update_window_title(const gol_context_t *ctx, const gol_controls_t *controls,
+                                uint64_t generation) {
+    char title[192];
+    int length = snprintf(title, sizeof(title), "Conway's Game of Life - %u generation%s/frame",
+                          controls->gens_per_frame, controls->gens_per_frame == 1 ? "" : "s");
+    
+    if (controls->run_to) {
+        length += snprintf(title + length, sizeof(title) - (size_t)length,
+                           " - running to generation %" PRIu64, controls->run_to);
+    } else if (controls->paused) {
+        length += snprintf(title + length, sizeof(title) - (size_t)length,
+                           " - paused at generation %" PRIu64, generation);
+    }
+    if (controls->count) {
+        snprintf(title + length, sizeof(title) - (size_t)length, " - %" PRIu64, controls->count);
+    }
+    if (strcmp(SDL_GetWindowTitle(ctx->window), title) != 0) {
+        SDL_SetWindowTitle(ctx->window, title);
+    }
+}
+
+#if GOL_PROFILE
+/*
+ * Frame profiler: every phase of a frame of run_simulation() is timed with
+ * the monotonic clock and kept in a rolling window for percentiles. Build
+ * with -DGOL_PROFILE=0 and the timers, and all of this, compile away.
+ */
+
+/* Names of the frame phases, indexed by gol_phase_t */
+static const char *const phase_names[PHASE_COUNT] = {
+    "events", "render", "present", "simulate", "delay"
+};
+
+/* Overlay glyphs, 3x5 pixels: one octal digit per row, top row first */
+static const struct {
+    char c;
+    uint16_t rows;
+} overlay_font[] = {
+    {'0', 075557}, {'1', 026227}, {'2', 071747}, {'3', 071717}, {'4', 055711},
+    {'5', 074717}, {'6', 074757}, {'7', 071122}, {'8', 075757}, {'9', 075717},
+    {'.', 000002}, {'/', 011244}, {'A', 025755}, {'D', 065556}, {'E', 074647},
+    {'I', 072227}, {'L', 044447}, {'M', 057755}, {'N', 065555}, {'P', 065644},
+    {'R', 065655}, {'S', 034216}, {'T', 072222}, {'U', 055557}, {'V', 055552},
+    {'Y', 055222}
+};
+
+/**
+ * @brief Read the monotonic clock for the profiler
+ * @return Nanoseconds since an arbitrary fixed point
+ */
+static inline uint64_t profile_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * UINT64_C(1000000000) + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Start profiling a run, opening the trace file if one is configured
+ * @param ctx Game context
+ */
+static void profile_begin_run(gol_context_t *ctx) {
+    gol_profile_t *profile = &ctx->profile;
+    profile->origin_ns = profile_now_ns();
+    profile->last_report_ns = profile->origin_ns;
+    
+    if (ctx->config.trace_path[0] != '\0') {
+        profile->trace = fopen(ctx->config.trace_path, "w");
+        if (!profile->trace) {
+            fprintf(stderr, "Warning: Cannot create trace '%s': %s\n",
+                    ctx->config.trace_path, strerror(errno));
+        } else {
+            fputs("[\n", profile->trace);
+        }
+    }
+}
+
+/**
+ * @brief Finish profiling a run and close the trace file
+ * @param ctx Game context
+ */
+static void profile_end_run(gol_context_t *ctx) {
+    gol_profile_t *profile = &ctx->profile;
+    if (profile->trace) {
+        fputs("\n]\n", profile->trace);
+        fclose(profile->trace);
+        profile->trace = NULL;
+    }
+}
+
+/**
+ * @brief Record one phase of the current frame
+ * @param profile Profiler
+ * @param phase Phase that just ended
+ * @param start_ns Clock reading taken when the phase began
+ */
+static void profile_record(gol_profile_t *profile, gol_phase_t phase, uint64_t start_ns) {
+    uint64_t end_ns = profile_now_ns();
+    profile->samples[phase][profile->frames % PROFILE_WINDOW] = end_ns - start_ns;
+    
+    if (profile->trace) {
+        /* Complete events, timestamps in microseconds */
+        fprintf(profile->trace,
+                "%s{\"name\": \"%s\", \"ph\": \"X\", \"pid\": 1, \"tid\": 1, "
+                "\"ts\": %.3f, \"dur\": %.3f}",
+                profile->trace_started ? ",\n" : "", phase_names[phase],
+                (double)(start_ns - profile->origin_ns) / 1e3,
+                (double)(end_ns - start_ns) / 1e3);
+        profile->trace_started = true;
+    }
+}
+
+/**
+ * @brief Compare two durations for qsort()
+ * @param a First duration
+ * @param b Second duration
+ * @return Negative, zero or positive
+ */
+static int profile_compare(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Get the rolling median and 99th percentile of a phase
+ * @param profile Profiler
+ * @param phase Phase
+ * @param p50 Receives the median in milliseconds
+ * @param p99 Receives the 99th percentile in milliseconds
+ */
+static void profile_percentiles(const gol_profile_t *profile, gol_phase_t phase,
+                                double *p50, double *p99) {
+    uint64_t sorted[PROFILE_WINDOW];
+    size_t count = profile->frames < PROFILE_WINDOW ? (size_t)profile->frames : PROFILE_WINDOW;
+    if (count == 0) {
+        *p50 = *p99 = 0.0;
+        return;
+    }
+    
+    memcpy(sorted, profile->samples[phase], count * sizeof(uint64_t));
+    qsort(sorted, count, sizeof(uint64_t), profile_compare);
+    *p50 = (double)sorted[count / 2] / 1e6;
+    *p99 = (double)sorted[count * 99 / 100] / 1e6;
+}
+
+/**
+ * @brief Close the current frame and print the stderr line when it is due
+ * @param profile Profiler
+ */
+static void profile_end_frame(gol_profile_t *profile) {
+    profile->frames++;
+    
+    uint64_t now = profile_now_ns();
+    if (!profile->report || now - profile->last_report_ns < PROFILE_REPORT_MS * UINT64_C(1000000)) {
+        return;
+    }
+    profile->last_report_ns = now;
+    
+    fprintf(stderr, "Frame %" PRIu64 " (ms p50/p99):", profile->frames);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        double p50, p99;
+        profile_percentiles(profile, (gol_phase_t)phase, &p50, &p99);
+        fprintf(stderr, " %s %.3f/%.3f", phase_names[phase], p50, p99);
+    }
+    fputc('\n', stderr);
+}
+
+/**
+ * @brief Draw a string with the overlay font
+ * @param renderer Renderer, draw color already set
+ * @param text Text; characters without a glyph are drawn as spaces
+ * @param x Left edge in pixels
+ * @param y Top edge in pixels
+ */
+static void overlay_text(SDL_Renderer *renderer, const char *text, int x, int y) {
+    for (; *text; text++, x += 4 * OVERLAY_SCALE) {
+        char c = (*text >= 'a' && *text <= 'z') ? (char)(*text - 'a' + 'A') : *text;
+        for (size_t g = 0; g < sizeof(overlay_font) / sizeof(overlay_font[0]); g++) {
+            if (overlay_font[g].c != c) continue;
+            
+            for (int row = 0; row < 5; row++) {
+                unsigned int bits = (overlay_font[g].rows >> (3 * (4 - row))) & 7u;
+                for (int col = 0; col < 3; col++) {
+                    if (bits & (4u >> col)) {
+                        SDL_Rect pixel = { x + col * OVERLAY_SCALE, y + row * OVERLAY_SCALE,
+                                           OVERLAY_SCALE, OVERLAY_SCALE };
+                        SDL_RenderFillRect(renderer, &pixel);
+                    }
+                }
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * @brief Draw the phase timings over the board
+ * 
+ * One line per phase with its p50/p99 in milliseconds, and a bar showing
+ * the median as a share of the FRAME_DELAY_MS frame budget.
+ * 
+ * @param ctx Game context
+ */
+static void profile_draw_overlay(const gol_context_t *ctx) {
+    const int line = 7 * OVERLAY_SCALE;
+    const int bar_x = 4 * OVERLAY_SCALE * 20;
+    const int bar_width = 4 * OVERLAY_SCALE * 16;
+    
+    SDL_SetRenderDrawBlendMode(ctx->renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(ctx->renderer, 0, 0, 0, 192);
+    SDL_Rect panel = { 0, 0, bar_x + bar_width + 2 * line, (PHASE_COUNT + 2) * line };
+    SDL_RenderFillRect(ctx->renderer, &panel);
+    
+    SDL_SetRenderDrawColor(ctx->renderer, 255, 255, 255, 255);
+    overlay_text(ctx->renderer, "MS P50/P99", line, line / 2);
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        double p50, p99;
+        profile_percentiles(&ctx->profile, (gol_phase_t)phase, &p50, &p99);
+        
+        char text[64];
+        snprintf(text, sizeof(text), "%-9s%.2f/%.2f", phase_names[phase], p50, p99);
+        int y = line / 2 + (phase + 1) * line;
+        SDL_SetRenderDrawColor(ctx->renderer, 255, 255, 255, 255);
+        overlay_text(ctx->renderer, text, line, y);
+        
+        double share = p50 / FRAME_DELAY_MS;
+        SDL_Rect bar = { bar_x, y, (int)(bar_width * (share < 1.0 ? share : 1.0)) + 1,
+                         5 * OVERLAY_SCALE };
+        SDL_SetRenderDrawColor(ctx->renderer, 255, 160, 0, 255);
+        SDL_RenderFillRect(ctx->renderer, &bar);
+    }
+}
+#endif
+
+/**
+ * @brief Main game loop
+ * 
+ * Each frame simulates up to gens_per_frame generations (adjustable live
+ * with +/-) and then presents once. Stepping stops early when the frame
+ * budget is used up so input stays responsive at very high speeds.
+ * 
+ * Space pauses: events are still handled, but nothing is stepped and a
+ * frame is only drawn after an event, so between events the loop sleeps
+ * in SDL_WaitEvent(). A number typed before N or G steps that many
+ * generations, or runs to that generation, using the whole frame budget,
+ * and pauses again; N alone makes one step.
+ * 
+ * With @sim_thread 1 the stepping moves to the simulation thread: input
+ * becomes commands for it, and each frame draws the newest generation it
+ * published, together with the controls it had then.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on normal exit
+ */
+static gol_result_t run_simulation(gol_context_t *ctx) {
+    bool running = true;
+    bool redraw = true;
+    SDL_Event event;
+    gol_controls_t controls = { .gens_per_frame = ctx->config.gens_per_frame };
+    uint64_t generation = ctx->generation;   /* Generation on screen */
+    
+    if (ctx->config.sim_thread) {
+        gol_result_t result = sim_create(ctx, &controls);
+        if (result != GOL_SUCCESS) {
+            return result;
+        }
+    }
+#if GOL_PROFILE
+    profile_begin_run(ctx);
+#endif
+    
+    while (running) {
+        Uint32 frame_start = SDL_GetTicks();
+        
+        /* Process events */
+        PROFILE_START(events_start);
+        while (SDL_PollEvent(&event)) {
+            /* Anything but moving the mouse over the window may change what is shown */
+            if (event.type != SDL_MOUSEMOTION ||
+                (event.motion.state & (SDL_BUTTON_RMASK | SDL_BUTTON_MMASK))) {
+                redraw = true;
+            }
+            
+            switch (event.type) {
+                case SDL_QUIT:
+                    running = false;
+                    break;
+                    
+                case SDL_MOUSEBUTTONDOWN:
+                    if (event.button.button == SDL_BUTTON_LEFT) {
+                        handle_mouse_click(ctx, &controls, event.button.x, event.button.y);
+                    }
+                    break;
+                    
+                case SDL_MOUSEMOTION:
+                    /* Drag with the right or middle button to pan */
+                    if (event.motion.state & (SDL_BUTTON_RMASK | SDL_BUTTON_MMASK)) {
+                        view_pan(ctx, event.motion.xrel, event.motion.yrel);
+                    }
+                    break;
+                    
+                case SDL_MOUSEWHEEL: {
+                    /* Zoom about the cell under the mouse */
+                    int mouse_x, mouse_y;
+                    SDL_GetMouseState(&mouse_x, &mouse_y);
+                    if (event.wheel.y != 0) {
+                        view_zoom(ctx, ctx->view.zoom + (event.wheel.y > 0 ? 1 : -1),
+                                  mouse_x, mouse_y);
+                    }
+                    break;
+                }
+                    
+                case SDL_KEYDOWN: {
+                    SDL_Keycode key = event.key.keysym.sym;
+                    
+                    if (key >= SDLK_0 && key <= SDLK_9) {
+                        /* Type the number of generations for N or G */
+                        uint64_t digit = (uint64_t)(key - SDLK_0);
+                        if (controls.count <= (UINT64_MAX - digit) / 10) {
+                            controls.count = controls.count * 10 + digit;
+                        }
+                    } else if (key == SDLK_ESCAPE) {
+                        /* Forget the typed number */
+                        controls.count = 0;
+                    } else if (key == SDLK_n || key == SDLK_g) {
+                        /* Step the typed number of generations, or run to it, then pause */
+                        gol_command_t command = {
+                            .type = key == SDLK_n ? COMMAND_STEP : COMMAND_RUN_TO,
+                            .count = controls.count
+                        };
+                        control_issue(ctx, &controls, &command);
+                        controls.count = 0;
+                    } else if (key == SDLK_LEFT || key == SDLK_RIGHT ||
+                               key == SDLK_UP || key == SDLK_DOWN) {
+                        /* Pan by an eighth of the window */
+                        int dx = ctx->view.width / 8, dy = ctx->view.height / 8;
+                        view_pan(ctx, key == SDLK_LEFT ? dx : key == SDLK_RIGHT ? -dx : 0,
+                                 key == SDLK_UP ? dy : key == SDLK_DOWN ? -dy : 0);
+                    } else if (key == SDLK_PAGEUP || key == SDLK_PAGEDOWN) {
+                        /* Zoom about the window centre */
+                        view_zoom(ctx, ctx->view.zoom + (key == SDLK_PAGEUP ? 1 : -1),
+                                  ctx->view.width / 2, ctx->view.height / 2);
+                    } else if (key == SDLK_HOME) {
+                        /* Show the whole board again */
+                        view_reset(ctx);
+                    } else if (key == SDLK_SPACE) {
+                        /* Pause or resume; a run to a generation is cancelled and pauses */
+                        control_issue(ctx, &controls,
+                                      &(gol_command_t){ .type = COMMAND_PAUSE });
+                    } else if (key == SDLK_r) {
+                        /* Reset grid */
+                        control_issue(ctx, &controls,
+                                      &(gol_command_t){ .type = COMMAND_RESET });
+                    } else if (key == SDLK_s && ctx->config.checkpoint_path[0] != '\0') {
+                        /* Save a checkpoint of the current generation */
+                        control_issue(ctx, &controls,
+                                      &(gol_command_t){ .type = COMMAND_SAVE });
+                    } else if (key == SDLK_p) {
+#if GOL_PROFILE
+                        /* Toggle the frame timing overlay */
+                        ctx->profile.overlay = !ctx->profile.overlay;
+#endif
+                    } else if (key == SDLK_PLUS || key == SDLK_EQUALS || key == SDLK_KP_PLUS) {
+                        /* Double the simulation speed */
+                        control_issue(ctx, &controls,
+                                      &(gol_command_t){ .type = COMMAND_FASTER });
+                    } else if (key == SDLK_MINUS || key == SDLK_KP_MINUS) {
+                        /* Halve the simulation speed */
+                        control_issue(ctx, &controls,
+                                      &(gol_command_t){ .type = COMMAND_SLOWER });
+                    }
+                    break;
+                }
+            }
+        }
+        
+        /* Take the simulation thread's newest generation and the controls it had then */
+        if (ctx->sim) {
+            const gol_published_t *latest = publish_acquire(&ctx->sim->publish);
+            if (latest) {
+                uint64_t count = controls.count;
+                controls = latest->controls;
+                controls.count = count;
+                generation = latest->generation;
+                redraw = true;
+            }
+            if (__atomic_load_n(&ctx->sim->finished, __ATOMIC_ACQUIRE)) {
+                running = false;
+            }
+        } else {
+            generation = ctx->generation;
+        }
+        update_window_title(ctx, &controls, generation);
+        
+        PROFILE_STOP(ctx, PHASE_EVENTS, events_start);
+        
+        /* Draw after a step, an edit or a change of view; an idle paused window draws nothing */
+        if (running && redraw) {
+            PROFILE_START(render_start);
+            render_grid(ctx);
+#if GOL_PROFILE
+            if (ctx->profile.overlay) {
+                profile_draw_overlay(ctx);
+            }
+#endif
+            PROFILE_STOP(ctx, PHASE_RENDER, render_start);
+            
+            PROFILE_START(present_start);
+            SDL_RenderPresent(ctx->renderer);
+            PROFILE_STOP(ctx, PHASE_PRESENT, present_start);
+            redraw = false;
+        }
+        
+        /* Advance simulation, unless the simulation thread does */
+        PROFILE_START(simulate_start);
+        if (running && !ctx->sim) {
+            uint64_t before = ctx->generation;
+            if (control_step(ctx, &controls, frame_start)) {
+                running = false;
+            }
+            redraw = ctx->generation != before;
+        }
+        PROFILE_STOP(ctx, PHASE_SIMULATE, simulate_start);
+        
+        /* Control frame rate: sleep for whatever is left of the frame, or paused, until an event */
+        PROFILE_START(delay_start);
+        Uint32 frame_time = SDL_GetTicks() - frame_start;
+        if (running && controls.paused && !controls.run_to && !redraw) {
+            SDL_WaitEvent(NULL);
+        } else if (frame_time < FRAME_DELAY_MS) {
+            SDL_Delay(FRAME_DELAY_MS - frame_time);
+        }
+        PROFILE_STOP(ctx, PHASE_DELAY, delay_start);
+        PROFILE_END_FRAME(ctx);
+    }
+    
+    sim_destroy(ctx);
+#if GOL_PROFILE
+    profile_end_run(ctx);
+#endif
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Read a monotonic clock
+ * @return Seconds since an arbitrary fixed point
+ */
+static double now_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+/*
+ * Cycle detection. Random boards mostly settle into still lifes and short
+ * oscillators long before @steps. With @detect_cycles, headless runs hash
+ * the board after every step, and once the board is known to repeat they
+ * skip whole periods, so the final board and statistics are exactly those
+ * of the full run.
+ */
+
+/**
+ * @brief Hash the whole board
+ * @param ctx Game context
+ * @param rows Scratch of ctx->rows rows of the board's words
+ * @return Sum of board_word_hash() over the board's words
+ */
+static uint64_t board_hash(const gol_context_t *ctx, uint64_t *rows) {
+    size_t words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    uint64_t hash = 0;
+    
+    read_board_rows(ctx, rows, words);
+    for (size_t n = 0; n < ctx->rows * words; n++) {
+        hash += board_word_hash(n, rows[n]);
+    }
+    return hash;
+}
+
+/**
+ * @brief Start cycle detection from the current board
+ * 
+ * Engines that track the hash keep it up to date while they step; for
+ * the others the board is hashed again after every step.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_MEMORY on failure
+ */
+static gol_result_t cycle_create(gol_context_t *ctx) {
+    size_t words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    size_t bytes = ctx->rows * words * sizeof(uint64_t);
+    
+    gol_cycle_t *cycle = calloc(1, sizeof(*cycle));
+    if (!cycle) {
+        return GOL_ERROR_MEMORY;
+    }
+    ctx->cycle = cycle;
+    cycle->capacity = ctx->config.cycle_period;
+    cycle->hashes = malloc(cycle->capacity * sizeof(uint64_t));
+    cycle->rows = malloc(bytes);
+    /* The arena's fill rows are free once the board is set up */
+    cycle->scratch = ctx->board_rows ? ctx->board_rows : malloc(bytes);
+    if (!cycle->hashes || !cycle->rows || !cycle->scratch) {
+        cycle_destroy(ctx);
+        return GOL_ERROR_MEMORY;
+    }
+    
+    ctx->track_hash = ctx->engine->tracks_hash;
+    ctx->board_hash = board_hash(ctx, cycle->scratch);
+    cycle->hashes[0] = ctx->board_hash;
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Stop cycle detection and free its buffers
+ * @param ctx Game context
+ */
+static void cycle_destroy(gol_context_t *ctx) {
+    gol_cycle_t *cycle = ctx->cycle;
+    if (!cycle) return;
+    
+    free(cycle->hashes);
+    free(cycle->rows);
+    if (cycle->scratch != ctx->board_rows) {
+        free(cycle->scratch);
+    }
+    free(cycle);
+    ctx->cycle = NULL;
+    ctx->track_hash = false;
+}
+
+/**
+ * @brief Record the board after a step and look for a repeat
+ * 
+ * The latest earlier step with the same hash gives the shortest candidate
+ * period. The board is copied then and compared once more a period later,
+ * so a hash collision is never taken for a cycle. Steps advance a single
+ * generation, since @temporal_block is not allowed with @detect_cycles.
+ * 
+ * @param ctx Game context
+ */
+static void cycle_record(gol_context_t *ctx) {
+    gol_cycle_t *cycle = ctx->cycle;
+    if (cycle->period) return;
+    
+    size_t words = (ctx->cols + CELLS_PER_WORD - 1) / CELLS_PER_WORD;
+    if (!ctx->track_hash) {
+        /* Leaves the board in scratch for the comparison below */
+        ctx->board_hash = board_hash(ctx, cycle->scratch);
+    }
+    uint64_t step = ++cycle->steps;
+    uint64_t hash = ctx->board_hash;
+    
+    if (cycle->candidate && step == cycle->confirm_step) {
+        if (ctx->track_hash) {
+            read_board_rows(ctx, cycle->scratch, words);
+        }
+        if (memcmp(cycle->scratch, cycle->rows, ctx->rows * words * sizeof(uint64_t)) == 0) {
+            cycle->period = cycle->candidate;
+            return;
+        }
+        cycle->candidate = 0;
+    }
+    
+    if (!cycle->candidate) {
+        uint64_t reach = step < cycle->capacity ? step : cycle->capacity;
+        for (uint64_t distance = 1; distance <= reach; distance++) {
+            if (cycle->hashes[(step - distance) % cycle->capacity] == hash) {
+                read_board_rows(ctx, cycle->rows, words);
+                cycle->candidate = distance;
+                cycle->confirm_step = step + distance;
+                cycle->start = ctx->generation - distance;
+                break;
+            }
+        }
+    }
+    cycle->hashes[step % cycle->capacity] = hash;
+}
+
+/**
+ * @brief Skip the whole periods of a confirmed cycle
+ * @param ctx Game context
+ * @param generations Generations still to run
+ * @return Generations skipped, a multiple of the period and at most generations;
+ *         none while frames are exported, since every frame is wanted
+ */
+static uint64_t cycle_skip(gol_context_t *ctx, uint64_t generations) {
+    uint64_t period = ctx->cycle->period;
+    if (period == 0 || ctx->frames) return 0;
+    
+    /* The board and the last step's births and deaths repeat every period */
+    uint64_t skip = generations - generations % period;
+    ctx->generation += skip;
+    return skip;
+}
+
+/**
+ * @brief Run the simulation without SDL as fast as possible
+ * 
+ * Steps @steps generations back to back, then prints run statistics and
+ * the final grid to stdout. With @detect_cycles, the run also reports the
+ * cycle the board settled into and skips its repeats, except with --stats,
+ * which prints every generation.
+ * 
+ * @param ctx Game context
+ * @return GOL_SUCCESS on success, GOL_ERROR_CONFIG if @steps is 0
+ */
+static gol_result_t run_headless(gol_context_t *ctx) {
+    uint64_t steps = ctx->config.steps;
+    if (steps == 0) {
+        fprintf(stderr, "Error: Headless mode requires @steps > 0\n");
+        return GOL_ERROR_CONFIG;
+    }
+    
+    double start = now_seconds();
+    if (ctx->config.cycle_period > 0 && cycle_create(ctx) != GOL_SUCCESS) {
+        fprintf(stderr, "Error: Out of memory for cycle detection\n");
+        return GOL_ERROR_MEMORY;
+    }
+    
+    uint64_t every = ctx->config.checkpoint_every;
+    if (every > 0) {
+        /* Intermediate checkpoints; main() writes the final one */
+        uint64_t target = ctx->generation + steps;
+        while (target - ctx->generation > every) {
+            advance_generations(ctx, every);
+            if (snapshot_save(ctx, ctx->config.checkpoint_path) != GOL_SUCCESS) {
+                cycle_destroy(ctx);
+                return GOL_ERROR_FILE;
+            }
+        }
+        advance_generations(ctx, target - ctx->generation);
+    } else if (ctx->log_stats) {
+        /* One line per step: the statistics come from the step itself */
+        for (uint64_t done = 0; done < steps; done += ctx->step_generations) {
+            uint64_t step = ctx->step_generations;
+            if (steps - done < step) {
+                if (ctx->config.temporal_block > 1) {
+                    /* The last blocked step is shortened to stop on @steps, as in advance_generations */
+                    ctx->step_generations = steps - done;
+                    simulate_step(ctx);
+                    ctx->step_generations = step;
+                } else {
+                    /* HashLife jumps cannot be shortened; advance() takes the rest exactly */
+                    advance_generations(ctx, steps - done);
+                }
+                print_stats_line(ctx, steps - done);
+                break;
+            }
+            simulate_step(ctx);
+            print_stats_line(ctx, step);
+        }
+    } else {
+        advance_generations(ctx, steps);
+    }
+    double elapsed = now_seconds() - start;
+    
+#if GOL_MPI
+    if (ctx->dist) {
+        return dist_report(ctx, steps, elapsed);
+    }
+#endif
+    double cell_updates = (double)steps * (double)ctx->rows * (double)ctx->cols;
+    printf("Engine: %s (kernel %s, %u thread%s)\n", ctx->engine->name, ctx->kernel->name,
+           ctx->pool ? (unsigned int)ctx->pool->count : 1, ctx->pool ? "s" : "");
+    printf("Generations: %" PRIu64 "\n", ctx->generation);
+    printf("Elapsed: %.6f s (%.1f generations/s, %.3e cell updates/s)\n", elapsed,
+           elapsed > 0 ? steps / elapsed : 0.0, elapsed > 0 ? cell_updates / elapsed : 0.0);
+    if (ctx->cycle && ctx->cycle->period) {
+        printf("Stabilized: generation %" PRIu64 ", period %" PRIu64 "\n",
+               ctx->cycle->start, ctx->cycle->period);
+    } else if (ctx->cycle) {
+        printf("Stabilized: no cycle of period up to %u\n", ctx->config.cycle_period);
+    }
+    cycle_destroy(ctx);
+    print_grid_console(ctx);
+    
+    return GOL_SUCCESS;
+}
+
+/**
+ * @brief Print the population statistics of the last step
+ * 
+ * With @temporal_block, one step covers several generations, and the
+ * births and deaths printed are totals over all of them.
+ * 
+ * @param ctx Game context
+ * @param generations Generations the last step advanced
+ */
+static void print_stats_line(const gol_context_t *ctx, uint64_t generations) {
+    gol_stats_t stats = ctx->stats;
+#if GOL_MPI
+    if (ctx->dist) {
+        /* Every rank adds its block, rank 0 prints the sum */
+        stats = dist_total_stats(ctx);
+        if (ctx->dist->rank != 0) return;
+    }
+#endif
+    
+    if (ctx->engine->counts_changes && generations > 1) {
+        printf("Generation %" PRIu64 ": population %" PRIu64 ", births %" PRIu64
+               ", deaths %" PRIu64 " over the last %" PRIu64 " generations\n",
+               ctx->generation, stats.population, stats.births, stats.deaths, generations);
+    } else if (ctx->engine->counts_changes) {
+        printf("Generation %" PRIu64 ": population %" PRIu64 ", births %" PRIu64
+               ", deaths %" PRIu64 "\n", ctx->generation, stats.population,
+               stats.births, stats.deaths);
+    } else {
+        printf("Generation %" PRIu64 ": population %" PRIu64 "\n",
+               ctx->generation, stats.population);
+    }
+}
+
+/*
+ * Benchmarks: every engine variant on a standard set of boards. Each case
+ * runs in a forked child, so its peak RSS is its own and a case that
+ * fails or runs out of memory cannot disturb the others.
+ */
+
+/* Benchmark variant: one engine and kernel */
+typedef struct {
+    const char *engine;
+    const char *kernel;
+    bool scale_threads;     /* Also run at 2, 4, ... threads up to the CPU count */
+    size_t max_cells;       /* Larger boards are skipped, 0 for no limit */
+} gol_bench_variant_t;
+
+/* Benchmark board: a configuration file or a synthesized random board */
+typedef struct {
+    const char *path;       /* Configuration file, NULL for a random board */
+    size_t size;            /* Side of a random board */
+    uint64_t generations;   /* Timed generations */
+} gol_bench_board_t;
+
+/* Benchmark measurement, written by the child through a pipe */
+typedef struct {
+    gol_result_t result;
+    size_t rows;
+    size_t cols;
+    char kernel[32];        /* Kernel actually used, after resolving auto */
+    unsigned int threads;
+    uint64_t generations;
+    double seconds;
+    long peak_rss_kb;       /* Filled in by the parent from the child's rusage */
+} gol_bench_result_t;
+
+static const gol_bench_variant_t bench_variants[] = {
+    {ENGINE_DENSE, KERNEL_SCALAR, false, BENCH_DENSE_MAX_CELLS},
+    {ENGINE_DENSE, KERNEL_AUTO, true, BENCH_DENSE_MAX_CELLS},
+    {ENGINE_PACKED, KERNEL_SCALAR, false, 0},
+    {ENGINE_PACKED, KERNEL_AUTO, true, 0},
+    {ENGINE_SPARSE, KERNEL_AUTO, false, BENCH_UNBOUNDED_MAX_CELLS},
+    {ENGINE_HASHLIFE, KERNEL_AUTO, false, BENCH_UNBOUNDED_MAX_CELLS},
+#if GOL_OPENCL
+    {ENGINE_GPU, KERNEL_AUTO, false, 0}
+#endif
+};
+
+/* Synthesized boards; configuration files run BENCH_CONFIG_GENERATIONS */
+static const gol_bench_board_t bench_random_boards[] = {
+    {NULL, 1024, 200},
+    {NULL, 8192, 10},
+    {NULL, 32768, 2}
+};
+
+/**
+ * @brief Set up and time one benchmark case; runs in the child process
+ * @param board Board to run
+ * @param variant Engine and kernel
+ * @param threads Worker threads
+ * @param out Measurement
+ */
+static void bench_measure(const gol_bench_board_t *board, const gol_bench_variant_t *variant,
+                          unsigned int threads, gol_bench_result_t *out) {
+    gol_context_t ctx = {0};
+    gol_config_text_t text = {0};
+    text.grid = SIZE_MAX;
+    
+    if (board->path) {
+        out->result = config_map(board->path, &text);
+        if (out->result == GOL_SUCCESS) {
+            out->result = parse_config_file(&text, &ctx.config);
+        }
+        if (out->result == GOL_SUCCESS && strcmp(ctx.config.config_type, CONFIG_SNAPSHOT) == 0) {
+            fprintf(stderr, "Error: Snapshot configurations are not benchmarked\n");
+            out->result = GOL_ERROR_CONFIG;
+        }
+    } else {
+        config_set_defaults(&ctx.config);
+        ctx.config.rows = board->size;
+        ctx.config.cols = board->size;
+        ctx.config.seed = BENCH_SEED;
+        strcpy(ctx.config.config_type, CONFIG_RANDOM);
+        out->result = GOL_SUCCESS;
+    }
+    if (out->result != GOL_SUCCESS) {
+        config_unmap(&text);
+        return;
+    }
+    
+    snprintf(ctx.config.engine_name, sizeof(ctx.config.engine_name), "%s", variant->engine);
+    ctx.config.threads = threads;
+    ctx.rows = ctx.config.rows;
+    ctx.cols = ctx.config.cols;
+    ctx.engine = find_engine(variant->engine);
+    ctx.kernel = find_kernel(variant->kernel);
+    ctx.step_generations = 1;
+    if (!ctx.kernel) {
+        out->result = GOL_ERROR_CONFIG;
+        config_unmap(&text);
+        return;
+    }
+    
+    out->result = allocate_grid(&ctx);
+    if (out->result == GOL_SUCCESS) {
+        out->result = thread_pool_create(&ctx.pool, threads);
+        if (out->result != GOL_SUCCESS) {
+            deallocate_grid(&ctx);
+        }
+    }
+    if (out->result != GOL_SUCCESS) {
+        config_unmap(&text);
+        return;
+    }
+    
+    if (strcmp(ctx.config.config_type, CONFIG_RANDOM) == 0) {
+        out->result = initialize_grid_random(&ctx);
+    } else if (strcmp(ctx.config.config_type, CONFIG_MANUAL) == 0) {
+        initialize_grid_manual(&ctx, &text);
+    }
+    config_unmap(&text);
+    if (out->result == GOL_SUCCESS) {
+        out->result = place_patterns(&ctx);
+    }
+    
+    if (out->result == GOL_SUCCESS) {
+        /* One untimed generation faults in the back buffers */
+        simulate_step(&ctx);
+        
+        double start = now_seconds();
+        advance_generations(&ctx, board->generations);
+        out->seconds = now_seconds() - start;
+        out->generations = board->generations;
+        out->rows = ctx.rows;
+        out->cols = ctx.cols;
+        out->threads = ctx.pool ? (unsigned int)ctx.pool->count : 1;
+        snprintf(out->kernel, sizeof(out->kernel), "%s", ctx.kernel->name);
+    }
+    
+    thread_pool_destroy(ctx.pool);
+    deallocate_grid(&ctx);
 }
 
 /**
- * @brief Clean up SDL resources
- * @param ctx Game context
+ * @brief Run one benchmark case in a child process
+ * @param board Board to run
+ * @param variant Engine and kernel
+ * @param threads Worker threads
+ * @param out Measurement, including the child's peak RSS
  */
-static void cleanup_sdl(gol_context_t *ctx) {
-    if (ctx->renderer) {
-        SDL_DestroyRenderer(ctx->renderer);
-        ctx->renderer = NULL;
+static void bench_run_case(const gol_bench_board_t *board, const gol_bench_variant_t *variant,
+                           unsigned int threads, gol_bench_result_t *out) {
+    memset(out, 0, sizeof(*out));
+    out->result = GOL_ERROR_THREAD;
+    
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return;
     }
-    if (ctx->window) {
-        SDL_DestroyWindow(ctx->window);
-        ctx->window = NULL;
+    fflush(NULL);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return;
     }
-    SDL_Quit();
+    if (pid == 0) {
+        close(fds[0]);
+        gol_bench_result_t result = {0};
+        bench_measure(board, variant, threads, &result);
+        ssize_t written = write(fds[1], &result, sizeof(result));
+        _exit(written == (ssize_t)sizeof(result) ? 0 : 1);
+    }
+    
+    close(fds[1]);
+    size_t done = 0;
+    while (done < sizeof(*out)) {
+        ssize_t got = read(fds[0], (char *)out + done, sizeof(*out) - done);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) break;
+        done += (size_t)got;
+    }
+    close(fds[0]);
+    
+    int status;
+    struct rusage usage;
+    while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {
+    }
+    if (done != sizeof(*out)) {
+        /* The child died before reporting, e.g. killed for lack of memory */
+        memset(out, 0, sizeof(*out));
+        out->result = GOL_ERROR_MEMORY;
+    }
+#ifdef __APPLE__
+    out->peak_rss_kb = usage.ru_maxrss / 1024;  /* Bytes on macOS */
+#else
+    out->peak_rss_kb = usage.ru_maxrss;
+#endif
 }
 
-
 /**
- * @brief Initialize grid with random values
- * @param ctx Game context
+ * @brief Write a string as a JSON string literal
+ * @param file Output file
+ * @param text String to write
  */
-static void initialize_grid_random(gol_context_t *ctx) {
-    unsigned int seed = ctx->config.seed;
-    if (seed == 0) {
-        seed = (unsigned int)time(NULL);
-    }
-    srand(seed);
-    
-    for (size_t i = 0; i < ctx->rows; i++) {
-        for (size_t j = 0; j < ctx->cols; j++) {
-            ctx->grid[i][j] = (rand() % 2) ? CELL_ALIVE : CELL_DEAD;
+static void bench_json_string(FILE *file, const char *text) {
+    putc('"', file);
+    for (const char *c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(file, "\\%c", *c);
+        } else if ((unsigned char)*c < 0x20) {
+            fprintf(file, "\\u%04x", (unsigned int)(unsigned char)*c);
+        } else {
+            putc(*c, file);
         }
     }
+    putc('"', file);
 }
 
 /**
- * @brief Initialize grid with manual configuration
- * @param ctx Game context
- * @param filename Configuration file path
+ * @brief Benchmark every engine variant on every board
+ * 
+ * Boards are the configuration files given on the command line, or
+ * BENCH_CONFIG_GLOB when there are none, followed by the synthesized
+ * random boards. Results are printed as a table, and as JSON on stdout
+ * when json is set, in which case the table goes to stderr.
+ * 
+ * @param count Number of command line arguments after the program name
+ * @param args Command line arguments after the program name; options are skipped
+ * @param json Whether to print JSON
+ * @return GOL_SUCCESS, or an error code if no case could run
  */
-static void initialize_grid_manual(gol_context_t *ctx, const char *filename) {
-    /* Initialize all cells to dead first */
-    for (size_t i = 0; i < ctx->rows; i++) {
-        for (size_t j = 0; j < ctx->cols; j++) {
-            ctx->grid[i][j] = CELL_DEAD;
+static gol_result_t run_benchmarks(int count, char **args, bool json) {
+    glob_t matches = {0};
+    bool globbed = false;
+    size_t board_count = 0;
+    gol_bench_board_t *boards = calloc((size_t)count + 1 + sizeof(bench_random_boards) /
+                                       sizeof(bench_random_boards[0]), sizeof(*boards));
+    if (!boards) {
+        return GOL_ERROR_MEMORY;
+    }
+    for (int i = 0; i < count; i++) {
+        if (args[i][0] != '-') {
+            boards[board_count++] = (gol_bench_board_t){args[i], 0, BENCH_CONFIG_GENERATIONS};
+        }
+    }
+    if (board_count == 0 && (globbed = true, glob(BENCH_CONFIG_GLOB, 0, NULL, &matches) == 0)) {
+        gol_bench_board_t *grown = realloc(boards, (matches.gl_pathc + sizeof(bench_random_boards) /
+                                           sizeof(bench_random_boards[0])) * sizeof(*boards));
+        if (!grown) {
+            globfree(&matches);
+            free(boards);
+            return GOL_ERROR_MEMORY;
+        }
+        boards = grown;
+        for (size_t i = 0; i < matches.gl_pathc; i++) {
+            boards[board_count++] =
+                (gol_bench_board_t){matches.gl_pathv[i], 0, BENCH_CONFIG_GENERATIONS};
+        }
+    }
+    for (size_t i = 0; i < sizeof(bench_random_boards) / sizeof(bench_random_boards[0]); i++) {
+        boards[board_count++] = bench_random_boards[i];
+    }
+    
+    unsigned int max_threads = online_cpus();
+    
+    FILE *table = json ? stderr : stdout;
+    fprintf(table, "%-24s %-12s %-9s %-7s %4s %6s %14s %14s %11s %8s\n", "Board", "Size",
+            "Engine", "Kernel", "Thr", "Gens", "Cell upd/s", "ns/gen", "Peak RSS", "Speedup");
+    if (json) {
+        printf("{\n  \"cpus\": %u,\n  \"results\": [", max_threads);
+    }
+    
+    size_t runs = 0;
+    for (size_t b = 0; b < board_count; b++) {
+        const gol_bench_board_t *board = &boards[b];
+        char name[MAX_CONFIG_LENGTH];
+        if (board->path) {
+            snprintf(name, sizeof(name), "%s", board->path);
+        } else {
+            snprintf(name, sizeof(name), "random %zuk", board->size / 1024);
+        }
+        
+        for (size_t v = 0; v < sizeof(bench_variants) / sizeof(bench_variants[0]); v++) {
+            const gol_bench_variant_t *variant = &bench_variants[v];
+            if (variant->max_cells && !board->path &&
+                board->size * board->size > variant->max_cells) {
+                continue;
+            }
+            
+            double single_thread = 0.0;
+            for (unsigned int threads = 1; threads <= max_threads;
+                 threads = (threads * 2 > max_threads && threads < max_threads)
+                           ? max_threads : threads * 2) {
+                gol_bench_result_t result;
+                bench_run_case(board, variant, threads, &result);
+                if (result.result != GOL_SUCCESS) {
+                    fprintf(table, "%-24s %-12s %-9s %-7s %4u   skipped (error %d)\n", name, "-",
+                            variant->engine, variant->kernel, threads, (int)result.result);
+                    break;
+                }
+                
+                double cells = (double)result.rows * (double)result.cols;
+                double rate = result.seconds > 0
+                              ? cells * (double)result.generations / result.seconds : 0.0;
+                double ns_per_gen = result.seconds * 1e9 / (double)result.generations;
+                if (threads == 1) single_thread = rate;
+                double speedup = single_thread > 0 ? rate / single_thread : 0.0;
+                
+                char size[32];
+                snprintf(size, sizeof(size), "%zux%zu", result.rows, result.cols);
+                fprintf(table, "%-24s %-12s %-9s %-7s %4u %6" PRIu64 " %14.3e %14.1f %7.1f MiB %7.2fx\n",
+                        name, size, variant->engine, result.kernel, result.threads,
+                        result.generations, rate, ns_per_gen, result.peak_rss_kb / 1024.0, speedup);
+                fflush(table);
+                
+                if (json) {
+                    printf("%s\n    {\"board\": ", runs ? "," : "");
+                    bench_json_string(stdout, name);
+                    printf(", \"rows\": %zu, \"cols\": %zu, \"engine\": \"%s\", \"kernel\": \"%s\", "
+                           "\"threads\": %u, \"generations\": %" PRIu64 ", \"seconds\": %.9f, "
+                           "\"cell_updates_per_second\": %.6e, \"ns_per_generation\": %.1f, "
+                           "\"peak_rss_kb\": %ld, \"speedup\": %.3f}",
+                           result.rows, result.cols, variant->engine, result.kernel,
+                           result.threads, result.generations, result.seconds, rate, ns_per_gen,
+                           result.peak_rss_kb, speedup);
+                }
+                runs++;
+                
+                if (!variant->scale_threads || threads == max_threads) {
+                    break;
+                }
+            }
         }
     }
     
-    /* Parse and set living cells from configuration */
-    parse_manual_config(filename, ctx);
+    if (json) {
+        printf("\n  ]\n}\n");
+    }
+    if (globbed) {
+        globfree(&matches);
+    }
+    free(boards);
+    return runs > 0 ? GOL_SUCCESS : GOL_ERROR_CONFIG;
 }
 
-/**
- * @brief Check if position is within grid bounds
- * @param ctx Game context
- * @param row Row coordinate
- * @param col Column coordinate
- * @return true if position is valid, false otherwise
+/*
+ * Parameter sweeps (--sweep). One configuration file describes a base
+ * board, and @sweep_seed, @sweep_density and @sweep_rule lines list the
+ * values to try. Every combination is a separate board. The configuration
+ * is parsed once, the boards run concurrently on the worker threads, one
+ * board per thread at a time, and the results are printed as CSV in a
+ * fixed order.
  */
-static bool is_valid_position(const gol_context_t *ctx, int row, int col) {
-    return (row >= 0 && row < (int)ctx->rows && 
-            col >= 0 && col < (int)ctx->cols);
-}
+
+/* Outcome of one board of a sweep */
+typedef struct {
+    gol_result_t result;
+    uint64_t population;    /* Live cells after @steps generations */
+    uint64_t stabilized;    /* Generation the board entered its cycle */
+    uint64_t period;        /* Period of the cycle, 0 if none was found */
+} gol_sweep_result_t;
+
+/* A sweep: the values every board of it combines, and their results */
+typedef struct {
+    const gol_config_t *config;     /* Base configuration */
+    const gol_config_text_t *text;  /* Its text, for the rows of @config manual */
+    unsigned int *seeds;
+    size_t seed_count;
+    double *densities;
+    size_t density_count;
+    gol_rule_t *rules;
+    size_t rule_count;
+    size_t boards;                  /* Every combination of the values above */
+    size_t next;                    /* Next board to claim; atomic */
+    gol_sweep_result_t *results;    /* One per board, in board order */
+} gol_sweep_t;
 
 /**
- * @brief Count living neighbors of a cell
- * @param ctx Game context
- * @param row Cell row
- * @param col Cell column
- * @return Number of living neighbors
+ * @brief Make room for one more value of a sweep list
+ * @param values Array to grow, updated on success
+ * @param count Values in the array
+ * @param size Size of one value
+ * @return false if out of memory or the sweep would exceed SWEEP_MAX_BOARDS
  */
-static int count_neighbors(const gol_context_t *ctx, size_t row, size_t col) {
-    int count = 0;
+static bool sweep_grow(void **values, size_t count, size_t size) {
+    if (count >= SWEEP_MAX_BOARDS) {
+        fprintf(stderr, "Error: A sweep has at most %zu boards\n", SWEEP_MAX_BOARDS);
+        return false;
+    }
     
-    /* Check all 8 neighboring cells */
-    for (int dr = -1; dr <= 1; dr++) {
-        for (int dc = -1; dc <= 1; dc++) {
-            if (dr == 0 && dc == 0) continue; /* Skip the cell itself */
-            
-            int nr = (int)row + dr;
-            int nc = (int)col + dc;
-            
-            if (is_valid_position(ctx, nr, nc)) {
-                cell_state_t state = ctx->grid[nr][nc];
-                if (state == CELL_ALIVE || state == CELL_DYING) {
-                    count++;
-                }
-            }
+    /* Grow to every power of two */
+    if ((count & (count - 1)) == 0) {
+        void *grown = realloc(*values, (count ? 2 * count : 1) * size);
+        if (!grown) {
+            fprintf(stderr, "Error: Out of memory for the sweep\n");
+            return false;
         }
+        *values = grown;
     }
-    
-    return count;
+    return true;
 }
 
 /**
- * @brief Simulate one generation following Conway's rules
- * @param ctx Game context
+ * @brief Read the @sweep_ lines of a configuration
+ * 
+ * A key may repeat, and its values add up. The values of a key without a
+ * line default to the configured one.
+ * 
+ * @param text Configuration text
+ * @param sweep Sweep whose config is set; receives the value lists
+ * @return GOL_SUCCESS on success, error code otherwise
  */
-static void simulate_step(gol_context_t *ctx) {
-    /* Mark cells for state changes */
-    for (size_t i = 0; i < ctx->rows; i++) {
-        for (size_t j = 0; j < ctx->cols; j++) {
-            int neighbors = count_neighbors(ctx, i, j);
-            cell_state_t current = ctx->grid[i][j];
-            
-            if (current == CELL_ALIVE) {
-                /* Living cell rules */
-                if (neighbors < MIN_NEIGHBORS_TO_SURVIVE || 
-                    neighbors > MAX_NEIGHBORS_TO_SURVIVE) {
-                    ctx->grid[i][j] = CELL_DYING;
+static gol_result_t sweep_parse(const gol_config_text_t *text, gol_sweep_t *sweep) {
+    const gol_config_t *config = sweep->config;
+    const char *data = text->map, *end = data + (text->grid < text->size ? text->grid : text->size);
+    char buffer[BUFFER_SIZE];
+    
+    for (const char *line = data, *next; line < end; line = next < end ? next + 1 : end) {
+        next = line_end(line, end);
+        size_t length = (size_t)(next - line);
+        if (length < 7 || memcmp(line, "@sweep_", 7) != 0) continue;
+        if (length >= sizeof(buffer)) length = sizeof(buffer) - 1;
+        memcpy(buffer, line, length);
+        buffer[length] = '\0';
+        
+        char *values = strchr(buffer, ' ');
+        if (values) *values++ = '\0';
+        bool known = strcmp(buffer, "@sweep_seed") == 0 || strcmp(buffer, "@sweep_density") == 0 ||
+                     strcmp(buffer, "@sweep_rule") == 0;
+        if (!known || !values) {
+            fprintf(stderr, "Error: Unknown sweep line '%s'\n", buffer);
+            return GOL_ERROR_CONFIG;
+        }
+        
+        char *save = NULL;
+        for (char *token = strtok_r(values, " \t\r", &save); token;
+             token = strtok_r(NULL, " \t\r", &save)) {
+            if (strcmp(buffer, "@sweep_seed") == 0) {
+                /* A seed, or a range of them like 1-1000; seed 0 would take the time */
+                unsigned int first, last;
+                char extra;
+                int fields = sscanf(token, "%u-%u%c", &first, &last, &extra);
+                if (fields == 1) last = first;
+                if ((fields != 1 && fields != 2) || first == 0 || last < first) {
+                    fprintf(stderr, "Error: @sweep_seed takes positive seeds or ranges like "
+                            "1-100, not '%s'\n", token);
+                    return GOL_ERROR_CONFIG;
+                }
+                for (uint64_t seed = first; seed <= last; seed++) {
+                    if (!sweep_grow((void **)&sweep->seeds, sweep->seed_count,
+                                    sizeof(*sweep->seeds))) {
+                        return GOL_ERROR_CONFIG;
+                    }
+                    sweep->seeds[sweep->seed_count++] = (unsigned int)seed;
+                }
+            } else if (strcmp(buffer, "@sweep_density") == 0) {
+                char *rest;
+                double density = strtod(token, &rest);
+                if (*rest != '\0' || !(density >= 0.0 && density <= 1.0)) {
+                    fprintf(stderr, "Error: @sweep_density takes values between 0 and 1, "
+                            "not '%s'\n", token);
+                    return GOL_ERROR_CONFIG;
+                }
+                if (!sweep_grow((void **)&sweep->densities, sweep->density_count,
+                                sizeof(*sweep->densities))) {
+                    return GOL_ERROR_CONFIG;
+                }
+                sweep->densities[sweep->density_count++] = density;
+            } else {
+                gol_rule_t rule;
+                if (!rule_parse(token, &rule)) {
+                    fprintf(stderr, "Error: Unknown rule '%s' in @sweep_rule\n", token);
+                    return GOL_ERROR_CONFIG;
                 }
-            } else if (current == CELL_DEAD) {
-                /* Dead cell rules */
-                if (neighbors == NEIGHBORS_TO_BIRTH) {
-                    ctx->grid[i][j] = CELL_BIRTH;
+                const gol_engine_t *engine = find_engine(config->engine_name);
+                if ((rule.birth & 1u) && (engine == &sparse_engine || engine == &hashlife_engine)) {
+                    fprintf(stderr, "Error: Rule %s has B0, which the %s engine does not "
+                            "support\n", rule.name, engine->name);
+                    return GOL_ERROR_CONFIG;
                 }
+                if (!sweep_grow((void **)&sweep->rules, sweep->rule_count,
+                                sizeof(*sweep->rules))) {
+                    return GOL_ERROR_CONFIG;
+                }
+                sweep->rules[sweep->rule_count++] = rule;
             }
         }
     }
     
-    /* Apply state changes */
-    for (size_t i = 0; i < ctx->rows; i++) {
-        for (size_t j = 0; j < ctx->cols; j++) {
-            if (ctx->grid[i][j] == CELL_DYING) {
-                ctx->grid[i][j] = CELL_DEAD;
-            } else if (ctx->grid[i][j] == CELL_BIRTH) {
-                ctx->grid[i][j] = CELL_ALIVE;
-            }
-        }
+    /* Keys without a sweep line take the configured value */
+    if (sweep->seed_count == 0 && sweep_grow((void **)&sweep->seeds, 0, sizeof(*sweep->seeds))) {
+        sweep->seeds[sweep->seed_count++] = config->seed;
+    }
+    if (sweep->density_count == 0 &&
+        sweep_grow((void **)&sweep->densities, 0, sizeof(*sweep->densities))) {
+        sweep->densities[sweep->density_count++] = config->density;
+    }
+    if (sweep->rule_count == 0 && sweep_grow((void **)&sweep->rules, 0, sizeof(*sweep->rules))) {
+        sweep->rules[sweep->rule_count++] = config->rule;
+    }
+    if (!sweep->seed_count || !sweep->density_count || !sweep->rule_count) {
+        return GOL_ERROR_MEMORY;
+    }
+    
+    /* Boards are numbered seed first, then density, then rule */
+    sweep->boards = sweep->seed_count;
+    if (sweep->density_count > SWEEP_MAX_BOARDS / sweep->boards ||
+        sweep->rule_count > SWEEP_MAX_BOARDS / (sweep->boards * sweep->density_count)) {
+        fprintf(stderr, "Error: A sweep has at most %zu boards\n", SWEEP_MAX_BOARDS);
+        return GOL_ERROR_CONFIG;
     }
+    sweep->boards *= sweep->density_count * sweep->rule_count;
+    return GOL_SUCCESS;
 }
 
 /**
- * @brief Render the grid using SDL
- * @param ctx Game context
+ * @brief Set up, run and measure one board of a sweep on the calling thread
+ * @param sweep Sweep
+ * @param board Board number
+ * @param out Result of the board
  */
-static void render_grid(const gol_context_t *ctx) {
-    /* Clear screen with black background */
-    SDL_SetRenderDrawColor(ctx->renderer, 0, 0, 0, 255);
-    SDL_RenderClear(ctx->renderer);
+static void sweep_run_board(const gol_sweep_t *sweep, size_t board, gol_sweep_result_t *out) {
+    gol_context_t ctx = {0};
+    size_t per_rule = sweep->seed_count * sweep->density_count;
     
-    /* Draw living cells in green */
-    SDL_SetRenderDrawColor(ctx->renderer, 0, 255, 0, 255);
+    ctx.config = *sweep->config;
+    ctx.config.seed = sweep->seeds[board % sweep->seed_count];
+    ctx.config.density = sweep->densities[board / sweep->seed_count % sweep->density_count];
+    ctx.config.rule = sweep->rules[board / per_rule];
+    snprintf(ctx.config.rule_name, sizeof(ctx.config.rule_name), "%s", ctx.config.rule.name);
+    ctx.rows = ctx.config.rows;
+    ctx.cols = ctx.config.cols;
+    ctx.engine = find_engine(ctx.config.engine_name);
+    ctx.kernel = find_kernel(ctx.config.kernel_name);
+    ctx.step_generations = 1;
     
-    for (size_t i = 0; i < ctx->rows; i++) {
-        for (size_t j = 0; j < ctx->cols; j++) {
-            if (ctx->grid[i][j] == CELL_ALIVE) {
-                SDL_Rect cell = {
-                    .x = (int)(j * CELL_SIZE),
-                    .y = (int)(i * CELL_SIZE),
-                    .w = CELL_SIZE,
-                    .h = CELL_SIZE
-                };
-                SDL_RenderFillRect(ctx->renderer, &cell);
-            }
+    out->result = allocate_grid(&ctx);
+    if (out->result != GOL_SUCCESS) {
+        return;
+    }
+    
+    if (strcmp(ctx.config.config_type, CONFIG_RANDOM) == 0) {
+        out->result = initialize_grid_random(&ctx);
+    } else if (strcmp(ctx.config.config_type, CONFIG_MANUAL) == 0) {
+        initialize_grid_manual(&ctx, sweep->text);
+    }
+    if (out->result == GOL_SUCCESS) {
+        out->result = place_patterns(&ctx);
+    }
+    if (out->result == GOL_SUCCESS && ctx.config.cycle_period > 0) {
+        out->result = cycle_create(&ctx);
+    }
+    
+    if (out->result == GOL_SUCCESS) {
+        advance_generations(&ctx, ctx.config.steps);
+        out->population = ctx.stats.population;
+        if (ctx.cycle && ctx.cycle->period) {
+            out->stabilized = ctx.cycle->start;
+            out->period = ctx.cycle->period;
         }
     }
     
-    SDL_RenderPresent(ctx->renderer);
+    cycle_destroy(&ctx);
+    deallocate_grid(&ctx);
 }
 
 /**
- * @brief Handle mouse click to toggle cell state
- * @param ctx Game context
- * @param x Mouse x coordinate
- * @param y Mouse y coordinate
+ * @brief Pool task: claim and run boards until none are left
+ * 
+ * Boards vary in cost, as some settle early and skip their cycles, so
+ * each thread claims the next unclaimed board rather than a fixed share.
+ * 
+ * @param arg Sweep
+ * @param index Unused
+ * @param count Unused
  */
-static void handle_mouse_click(gol_context_t *ctx, int x, int y) {
-    size_t col = (size_t)(x / CELL_SIZE);
-    size_t row = (size_t)(y / CELL_SIZE);
+static void sweep_task(void *arg, size_t index, size_t count) {
+    (void)index;
+    (void)count;
+    gol_sweep_t *sweep = arg;
     
-    if (row < ctx->rows && col < ctx->cols) {
-        /* Toggle cell state */
-        ctx->grid[row][col] = (ctx->grid[row][col] == CELL_ALIVE) ? 
-                              CELL_DEAD : CELL_ALIVE;
+    for (;;) {
+        size_t board = __atomic_fetch_add(&sweep->next, 1, __ATOMIC_RELAXED);
+        if (board >= sweep->boards) break;
+        sweep_run_board(sweep, board, &sweep->results[board]);
     }
 }
 
-
 /**
- * @brief Count total number of living cells
- * @param ctx Game context
- * @return Number of living cells
+ * @brief Run every board of a sweep and print one CSV line per board
+ * 
+ * The results go to stdout in board order, seeds varying fastest; the
+ * summary goes to stderr.
+ * 
+ * @param filename Configuration file with @sweep_ lines
+ * @return GOL_SUCCESS on success, error code otherwise
  */
-static int count_alive_cells(const gol_context_t *ctx) {
-    int count = 0;
-    for (size_t i = 0; i < ctx->rows; i++) {
-        for (size_t j = 0; j < ctx->cols; j++) {
-            if (ctx->grid[i][j] == CELL_ALIVE) {
-                count++;
-            }
+static gol_result_t run_sweep(const char *filename) {
+#if GOL_MPI
+    /* The boards are small; one process runs them all */
+    int processes;
+    MPI_Comm_size(MPI_COMM_WORLD, &processes);
+    if (processes > 1) {
+        fprintf(stderr, "Error: --sweep runs in a single process\n");
+        return GOL_ERROR_ARGS;
+    }
+#endif
+    gol_config_t config;
+    gol_config_text_t text;
+    gol_result_t result = config_map(filename, &text);
+    if (result != GOL_SUCCESS) {
+        return result;
+    }
+    result = parse_config_file(&text, &config);
+    if (result == GOL_SUCCESS && config.steps == 0) {
+        fprintf(stderr, "Error: A sweep requires @steps > 0\n");
+        result = GOL_ERROR_CONFIG;
+    }
+    if (result == GOL_SUCCESS && strcmp(config.config_type, CONFIG_SNAPSHOT) == 0) {
+        fprintf(stderr, "Error: Snapshot configurations cannot be swept\n");
+        result = GOL_ERROR_CONFIG;
+    }
+    if (result == GOL_SUCCESS && (config.checkpoint_path[0] != '\0' ||
+                                  config.export_path[0] != '\0' ||
+                                  config.frames_path[0] != '\0')) {
+        fprintf(stderr, "Error: @checkpoint, @export and @frames cannot be used in a sweep\n");
+        result = GOL_ERROR_CONFIG;
+    }
+    
+    gol_sweep_t sweep = { .config = &config, .text = &text };
+    if (result == GOL_SUCCESS) {
+        result = sweep_parse(&text, &sweep);
+    }
+    if (result == GOL_SUCCESS) {
+        sweep.results = calloc(sweep.boards, sizeof(*sweep.results));
+        if (!sweep.results) {
+            fprintf(stderr, "Error: Out of memory for the sweep\n");
+            result = GOL_ERROR_MEMORY;
         }
     }
-    return count;
-}
-
-/**
- * @brief Print grid to console for debugging
- * @param ctx Game context
- */
-static void print_grid_console(const gol_context_t *ctx) {
-    printf("Living cells: %d\n", count_alive_cells(ctx));
     
-    for (size_t i = 0; i < ctx->rows; i++) {
-        for (size_t j = 0; j < ctx->cols; j++) {
-            printf("%c ", (ctx->grid[i][j] == CELL_ALIVE) ? '#' : '.');
+    /* @threads is the number of boards run at once; each board runs on one thread */
+    gol_thread_pool_t *pool = NULL;
+    if (result == GOL_SUCCESS) {
+        result = thread_pool_create(&pool, config.threads);
+        if (result != GOL_SUCCESS) {
+            fprintf(stderr, "Error: Failed to start worker threads\n");
         }
-        printf("\n");
     }
-    printf("\n");
-}
-
-/**
- * @brief Main game loop
- * @param ctx Game context
- * @return GOL_SUCCESS on normal exit
- */
-static gol_result_t run_simulation(gol_context_t *ctx) {
-    bool running = true;
-    SDL_Event event;
-    unsigned int generation = 0;
     
-    while (running) {
-        /* Process events */
-        while (SDL_PollEvent(&event)) {
-            switch (event.type) {
-                case SDL_QUIT:
-                    running = false;
-                    break;
-                    
-                case SDL_MOUSEBUTTONDOWN:
-                    if (event.button.button == SDL_BUTTON_LEFT) {
-                        handle_mouse_click(ctx, event.button.x, event.button.y);
-                    }
-                    break;
-                    
-                case SDL_KEYDOWN:
-                    if (event.key.keysym.sym == SDLK_SPACE) {
-                        /* Pause/unpause with spacebar */
-                        SDL_Delay(500); /* Simple pause mechanism */
-                    } else if (event.key.keysym.sym == SDLK_r) {
-                        /* Reset grid */
-                        if (strcmp(ctx->config.config_type, CONFIG_RANDOM) == 0) {
-                            initialize_grid_random(ctx);
-                        }
-                        generation = 0;
-                    }
-                    break;
-            }
+    if (result == GOL_SUCCESS) {
+        double start = now_seconds();
+        if (pool) {
+            thread_pool_run(pool, sweep_task, &sweep);
+        } else {
+            sweep_task(&sweep, 0, 1);
         }
+        double elapsed = now_seconds() - start;
         
-        /* Render current state */
-        render_grid(ctx);
-        
-        /* Advance simulation */
-        simulate_step(ctx);
-        generation++;
-        
-        /* Check if we should stop */
-        if (ctx->config.steps > 0 && generation >= ctx->config.steps) {
-            running = false;
+        printf("rule,density,seed,generations,population,stabilized,period\n");
+        for (size_t b = 0; b < sweep.boards && result == GOL_SUCCESS; b++) {
+            const gol_sweep_result_t *board = &sweep.results[b];
+            result = board->result;
+            if (result != GOL_SUCCESS) {
+                fprintf(stderr, "Error: Board %zu of the sweep failed\n", b);
+                break;
+            }
+            printf("%s,%g,%u,%" PRIu64 ",%" PRIu64 ",",
+                   sweep.rules[b / (sweep.seed_count * sweep.density_count)].name,
+                   sweep.densities[b / sweep.seed_count % sweep.density_count],
+                   sweep.seeds[b % sweep.seed_count], config.steps, board->population);
+            if (board->period) {
+                printf("%" PRIu64 ",%" PRIu64 "\n", board->stabilized, board->period);
+            } else {
+                printf(",\n");
+            }
         }
-        
-        /* Control frame rate */
-        SDL_Delay(FRAME_DELAY_MS);
+        unsigned int threads = pool ? (unsigned int)pool->count : 1;
+        fprintf(stderr, "Sweep: %zu boards of %zux%zu in %.3f s (%.1f boards/s, %u thread%s)\n",
+                sweep.boards, config.cols, config.rows, elapsed,
+                elapsed > 0 ? sweep.boards / elapsed : 0.0, threads, threads == 1 ? "" : "s");
     }
     
-    return GOL_SUCCESS;
+    thread_pool_destroy(pool);
+    free(sweep.results);
+    free(sweep.seeds);
+    free(sweep.densities);
+    free(sweep.rules);
+    config_unmap(&text);
+    return result;
 }
 
 /**
@@ -563,14 +11295,61 @@ static gol_result_t run_simulation(gol_context_t *ctx) {
  * @param program_name Name of the program executable
  */
 static void print_usage(const char *program_name) {
-    printf("Usage: %s <config_file>\n", program_name);
+    printf("Usage: %s [--headless] [--stats] [--profile] <config_file>\n", program_name);
+    printf("       %s --bench [--json] [config_file...]\n", program_name);
+    printf("       %s --sweep <config_file> > results.csv\n", program_name);
+    printf("\nOptions:\n");
+    printf("  --headless          - Run without a window for @steps generations, then\n");
+    printf("                        print statistics and the final grid (same as @render none)\n");
+    printf("  --stats             - Headless: print population, births and deaths every step\n");
+    printf("  --bench             - Time every engine on the given configs (default %s)\n",
+           BENCH_CONFIG_GLOB);
+    printf("                        and on 1k/8k/32k random boards, with thread scaling\n");
+    printf("  --json              - Bench: print the results as JSON (the table goes to stderr)\n");
+    printf("  --profile           - Print frame phase timings (p50/p99) to stderr every second\n");
+    printf("  --sweep             - Run every combination of the @sweep_ values, @threads boards\n");
+    printf("                        at a time, and print one CSV line per board\n");
     printf("\nConfiguration file format:\n");
     printf("  @nrows <number>     - Number of grid rows\n");
     printf("  @ncols <number>     - Number of grid columns\n");
-    printf("  @config <type>      - Configuration type (random|manual)\n");
+    printf("  @config <type>      - Configuration type (random|manual|snapshot|pattern)\n");
     printf("  @steps <number>     - Number of steps (optional, 0 = infinite)\n");
     printf("  @seed <number>      - Random seed (optional, 0 = time-based)\n");
-    printf("\nFor manual configuration, add:\n");
+    printf("  @density <p>        - Share of live cells for random configs (default 0.5)\n");
+    printf("  @threads <number>   - Worker threads (optional, default 1, 0 = one per CPU)\n");
+    printf("  @render <mode>      - Output (sdl|none, default sdl; none runs headless)\n");
+    printf("  @gens_per_frame <n> - Generations simulated per frame (optional, default 1)\n");
+    printf("  @detect_cycles <p>  - Headless: find cycles of period up to p (at most %d) and\n",
+           MAX_CYCLE_PERIOD);
+    printf("                        skip their repeats (default 0 = off)\n");
+    printf("  @engine <name>      - Simulation engine (packed|dense|sparse|hashlife|gpu, default packed)\n");
+    printf("  @kernel <name>      - Step kernel (auto|scalar|avx2|avx512|neon, default auto)\n");
+    printf("  @rule <rule>        - Life-like rule in B/S notation (default B3/S23)\n");
+    printf("  @boundary <mode>    - Board edges: dead|torus|klein|mirror (default dead)\n");
+    printf("  @temporal_block <k> - Dense/packed: advance k generations per cache-blocked step\n");
+    printf("  @snapshot <file>    - Snapshot loaded by @config snapshot (sets the grid size)\n");
+    printf("  @checkpoint <file>  - Save a snapshot on exit (and with the S key)\n");
+    printf("  @checkpoint_every <n> - Headless: also save every n generations\n");
+    printf("  @pattern <file> [x y] - Place an RLE or Macrocell pattern at board cell (x, y);\n");
+    printf("                        may repeat, and adds to any configuration type\n");
+    printf("  @export <file>      - Save the final pattern (Macrocell if it ends in .mc, else RLE)\n");
+    printf("  @frames <target>    - Export frames: numbered files (frames/%%06d.png or .ppm),\n");
+    printf("                        one PPM stream file, or |command to pipe them to\n");
+    printf("  @frame_every <n>    - Frames: generations between exported frames (default 1)\n");
+    printf("  @frame_scale <n>    - Frames: pixels per cell side, 1 to %d (default 1), at most\n",
+           MAX_FRAME_SCALE);
+    printf("                        %d pixels per frame side\n", MAX_FRAME_SIZE);
+    printf("  @frame_buffers <n>  - Frames: queued ahead of the writer, 1 to %d (default %d)\n",
+           MAX_FRAME_BUFFERS, DEFAULT_FRAME_BUFFERS);
+    printf("  @trace <file>       - Write frame phase timings as Chrome trace-event JSON\n");
+    printf("  @sim_thread <0|1>   - Windowed: step on a thread of its own (dense, packed, gpu)\n");
+    printf("  @sweep_seed <n|a-b> ... - Sweep: seeds to try (may repeat)\n");
+    printf("  @sweep_density <p> ... - Sweep: densities to try (may repeat)\n");
+    printf("  @sweep_rule <rule> ... - Sweep: rules to try (may repeat)\n");
+    printf("  @hashlife_step <k>  - HashLife: advance 2^k generations per step (default 0)\n");
+    printf("  @hashlife_mem <MiB> - HashLife: node cache budget (default %d)\n",
+           DEFAULT_HASHLIFE_MEM_MB);
+    printf("\nFor manual configuration, add after all other keys:\n");
     printf("  @grid\n");
     printf("  <grid_rows>         - Grid pattern using 1/#/* for alive, 0/./<space> for dead\n");
     printf("\nExample manual config file:\n");
@@ -584,66 +11363,240 @@ static void print_usage(const char *program_name) {
     printf("  00000\n");
     printf("  00000\n");
     printf("\nControls:\n");
-    printf("  Left click          - Toggle cell state\n");
+    printf("  Left click          - Toggle cell state (at 1 pixel per cell or closer)\n");
+    printf("  Wheel, PgUp / PgDn  - Zoom in/out about the mouse or the window centre\n");
+    printf("  Right/middle drag, arrows - Pan\n");
+    printf("  Home                - Show the whole board\n");
     printf("  Space               - Pause/unpause\n");
+    printf("  N                   - Step once, or the number typed before it of generations\n");
+    printf("  <number> G          - Run to that generation and pause\n");
+    printf("  Esc                 - Clear the typed number\n");
+    printf("  + / -               - Double/halve generations per frame\n");
     printf("  R                   - Reset grid (random configs only)\n");
+    printf("  P                   - Show/hide frame phase timings\n");
     printf("  Close window        - Exit\n");
 }
 
 /**
- * @brief Main function
+ * @brief Run the program once; every rank of an MPI run runs it
+ * @param argc Argument count
+ * @param argv Arguments
+ * @return Exit status, a gol_result_t
  */
-int main(int argc, char *argv[]) {
-    if (argc != 2) {
+static int run_program(int argc, char *argv[]) {
+    const char *config_file = NULL;
+    bool headless = false;
+    bool log_stats = false;
+    bool bench = false, json = false, profile = false, sweep = false;
+    int positional = 0;
+    
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], OPTION_HEADLESS) == 0) {
+            headless = true;
+        } else if (strcmp(argv[i], OPTION_STATS) == 0) {
+            log_stats = true;
+        } else if (strcmp(argv[i], OPTION_BENCH) == 0) {
+            bench = true;
+        } else if (strcmp(argv[i], OPTION_JSON) == 0) {
+            json = true;
+        } else if (strcmp(argv[i], OPTION_PROFILE) == 0) {
+            profile = true;
+        } else if (strcmp(argv[i], OPTION_SWEEP) == 0) {
+            sweep = true;
+        } else if (argv[i][0] != '-') {
+            if (!config_file) config_file = argv[i];
+            positional++;
+        } else {
+            print_usage(argv[0]);
+            return GOL_ERROR_ARGS;
+        }
+    }
+    
+    if (bench && !headless && !log_stats) {
+        return run_benchmarks(argc - 1, argv + 1, json);
+    }
+    if (!config_file || positional > 1 || bench || json || (sweep && (headless || log_stats))) {
         print_usage(argv[0]);
         return GOL_ERROR_ARGS;
     }
+    if (sweep) {
+        return run_sweep(config_file);
+    }
     
     gol_context_t ctx = {0};
     gol_result_t result;
     
-    /* Parse configuration */
-    result = parse_config_file(argv[1], &ctx.config);
+    /* Parse configuration; the mapping stays until the grid rows are read */
+    gol_config_text_t text;
+    result = config_map(config_file, &text);
+    if (result != GOL_SUCCESS) {
+        return result;
+    }
+    result = parse_config_file(&text, &ctx.config);
     if (result != GOL_SUCCESS) {
+        config_unmap(&text);
         return result;
     }
+    if (headless) {
+        strcpy(ctx.config.render_mode, RENDER_NONE);
+    }
+    
+    /* A snapshot defines the board size, so it is mapped before allocating */
+    gol_snapshot_t snapshot = {0};
+    if (strcmp(ctx.config.config_type, CONFIG_SNAPSHOT) == 0) {
+        result = snapshot_map(ctx.config.snapshot_path, &ctx.config.rule, &snapshot);
+        if (result != GOL_SUCCESS) {
+            config_unmap(&text);
+            return result;
+        }
+        ctx.config.rows = (size_t)snapshot.header->rows;
+        ctx.config.cols = (size_t)snapshot.header->cols;
+    }
     
     /* Set up game context */
     ctx.rows = ctx.config.rows;
     ctx.cols = ctx.config.cols;
+    ctx.engine = find_engine(ctx.config.engine_name);
+    ctx.kernel = find_kernel(ctx.config.kernel_name);
+    ctx.step_generations = 1;
+    ctx.log_stats = log_stats;
+#if GOL_MPI
+    /* Under mpirun, each rank allocates and steps only its block of the board */
+    result = dist_create(&ctx);
+    if (result != GOL_SUCCESS) {
+        snapshot_unmap(&snapshot);
+        config_unmap(&text);
+        return result;
+    }
+#endif
+#if GOL_PROFILE
+    ctx.profile.report = profile;
+#else
+    if (profile || ctx.config.trace_path[0] != '\0') {
+        fprintf(stderr, "Warning: Built with GOL_PROFILE=0, frame timing is unavailable\n");
+    }
+#endif
     
     /* Allocate grid */
-    result = allocate_grid(&ctx);
+    result = DIST_AGREE(&ctx, allocate_grid(&ctx));
     if (result != GOL_SUCCESS) {
         fprintf(stderr, "Error: Failed to allocate grid memory\n");
+        snapshot_unmap(&snapshot);
+        config_unmap(&text);
+        return result;
+    }
+    
+    /* Start the worker pool once; it fills random grids and steps every generation */
+    result = DIST_AGREE(&ctx, thread_pool_create(&ctx.pool, ctx.config.threads));
+    if (result != GOL_SUCCESS) {
+        fprintf(stderr, "Error: Failed to start worker threads\n");
+        snapshot_unmap(&snapshot);
+        config_unmap(&text);
+        deallocate_grid(&ctx);
         return result;
     }
     
     /* Initialize grid based on configuration */
-    if (strcmp(ctx.config.config_type, CONFIG_RANDOM) == 0) {
-        initialize_grid_random(&ctx);
+    if (snapshot.map) {
+        snapshot_apply(&ctx, &snapshot);
+        snapshot_unmap(&snapshot);
+    } else if (strcmp(ctx.config.config_type, CONFIG_RANDOM) == 0) {
+        result = initialize_grid_random(&ctx);
     } else if (strcmp(ctx.config.config_type, CONFIG_MANUAL) == 0) {
-        initialize_grid_manual(&ctx, argv[1]);
+        initialize_grid_manual(&ctx, &text);
+    } else if (strcmp(ctx.config.config_type, CONFIG_PATTERN) == 0) {
+        /* The board starts empty; the patterns below are all there is */
     } else {
         fprintf(stderr, "Error: Unknown configuration type '%s'\n", 
                 ctx.config.config_type);
+        thread_pool_destroy(ctx.pool);
         deallocate_grid(&ctx);
+        config_unmap(&text);
         return GOL_ERROR_CONFIG;
     }
+    config_unmap(&text);
+    result = DIST_AGREE(&ctx, result);
     
-    /* Initialize SDL */
-    result = initialize_sdl(&ctx);
+    /* Patterns go on top of whatever the configuration type produced */
+    if (result == GOL_SUCCESS) {
+        result = DIST_AGREE(&ctx, place_patterns(&ctx));
+    }
     if (result != GOL_SUCCESS) {
+        thread_pool_destroy(ctx.pool);
         deallocate_grid(&ctx);
         return result;
     }
     
-    /* Run the simulation */
-    result = run_simulation(&ctx);
+    /* Frames are encoded on their own thread while the simulation runs */
+    if (ctx.config.frames_path[0] != '\0') {
+        result = frames_create(&ctx);
+        if (result != GOL_SUCCESS) {
+            thread_pool_destroy(ctx.pool);
+            deallocate_grid(&ctx);
+            return result;
+        }
+    }
+    
+    if (strcmp(ctx.config.render_mode, RENDER_NONE) == 0) {
+        /* Headless: no window or renderer is ever created */
+        result = run_headless(&ctx);
+#if GOL_MPI
+    } else if (ctx.dist) {
+        /* Rank 0 shows the whole board downsampled; the others only simulate */
+        result = dist_run_simulation(&ctx);
+#endif
+    } else {
+        /* Initialize SDL */
+        result = initialize_sdl(&ctx);
+        if (result != GOL_SUCCESS) {
+            frames_destroy(&ctx);
+            thread_pool_destroy(ctx.pool);
+            deallocate_grid(&ctx);
+            return result;
+        }
+        
+        /* Run the simulation */
+        result = run_simulation(&ctx);
+        
+        cleanup_sdl(&ctx);
+    }
+    
+    /* The queued frames are written before the program reports success */
+    gol_result_t frames_result = frames_destroy(&ctx);
+    if (result == GOL_SUCCESS) {
+        result = frames_result;
+    }
+    
+    /* Final checkpoint, so the run can be resumed with @config snapshot */
+    if (result == GOL_SUCCESS && ctx.config.checkpoint_path[0] != '\0') {
+        result = snapshot_save(&ctx, ctx.config.checkpoint_path);
+    }
+    if (result == GOL_SUCCESS && ctx.config.export_path[0] != '\0') {
+        result = pattern_export(&ctx, ctx.config.export_path);
+    }
     
     /* Cleanup */
-    cleanup_sdl(&ctx);
+    thread_pool_destroy(ctx.pool);
     deallocate_grid(&ctx);
+#if GOL_MPI
+    dist_destroy(&ctx);
+#endif
     
     return result;
 }
+
+/**
+ * @brief Main function
+ */
+int main(int argc, char *argv[]) {
+#if GOL_MPI
+    /* Only the main thread calls MPI; the workers just step the block */
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    int result = run_program(argc, argv);
+    MPI_Finalize();
+    return result;
+#else
+    return run_program(argc, argv);
+#endif
+}